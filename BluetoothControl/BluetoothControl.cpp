@@ -112,6 +112,10 @@ namespace Plugin {
                 Bluetooth::ManagementSocket::Info::Properties actuals(info.Actuals());
                 Bluetooth::ManagementSocket::Info::Properties supported(info.Supported());
 
+                if (_config.CacheDevices.Value() == true) {
+                    LoadKnownDevices(_service->PersistentPath());
+                }
+
                 if (controllerData.MAC.Value().empty() == true) {
                     controllerData.MAC = info.Address().ToString();
                     SaveController(_service->PersistentPath(), controllerData);
@@ -162,6 +166,10 @@ namespace Plugin {
             subSystems->Release();
         }
 
+        if (_config.CacheDevices.Value() == true) {
+            SaveKnownDevices(_service->PersistentPath());
+        }
+
         // Deinitialize what we initialized..
         _service = nullptr;
 
@@ -522,7 +530,7 @@ namespace Plugin {
             }
 
             ASSERT(impl != nullptr);
-            _devices.push_back(impl);
+            AddDevice(impl);
 
             TRACE(Trace::Information, (_T("Added %s Bluetooth device: %s, name: '%s', class: 0x%06X"),
                                        (lowEnergy? "LowEnergy" : "classic"), address.ToString().c_str(),
@@ -545,16 +553,35 @@ namespace Plugin {
     {
         _adminLock.Lock();
 
-        for (std::list<DeviceImpl*>::iterator index = _devices.begin(), end = _devices.end(); index != end; ++index) {
+        std::list<DeviceImpl*>::iterator index = _devices.begin();
+
+        while (index != _devices.end()) {
             // call the function passed into findMatchingAddresses and see if it matches
             if (filter(*index) == true) {
+                std::unordered_map<uint64_t, DeviceImpl*>::iterator entry(_index.find(Key((*index)->Address(), (*index)->LowEnergy())));
+
+                if ((entry != _index.end()) && (entry->second == (*index))) {
+                    _index.erase(entry);
+                }
+
                 (*index)->Release();
                 index = _devices.erase(index);
             }
+            else {
+                index++;
+            }
         }
 
         _adminLock.Unlock();
     }
+    // Expects the _adminLock to be taken (or the plugin to still be single threaded).
+    void BluetoothControl::AddDevice(DeviceImpl* device)
+    {
+        _devices.push_back(device);
+
+        // A newer instance for the same address takes over the lookup, the older one is no longer valid.
+        _index[Key(device->Address(), device->LowEnergy())] = device;
+    }
     void BluetoothControl::Capabilities(const Bluetooth::Address& device, const uint8_t capability, const uint8_t authentication, const uint8_t oob_data)
     {
         DeviceImpl* entry = Find(device);
@@ -568,23 +595,31 @@ namespace Plugin {
     }
     BluetoothControl::DeviceImpl* BluetoothControl::Find(const Bluetooth::Address& search) const
     {
-        std::list<DeviceImpl*>::const_iterator index = _devices.begin();
+        std::unordered_map<uint64_t, DeviceImpl*>::const_iterator index(_index.find(Key(search, true)));
 
-        while ((index != _devices.end()) && ((*index)->operator==(search) == false)) {
-            index++;
+        if (index == _index.end()) {
+            index = _index.find(Key(search, false));
         }
 
-        return (index != _devices.end() ? (*index) : nullptr);
+        return (index != _index.end() ? index->second : nullptr);
     }
     BluetoothControl::DeviceImpl* BluetoothControl::Find(const Bluetooth::Address& search, bool lowEnergy) const
     {
-        std::list<DeviceImpl*>::const_iterator index = _devices.begin();
+        std::unordered_map<uint64_t, DeviceImpl*>::const_iterator index(_index.find(Key(search, lowEnergy)));
 
-        while ((index != _devices.end()) && ((*index)->operator==(std::make_pair(search, lowEnergy)) == false)) {
-            index++;
-        }
+        // A cleared device no longer reports its type, so it does not match anymore.
+        return (((index != _index.end()) && (index->second->operator==(std::make_pair(search, lowEnergy)) == true)) ? index->second : nullptr);
+    }
+    bool BluetoothControl::Advertised(const Bluetooth::Address& address, const uint8_t type, const uint32_t fingerprint) const
+    {
+        _adminLock.Lock();
 
-        return (index != _devices.end() ? (*index) : nullptr);
+        DeviceImpl* device = Find(address, true);
+        bool result = ((device == nullptr) || (device->Advertisement(type, fingerprint) == true));
+
+        _adminLock.Unlock();
+
+        return (result);
     }
     template<typename DEVICE=BluetoothControl::DeviceImpl>
     DEVICE* BluetoothControl::Find(const uint16_t handle) const
@@ -646,6 +681,81 @@ namespace Plugin {
         }
     }
 
+    void BluetoothControl::LoadKnownDevices(const string& pathName)
+    {
+        Core::File file(pathName + _T("KnownDevices.json"), true);
+
+        if (file.Open(true) == true) {
+            KnownDevices known;
+
+            if (known.IElement::FromFile(file) == true) {
+                uint16_t count = 0;
+                auto index = known.Devices.Elements();
+
+                while (index.Next() == true) {
+                    const KnownDevices::Device& entry(index.Current());
+                    Bluetooth::Address address(entry.Address.Value().c_str());
+
+                    // Bonded devices are loaded already, with their keys.
+                    if ((address.IsValid() == true) && (entry.Type.IsSet() == true) && (Find(address) == nullptr)) {
+                        DeviceImpl::Config config;
+                        config.Type = entry.Type.Value();
+                        config.Name = entry.Name.Value();
+                        config.Class = entry.Class.Value();
+
+                        DeviceImpl* device;
+                        if (entry.Type.Value() == Bluetooth::Address::BREDR_ADDRESS) {
+                            device = Core::Service<DeviceRegular>::Create<DeviceImpl>(this, _btInterface, address, &config);
+                        } else {
+                            device = Core::Service<DeviceLowEnergy>::Create<DeviceImpl>(this, _btInterface, address, &config);
+                        }
+
+                        if (device != nullptr) {
+                            _adminLock.Lock();
+                            AddDevice(device);
+                            _adminLock.Unlock();
+                            count++;
+                        }
+                    }
+                }
+
+                TRACE(Trace::Information, (_T("Loaded %i previously discovered device(s)"), count));
+            }
+
+            file.Close();
+        }
+    }
+
+    void BluetoothControl::SaveKnownDevices(const string& pathName) const
+    {
+        Core::File file(pathName + _T("KnownDevices.json"));
+
+        if (file.Create() == true) {
+            KnownDevices known;
+
+            _adminLock.Lock();
+
+            for (const DeviceImpl* device : _devices) {
+                if ((device->IsValid() == true) && (device->IsBonded() == false)) {
+                    KnownDevices::Device& entry(known.Devices.Add());
+                    entry.Address = device->RemoteId();
+                    entry.Type = device->AddressType();
+                    if (device->Name() != _T("[Unknown]")) {
+                        entry.Name = device->Name();
+                    }
+                    if (device->Class() != 0) {
+                        entry.Class = device->Class();
+                    }
+                }
+            }
+
+            _adminLock.Unlock();
+
+            known.IElement::ToFile(file);
+            file.Close();
+        }
+    }
+
     void BluetoothControl::SaveController(const string& pathName, const Data& data)
     {
         Core::File file(pathName + _T("Controller.json"), true);
@@ -697,7 +807,7 @@ namespace Plugin {
 
                         if (device != nullptr) {
 
-                            _devices.push_back(device);
+                            AddDevice(device);
 
                             result = Core::ERROR_NONE;
                         }
@@ -408,21 +408,41 @@ class BluetoothControl : public PluginHost::IPlugin
                 }
             }
 
+            static uint32_t Fingerprint(const le_advertising_info& info)
+            {
+                // FNV-1a over the EIR payload. The event type is not part of it, every type
+                // keeps its own fingerprint, see DeviceImpl::Advertisement().
+                uint32_t result = 2166136261;
+
+                for (uint8_t index = 0; index < info.length; index++) {
+                    result = (result ^ info.data[index]) * 16777619;
+                }
+
+                return (result == 0 ? 1 : result);
+            }
+
         public:
             void Update(const le_advertising_info& info) override
             {
                 BT_TRACE(ControlFlow, info);
                 if ((Application() != nullptr) && (info.bdaddr_type == 0 /* public */)
                         && ((info.evt_type == 0 /* undirected connectable advertisement */) || (info.evt_type == 4 /* scan response */))) {
-                    Bluetooth::EIR eir(info.data, info.length);
+                    // Devices repeat the same advertisement many times per scan window, only
+                    // look into the EIR if it differs from the last one we have seen.
+                    const uint32_t fingerprint = Fingerprint(info);
 
-                    DeviceImpl* device = Application()->Discovered(true, info.bdaddr, eir);
-                    if (device != nullptr) {
-                        if (eir.Class() != 0) {
-                            device->Class(eir.Class());
-                        }
-                        if (eir.CompleteName().empty() == false) {
-                            device->Name(eir.CompleteName());
+                    if (Application()->Advertised(info.bdaddr, info.evt_type, fingerprint) == true) {
+                        Bluetooth::EIR eir(info.data, info.length);
+
+                        DeviceImpl* device = Application()->Discovered(true, info.bdaddr, eir);
+                        if (device != nullptr) {
+                            if (eir.Class() != 0) {
+                                device->Class(eir.Class());
+                            }
+                            if (eir.CompleteName().empty() == false) {
+                                device->Name(eir.CompleteName());
+                            }
+                            device->Advertisement(info.evt_type, fingerprint);
                         }
                     }
                 }
@@ -679,12 +699,14 @@ class BluetoothControl : public PluginHost::IPlugin
                 , Class(0)
                 , AutoPasskeyConfirm(false)
                 , PersistMAC(false)
+                , CacheDevices(true)
             {
                 Add(_T("interface"), &Interface);
                 Add(_T("name"), &Name);
                 Add(_T("class"), &Class);
                 Add(_T("autopasskeyconfirm"), &AutoPasskeyConfirm);
                 Add(_T("persistmac"), &PersistMAC);
+                Add(_T("cachedevices"), &CacheDevices);
             }
             ~Config()
             {
@@ -696,6 +718,7 @@ class BluetoothControl : public PluginHost::IPlugin
             Core::JSON::HexUInt32 Class;
             Core::JSON::Boolean AutoPasskeyConfirm;
             Core::JSON::Boolean PersistMAC;
+            Core::JSON::Boolean CacheDevices;
         }; // class Config
 
         class Data : public Core::JSON::Container {
@@ -716,6 +739,64 @@ class BluetoothControl : public PluginHost::IPlugin
             Core::JSON::String MAC;
         }; // class Data
 
+        // Devices seen before, but not bonded, so they are known again right after a restart.
+        class KnownDevices : public Core::JSON::Container {
+        public:
+            class Device : public Core::JSON::Container {
+            public:
+                Device& operator=(const Device&) = delete;
+                Device()
+                    : Core::JSON::Container()
+                    , Address()
+                    , Type()
+                    , Name()
+                    , Class(0)
+                {
+                    Add(_T("address"), &Address);
+                    Add(_T("type"), &Type);
+                    Add(_T("name"), &Name);
+                    Add(_T("class"), &Class);
+                }
+                Device(const Device& copy)
+                    : Core::JSON::Container()
+                    , Address(copy.Address)
+                    , Type(copy.Type)
+                    , Name(copy.Name)
+                    , Class(copy.Class)
+                {
+                    Add(_T("address"), &Address);
+                    Add(_T("type"), &Type);
+                    Add(_T("name"), &Name);
+                    Add(_T("class"), &Class);
+                }
+                ~Device()
+                {
+                }
+
+            public:
+                Core::JSON::String Address;
+                Core::JSON::EnumType<Bluetooth::Address::type> Type;
+                Core::JSON::String Name;
+                Core::JSON::DecUInt32 Class;
+            }; // class Device
+
+        public:
+            KnownDevices(const KnownDevices&) = delete;
+            KnownDevices& operator=(const KnownDevices&) = delete;
+            KnownDevices()
+                : Core::JSON::Container()
+                , Devices()
+            {
+                Add(_T("devices"), &Devices);
+            }
+            ~KnownDevices()
+            {
+            }
+
+        public:
+            Core::JSON::ArrayType<Device> Devices;
+        }; // class KnownDevices
+
     public:
         class EXTERNAL DeviceImpl : public Exchange::IBluetooth::IDevice {
         private:
@@ -960,6 +1041,7 @@ class BluetoothControl : public PluginHost::IPlugin
                 , _interval(0)
                 , _latency(0)
                 , _timeout(0)
+                , _fingerprint()
                 , _autoConnectionSubmitted(false)
                 , _callback(nullptr)
                 , _securityCallback(nullptr)
@@ -1224,8 +1306,23 @@ class BluetoothControl : public PluginHost::IPlugin
                 if ((IsConnected() == false) && ((_state & ACTION_MASK) == 0)) {
                     _state.SetState(static_cast<state>(0));
                 }
+                _fingerprint[0] = 0;
+                _fingerprint[1] = 0;
                 _state.Unlock();
             }
+            // Remembers the last advertisement seen, returns true if it differs from the previous one.
+            // Devices alternate advertisements and scan responses, so each has a slot of its own.
+            inline bool Advertisement(const uint8_t type, const uint32_t fingerprint)
+            {
+                uint32_t& slot(_fingerprint[type == 4 /* scan response */ ? 1 : 0]);
+
+                _state.Lock();
+                const bool changed = (fingerprint != slot);
+                slot = fingerprint;
+                _state.Unlock();
+
+                return (changed);
+            }
             inline bool operator==(const Bluetooth::Address& rhs) const
             {
                 return (_remote == rhs);
@@ -1565,6 +1662,7 @@ class BluetoothControl : public PluginHost::IPlugin
             uint16_t _interval;
             uint16_t _latency;
             uint16_t _timeout;
+            uint32_t _fingerprint[2];
             bool _autoConnectionSubmitted;
             IBluetooth::IDevice::ICallback* _callback;
             IBluetooth::IDevice::ISecurityCallback* _securityCallback;
@@ -2058,6 +2156,7 @@ class BluetoothControl : public PluginHost::IPlugin
             , _btInterface(0)
             , _btAddress()
             , _devices()
+            , _index()
             , _observers()
         {
             RegisterAll();
@@ -2136,6 +2235,7 @@ class BluetoothControl : public PluginHost::IPlugin
         DEVICE* Find(const Bluetooth::Address& address) const;
         void RemoveDevices(std::function<bool(DeviceImpl*)> filter);
         DeviceImpl* Discovered(const bool lowEnergy, const Bluetooth::Address& address, const Bluetooth::EIR& info);
+        bool Advertised(const Bluetooth::Address& address, const uint8_t type, const uint32_t fingerprint) const;
         void Notification(const uint8_t subEvent, const uint16_t length, const uint8_t* dataFrame);
         void Capabilities(const Bluetooth::Address& device, const uint8_t capability, const uint8_t authentication, const uint8_t oob_data);
         void LoadController(const string& pathName, Data& data) const;
@@ -2145,6 +2245,23 @@ class BluetoothControl : public PluginHost::IPlugin
         uint32_t LoadDevice(const string&, Bluetooth::LinkKeys&, Bluetooth::LongTermKeys&, Bluetooth::IdentityKeys&);
         uint32_t ForgetDevice(const DeviceImpl* device);
         uint32_t SaveDevice(const DeviceImpl* device) const;
+        void LoadKnownDevices(const string& pathName);
+        void SaveKnownDevices(const string& pathName) const;
+        void AddDevice(DeviceImpl* device);
+
+        static uint64_t Key(const Bluetooth::Address& address, const bool lowEnergy)
+        {
+            uint64_t result = (lowEnergy == true ? (1ULL << 48) : 0);
+            const bdaddr_t* data = address.Data();
+
+            if (data != nullptr) {
+                for (uint8_t index = 0; index < sizeof(data->b); index++) {
+                    result |= (static_cast<uint64_t>(data->b[index]) << (8 * index));
+                }
+            }
+
+            return (result);
+        }
 
         bool AutoConfirmPasskey() const
         {
@@ -2183,12 +2300,13 @@ class BluetoothControl : public PluginHost::IPlugin
 
     private:
         uint8_t _skipURL;
-        Core::CriticalSection _adminLock;
+        mutable Core::CriticalSection _adminLock;
         PluginHost::IShell* _service;
         std::list<uint16_t> _adapters;
         uint16_t _btInterface;
         Bluetooth::Address _btAddress;
         std::list<DeviceImpl*> _devices;
+        std::unordered_map<uint64_t, DeviceImpl*> _index;
         std::list<IBluetooth::INotification*> _observers;
         Config _config;
         ControlSocket _application;
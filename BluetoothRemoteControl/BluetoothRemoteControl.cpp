@@ -35,6 +35,8 @@ namespace Plugin {
 
     SERVICE_REGISTRATION(BluetoothRemoteControl, 1, 0);
 
+    static Core::ProxyPoolType<Web::JSONBodyType<BluetoothRemoteControl::NotificationStatistics>> jsonStatisticsFactory(1);
+
     template<typename FROM, typename TO>
     class LUT {
     public:
@@ -232,6 +234,26 @@ namespace Plugin {
         response->ErrorCode = Web::STATUS_BAD_REQUEST;
         response->Message = _T("Unsupported GET request.");
 
+        if ((index.IsValid() == true) && (index.Current() == "Statistics")) {
+            if (_gattRemote != nullptr) {
+                const auto stats(_gattRemote->Statistics());
+                Core::ProxyType<Web::JSONBodyType<NotificationStatistics>> body(jsonStatisticsFactory.Element());
+
+                body->Received = stats.Received;
+                body->Dropped = stats.Dropped;
+                body->AverageLatency = stats.AverageLatency;
+                body->MaxLatency = stats.MaxLatency;
+
+                response->ErrorCode = Web::STATUS_OK;
+                response->Message = _T("OK");
+                response->ContentType = Web::MIMETypes::MIME_JSON;
+                response->Body(Core::proxy_cast<Web::IBody>(body));
+            } else {
+                response->ErrorCode = Web::STATUS_NOT_FOUND;
+                response->Message = _T("No remote is assigned");
+            }
+        }
+
         return (response);
     }
 
@@ -361,9 +383,21 @@ namespace Plugin {
 
         _name = _gattRemote->Name();
 
-        // Store the settings, if not already done..
+        // Store the settings, if not already done or if a rediscovery changed them..
         Core::File settingsFile(_service->PersistentPath() + _gattRemote->Address() + _T(".json"));
-        if ( (settingsFile.Exists() == false) && (settingsFile.Create() == true) ) {
+        string current;
+        string stored;
+
+        settings.ToString(current);
+        if (settingsFile.Open(true) == true) {
+            GATTRemote::Data previous;
+            if (previous.IElement::FromFile(settingsFile) == true) {
+                previous.ToString(stored);
+            }
+            settingsFile.Close();
+        }
+
+        if ( (current != stored) && (settingsFile.Create() == true) ) {
             settings.IElement::ToFile(settingsFile);
             settingsFile.Close();
         }
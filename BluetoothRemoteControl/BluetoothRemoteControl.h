@@ -22,6 +22,8 @@
 #include "Module.h"
 
 #include "Administrator.h"
+#include "DatabaseHash.h"
+#include "NotificationRing.h"
 #include "WAVRecorder.h"
 #include "HID.h"
 
@@ -47,6 +49,33 @@ namespace Plugin {
             SEQUENCED_PERSIST = 0x21
         };
 
+        class NotificationStatistics : public Core::JSON::Container {
+        public:
+            NotificationStatistics(const NotificationStatistics&) = delete;
+            NotificationStatistics& operator=(const NotificationStatistics&) = delete;
+            NotificationStatistics()
+                : Core::JSON::Container()
+                , Received(0)
+                , Dropped(0)
+                , AverageLatency(0)
+                , MaxLatency(0)
+            {
+                Add(_T("received"), &Received);
+                Add(_T("dropped"), &Dropped);
+                Add(_T("averagelatency"), &AverageLatency);
+                Add(_T("maxlatency"), &MaxLatency);
+            }
+            ~NotificationStatistics()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt32 Received;
+            Core::JSON::DecUInt32 Dropped;
+            Core::JSON::DecUInt32 AverageLatency; // us
+            Core::JSON::DecUInt32 MaxLatency; // us
+        };
+
    private:
         class Config : public Core::JSON::Container {
         public:
@@ -78,6 +107,9 @@ namespace Plugin {
         class GATTRemote : public Bluetooth::GATTSocket {
         private:
             static constexpr uint16_t HID_UUID         = 0x1812;
+            static constexpr uint16_t GATT_UUID        = 0x1801;
+            static constexpr uint16_t DATABASE_HASH    = 0x2B2A;
+            static constexpr uint16_t MaxDecodedFrame  = 1024;
 
             class Flow {
             public:
@@ -140,45 +172,23 @@ namespace Plugin {
                 GATTRemote& _parent;
             };
 
+            // Notifications arrive on the GATT socket thread (the only producer) and are handled
+            // on this thread (the only consumer). They are copied once, into a preallocated slot,
+            // and handed to Message() straight from that slot. Voice search streams a dense burst
+            // of notifications, so nothing on this path allocates or takes a lock.
             class Decoupling : public Core::Thread {
             private:
-                class Slot {
-                public:
-                    Slot() = delete;
-                    Slot& operator= (const Slot&) = delete;
-                    Slot(const uint16_t handle, const uint8_t length, const uint8_t data[])
-                        : _handle(handle)
-                        , _data(reinterpret_cast<const char*>(data), length) {
-                    }
-                    Slot(const Slot& copy)
-                        : _handle(copy._handle)
-                        , _data(copy._data) {
-                    }
-                    ~Slot() {
-                    }
-                public:
-                    uint16_t Handle() const {
-                        return (_handle);
-                    }
-                    uint8_t Length() const {
-                        return (static_cast<uint8_t>(_data.length()));
-                    }
-                    const uint8_t* Data() const {
-                        return (reinterpret_cast<const uint8_t*>(_data.c_str()));
-                    }
+                using Ring = NotificationRing<64, 255>;
 
-                private:
-                    uint16_t _handle;
-                    std::string _data;
-                };
+            public:
+                using Statistics = Ring::Statistics;
 
             public:
                 Decoupling(const Decoupling&) = delete;
                 Decoupling& operator=(const Decoupling&) = delete;
                 Decoupling(GATTRemote* parent)
                     : _parent(*parent)
-                    , _adminLock()
-                    , _queue()
+                    , _ring()
                 {
                     ASSERT(parent != nullptr);
                 }
@@ -191,32 +201,35 @@ namespace Plugin {
                 {
                     ASSERT (length > 0);
 
-                    _adminLock.Lock();
-                    _queue.emplace_back(Slot(handle, length, buffer));
-                    _adminLock.Unlock();
-
-                    Run();
+                    // If the consumer can not keep up, rather lose this one than block the socket.
+                    if (_ring.Submit(handle, length, buffer) == true) {
+                        Run();
+                    }
+                }
+                Statistics Report() const
+                {
+                    return (_ring.Report());
                 }
                 uint32_t Worker() override
                 {
                     Block();
 
-                    while (_queue.size() > 0) {
+                    const Ring::Slot* slot;
 
-                        _adminLock.Lock();
-                        Slot entry (_queue.front());
-                        _queue.pop_front();
-                        _adminLock.Unlock();
-                        _parent.Message(entry.Handle(), entry.Length(), entry.Data());
+                    while ((slot = _ring.Receive()) != nullptr) {
+                        _parent.Message(slot->Handle, slot->Length, slot->Data);
+                        _ring.Release();
                     }
 
+                    // Drained, hand over whatever audio was collected as one batch.
+                    _parent.Flush();
+
                     return (Core::infinite);
                 }
 
             private:
                 GATTRemote& _parent;
-                Core::CriticalSection _adminLock;
-                std::list<Slot> _queue;
+                Ring _ring;
             };
 
             class AudioProfile : public Exchange::IVoiceProducer::IProfile {
@@ -269,12 +282,14 @@ namespace Plugin {
                         , SampleRate(8000)
                         , Channels(1)
                         , Resolution(16)
+                        , FrameSize(0)
                     {
                         Add(_T("codec"), &Codec);
                         Add(_T("samplerate"), &SampleRate);
                         Add(_T("channels"), &Channels);
                         Add(_T("resolution"), &Resolution);
                         Add(_T("configuration"), &Configuration);
+                        Add(_T("framesize"), &FrameSize);
                     }
                     ~Profile() override
                     {
@@ -286,6 +301,7 @@ namespace Plugin {
                     Core::JSON::DecUInt8 Channels;
                     Core::JSON::DecUInt8 Resolution;
                     Core::JSON::String Configuration;
+                    Core::JSON::DecUInt16 FrameSize;
                 };
 
             public:
@@ -297,11 +313,13 @@ namespace Plugin {
                     , ServiceUUID()
                     , CommandUUID()
                     , DataUUID()
+                    , Capture()
                 {
                     Add(_T("profile"), &AudioProfile);
                     Add(_T("serviceuuid"), &ServiceUUID);
                     Add(_T("commanduuid"), &CommandUUID);
                     Add(_T("datauuid"), &DataUUID);
+                    Add(_T("capture"), &Capture);
                 }
                 ~Config()
                 {
@@ -312,6 +330,7 @@ namespace Plugin {
                 Core::JSON::String ServiceUUID;
                 Core::JSON::String CommandUUID;
                 Core::JSON::String DataUUID;
+                Core::JSON::String Capture;
             };
 
             class Profile : public Bluetooth::Profile {
@@ -411,6 +430,8 @@ namespace Plugin {
                     , BatteryLevelHandle(0)
                     , VoiceCommandHandle(0)
                     , VoiceDataHandle(0)
+                    , DatabaseHashHandle(0)
+                    , DatabaseHash()
                 {
                     Add(_T("name"), &Name);
                     Add(_T("address"), &Address);
@@ -425,6 +446,8 @@ namespace Plugin {
                     Add(_T("battery"), &BatteryLevelHandle);
                     Add(_T("command"), &VoiceCommandHandle);
                     Add(_T("voice"), &VoiceDataHandle);
+                    Add(_T("hashhandle"), &DatabaseHashHandle);
+                    Add(_T("hash"), &DatabaseHash);
                 }
                ~Data()
                 {
@@ -445,6 +468,8 @@ namespace Plugin {
                Core::JSON::DecUInt16 BatteryLevelHandle;
                Core::JSON::DecUInt16 VoiceCommandHandle;
                Core::JSON::DecUInt16 VoiceDataHandle;
+               Core::JSON::DecUInt16 DatabaseHashHandle;
+               Core::JSON::String DatabaseHash;
             };
 
         public:
@@ -473,12 +498,21 @@ namespace Plugin {
                 , _batteryLevelHandle(~0)
                 , _voiceDataHandle(~0)
                 , _voiceCommandHandle(~0)
+                , _databaseHash()
+                , _configuration(configuration)
                 , _hidReportCharacteristics()
                 , _hidReportCharacteristicsIterator()
                 , _hid()
                 , _hidInputReports()
                 , _audioProfile(nullptr)
                 , _decoder(nullptr)
+                , _startFrame(false)
+                , _currentKey(0)
+                , _batchSequence(0)
+                , _batchLength(0)
+                , _frameSize(0)
+                , _captureFile()
+                , _capture()
             {
                 Config config;
                 config.FromString(configuration);
@@ -514,12 +548,21 @@ namespace Plugin {
                 , _batteryLevelHandle(data.BatteryLevelHandle.Value())
                 , _voiceDataHandle(data.VoiceDataHandle.Value())
                 , _voiceCommandHandle(data.VoiceCommandHandle.Value())
+                , _databaseHash(data.DatabaseHashHandle.Value(), data.DatabaseHash.Value())
+                , _configuration(configuration)
                 , _hidReportCharacteristics()
                 , _hidReportCharacteristicsIterator()
                 , _hid()
                 , _hidInputReports()
                 , _audioProfile(nullptr)
                 , _decoder(nullptr)
+                , _startFrame(false)
+                , _currentKey(0)
+                , _batchSequence(0)
+                , _batchLength(0)
+                , _frameSize(0)
+                , _captureFile()
+                , _capture()
             {
                 if (data.KeysDataHandle.IsSet() == true) {
                     _keysDataHandles.push_back(data.KeysDataHandle.Value());
@@ -551,6 +594,10 @@ namespace Plugin {
                     _device = nullptr;
                 }
 
+                if (_capture.IsOpen() == true) {
+                    _capture.Close();
+                }
+
                 if (_decoder != nullptr) {
                     delete _decoder;
                 }
@@ -593,6 +640,10 @@ namespace Plugin {
             {
                 return (_manufacturerName);
             }
+            inline Decoupling::Statistics Statistics() const
+            {
+                return (_decoupling.Report());
+            }
             inline Exchange::IVoiceProducer::IProfile* SelectedProfile() const
             {
                 ASSERT(_audioProfile != nullptr);
@@ -609,6 +660,7 @@ namespace Plugin {
                 _audioProfile->Release();
 
                 _decoder = Decoders::IDecoder::Instance(config.Codec.Value(), config.Configuration.Value());
+                _frameSize = FrameSize(config.FrameSize.Value());
 
                 if (_decoder == nullptr) {
                     _audioProfile = nullptr;
@@ -634,15 +686,27 @@ namespace Plugin {
                 _adminLock.Lock();
 
                 if ( (handle == _voiceDataHandle) && (_decoder != nullptr) ) {
-                    uint8_t decoded[1024];
-                    uint16_t sendLength = _decoder->Decode(length, buffer, sizeof(decoded), decoded);
+                    if (_capture.IsOpen() == true) {
+                        _capture.Write(&length, sizeof(length));
+                        _capture.Write(buffer, length);
+                    }
+
+                    if ((sizeof(_batch) - _batchLength) < MaxDecodedFrame) {
+                        Send();
+                    }
+
+                    // Decode straight into the batch, it is handed over once the queue is drained.
+                    uint16_t sendLength = _decoder->Decode(length, buffer, static_cast<uint16_t>(sizeof(_batch) - _batchLength), &(_batch[_batchLength]));
                     if (sendLength > 0) {
-                        ASSERT (sendLength <= sizeof(decoded));
+                        ASSERT (sendLength <= (sizeof(_batch) - _batchLength));
                         if (_startFrame == true) {
                             _startFrame = false;
                             _parent->VoiceData(_audioProfile);
                         }
-                        _parent->VoiceData(_decoder->Frames(), sendLength, decoded);
+                        if ((_batchLength == 0) && (_frameSize == 0)) {
+                            _batchSequence = _decoder->Frames();
+                        }
+                        _batchLength += sendLength;
                     }
                 }
                 else if ( (std::any_of(_keysDataHandles.cbegin(), _keysDataHandles.cend(), [handle](const uint16_t reportHandle) { return (reportHandle == handle); }))
@@ -667,12 +731,33 @@ namespace Plugin {
                     // If we start, reset.
                     if (buffer[0] == 0) {
                         // We are done, signal that the button to speak has been released!
+                        Send(true);
                         _parent->VoiceData(nullptr);
+
+                        if (_capture.IsOpen() == true) {
+                            _capture.Close();
+                        }
+
+                        Decoupling::Statistics stats(_decoupling.Report());
+                        TRACE(Flow, (_T("Notifications received: %d, dropped: %d, latency avg: %d us, max: %d us"), stats.Received, stats.Dropped, stats.AverageLatency, stats.MaxLatency));
                     }
                     else {
                         // Looks like the TPress-to-talk button is pressed...
                         _decoder->Reset();
                         _startFrame = true;
+                        _batchLength = 0;
+                        _batchSequence = 0;
+
+                        if (_captureFile.empty() == false) {
+                            // Keep the raw notifications, as they came in, for the decoder benchmark.
+                            if (_capture.IsOpen() == true) {
+                                _capture.Close();
+                            }
+                            _capture = Core::File(_captureFile);
+                            if (_capture.Create() == false) {
+                                TRACE(Trace::Error, (_T("Could not create capture file: %s"), _captureFile.c_str()));
+                            }
+                        }
                     }
                 }
                 else if ( (handle == _batteryLevelHandle) && (length >= 1) ) {
@@ -681,6 +766,48 @@ namespace Plugin {
 
                 _adminLock.Unlock();
             }
+            void Flush()
+            {
+                _adminLock.Lock();
+                Send();
+                _adminLock.Unlock();
+            }
+            // Expects the _adminLock to be taken.
+            void Send(const bool final = false)
+            {
+                if (_frameSize == 0) {
+                    if (_batchLength > 0) {
+                        _parent->VoiceData(_batchSequence, _batchLength, _batch);
+                        _batchLength = 0;
+                    }
+                }
+                else {
+                    // Hand out fixed size frames, the tail waits for the next batch unless the
+                    // session ended, than it goes out as a short frame.
+                    uint16_t offset = 0;
+
+                    while ((_batchLength - offset) >= _frameSize) {
+                        _parent->VoiceData(_batchSequence++, _frameSize, &(_batch[offset]));
+                        offset += _frameSize;
+                    }
+                    if ((final == true) && (offset < _batchLength)) {
+                        _parent->VoiceData(_batchSequence++, _batchLength - offset, &(_batch[offset]));
+                        offset = _batchLength;
+                    }
+                    if (offset > 0) {
+                        _batchLength -= offset;
+                        ::memmove(_batch, &(_batch[offset]), _batchLength);
+                    }
+                }
+            }
+            static uint16_t FrameSize(const uint16_t requested)
+            {
+                // Whatever is left over from a batch needs to fit next to a fresh decode.
+                uint16_t result = std::min(requested, static_cast<uint16_t>(sizeof(_batch) - (2 * MaxDecodedFrame)));
+
+                // Frames carry whole 16 bits samples, so at least one. A frame size of 0 turns framing off.
+                return (result == 0 ? 0 : std::max(static_cast<uint16_t>(result & ~1), static_cast<uint16_t>(2)));
+            }
             void Constructor(const Config& config)
             {
                 ASSERT(_parent != nullptr);
@@ -696,6 +823,8 @@ namespace Plugin {
                 }
 
                 _decoder = Decoders::IDecoder::Instance(config.AudioProfile.Codec.Value(), config.AudioProfile.Configuration.Value());
+                _frameSize = FrameSize(config.AudioProfile.FrameSize.Value());
+                _captureFile = config.Capture.Value();
 
                 if (_decoder != nullptr) {
                     _audioProfile = Core::Service<AudioProfile>::Create<AudioProfile>(
@@ -717,30 +846,91 @@ namespace Plugin {
                     TRACE(Flow, (_T("The received MTU: %d, no need for discovery, we know it all"), MTU()));
 
                     // No need to do service discovery if device knows the Handles to use. If so, DeviceDiscovery has
-                    // already been done and the only thing we need to do is get the startingvalues :-)
-                    ReadSoftwareRevision();
+                    // already been done and the only thing we need to do is to validate them and get the startingvalues :-)
+                    ValidateCache();
                 }
                 else {
                     TRACE(Flow, (_T("The received MTU: %d, we have no clue yet, start discovery"), MTU()));
 
-                    _profile->Discover(CommunicationTimeOut * 20, *this, [&](const uint32_t result) {
-                        if (result == Core::ERROR_NONE) {
-                            DumpProfile();
+                    Discover();
+                }
+            }
+            void Discover()
+            {
+                ASSERT (_profile != nullptr);
 
-                            if ((*_profile)[Bluetooth::UUID(HID_UUID)] == nullptr) {
-                                TRACE(Flow, (_T("The given bluetooth device does not support a HID service!!")));
-                            }
-                            else {
-                                TRACE(Flow, (_T("Reading the remaining information")));
-                                ReadModelNumber();
-                            }
+                _profile->Discover(CommunicationTimeOut * 20, *this, [&](const uint32_t result) {
+                    if (result == Core::ERROR_NONE) {
+                        DumpProfile();
+
+                        if ((*_profile)[Bluetooth::UUID(HID_UUID)] == nullptr) {
+                            TRACE(Flow, (_T("The given bluetooth device does not support a HID service!!")));
                         }
                         else {
-                            TRACE(Flow, (_T("The given bluetooth device could not be read for services!!")));
+                            TRACE(Flow, (_T("Reading the remaining information")));
+                            _databaseHash.Handle(_profile->FindHandle(Bluetooth::UUID(GATT_UUID), Bluetooth::UUID(DATABASE_HASH)));
+                            ReadDatabaseHash();
+                        }
+                    }
+                    else {
+                        TRACE(Flow, (_T("The given bluetooth device could not be read for services!!")));
+                    }
+                });
+            }
+            void ReadDatabaseHash()
+            {
+                if (_databaseHash.Handle() != 0) {
+                    _command.Read(_databaseHash.Handle());
+                    Execute(CommunicationTimeOut, _command, [&](const GATTSocket::Command& cmd) {
+                        _databaseHash.Set(((cmd.Error() == Core::ERROR_NONE) && (cmd.Result().Error() == 0)), cmd.Result().Length(), cmd.Result().Data());
+
+                        if (_databaseHash.IsSet() == false) {
+                            TRACE(Flow, (_T("Failed to read the database hash, handles can not be validated on reconnect")));
+                        }
+
+                        ReadModelNumber();
+                    });
+                } else {
+                    TRACE(Flow, (_T("DatabaseHash characteristic not available")));
+                    ReadModelNumber();
+                }
+            }
+            void ValidateCache()
+            {
+                if (_databaseHash.IsSet() == false) {
+                    // Nothing to validate against, trust the handles as we always did.
+                    ReadSoftwareRevision();
+                } else {
+                    // A single read tells if the attribute table of the remote changed since the discovery.
+                    _command.Read(_databaseHash.Handle());
+                    Execute(CommunicationTimeOut, _command, [&](const GATTSocket::Command& cmd) {
+                        if (_databaseHash.Validate(((cmd.Error() == Core::ERROR_NONE) && (cmd.Result().Error() == 0)), cmd.Result().Length(), cmd.Result().Data()) == DatabaseHash::VALID) {
+                            TRACE(Flow, (_T("Database hash unchanged, using the stored handles")));
+                            ReadSoftwareRevision();
+                        } else {
+                            TRACE(Flow, (_T("Database hash changed, the stored handles are stale, start discovery")));
+                            Invalidate();
+                            Discover();
                         }
                     });
                 }
             }
+            void Invalidate()
+            {
+                Config config;
+                config.FromString(_configuration);
+
+                _softwareRevisionHandle = 0;
+                _keysDataHandles.clear();
+                _batteryLevelHandle = ~0;
+                _voiceDataHandle = ~0;
+                _voiceCommandHandle = ~0;
+                _databaseHash.Clear();
+                _hidReportCharacteristics.clear();
+                _hidInputReports.clear();
+
+                _profile = new Profile(config);
+            }
             void ReadModelNumber()
             {
                 ASSERT (_profile != nullptr);
@@ -1001,6 +1191,10 @@ namespace Plugin {
                 info.BatteryLevelHandle = _batteryLevelHandle;
                 info.VoiceCommandHandle = _voiceCommandHandle;
                 info.VoiceDataHandle = _voiceDataHandle;
+                if (_databaseHash.IsSet() == true) {
+                    info.DatabaseHashHandle = _databaseHash.Handle();
+                    info.DatabaseHash = _databaseHash.Value();
+                }
 
                 info.KeysDataHandles.Clear();
                 for (auto& handle : _keysDataHandles) {
@@ -1105,6 +1299,11 @@ namespace Plugin {
             uint16_t _voiceDataHandle;
             uint16_t _voiceCommandHandle;
 
+            // GATT Caching: the Database Hash of the remote at the time the handles above
+            // were discovered. If it still matches on reconnect, the handles are valid.
+            DatabaseHash _databaseHash;
+            string _configuration;
+
             std::list<const Bluetooth::Profile::Service::Characteristic*> _hidReportCharacteristics;
             std::list<const Bluetooth::Profile::Service::Characteristic*>::const_iterator _hidReportCharacteristicsIterator;
 
@@ -1116,6 +1315,14 @@ namespace Plugin {
             Decoders::IDecoder* _decoder;
             bool _startFrame;
             uint16_t _currentKey;
+
+            // Decoded audio collected while draining the notification queue.
+            uint32_t _batchSequence;
+            uint16_t _batchLength;
+            uint8_t _batch[4 * MaxDecodedFrame];
+            uint16_t _frameSize;
+            string _captureFile;
+            Core::File _capture;
         };
 
     public:
@@ -0,0 +1,119 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+namespace WPEFramework {
+
+namespace Plugin {
+
+    // GATT Caching: the Database Hash characteristic of a remote changes whenever its attribute
+    // table does. A copy stored together with the handles found by a discovery tells, with one
+    // read on reconnect, if those handles can still be used.
+    class DatabaseHash {
+    public:
+        enum state : uint8_t {
+            UNKNOWN, // Nothing stored to validate against, the handles are trusted as is.
+            VALID, // The remote reports the stored hash, the handles are still valid.
+            STALE // The hash changed or could not be read, the handles need a new discovery.
+        };
+
+    public:
+        DatabaseHash(const DatabaseHash&) = delete;
+        DatabaseHash& operator=(const DatabaseHash&) = delete;
+
+        DatabaseHash()
+            : _handle(0)
+            , _value()
+        {
+        }
+        DatabaseHash(const uint16_t handle, const string& value)
+            : _handle(handle)
+            , _value(value)
+        {
+        }
+        ~DatabaseHash()
+        {
+        }
+
+    public:
+        inline bool IsSet() const
+        {
+            return ((_handle != 0) && (_value.empty() == false));
+        }
+        inline uint16_t Handle() const
+        {
+            return (_handle);
+        }
+        inline void Handle(const uint16_t handle)
+        {
+            _handle = handle;
+            _value.clear();
+        }
+        inline const string& Value() const
+        {
+            return (_value);
+        }
+        inline void Clear()
+        {
+            _handle = 0;
+            _value.clear();
+        }
+
+        // Keep what was read from the handle after a discovery, a failed read leaves nothing to validate against.
+        void Set(const bool succeeded, const uint16_t length, const uint8_t data[])
+        {
+            _value.clear();
+
+            if ((succeeded == true) && (length >= 1)) {
+                Core::ToHexString(data, length, _value);
+            }
+        }
+
+        // Compare what was read from the handle on reconnect with the stored hash.
+        state Validate(const bool succeeded, const uint16_t length, const uint8_t data[]) const
+        {
+            state result = UNKNOWN;
+
+            if (IsSet() == true) {
+                result = STALE;
+
+                if ((succeeded == true) && (length >= 1)) {
+                    string hash;
+                    Core::ToHexString(data, length, hash);
+
+                    if (hash == _value) {
+                        result = VALID;
+                    }
+                }
+            }
+
+            return (result);
+        }
+
+    private:
+        uint16_t _handle;
+        string _value;
+    };
+
+} // namespace Plugin
+
+} // namespace WPEFramework
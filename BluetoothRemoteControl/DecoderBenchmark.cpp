@@ -0,0 +1,141 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Runs the voice decoders over a capture of raw voice notifications, as recorded
+// by the plugin when "capture" is set in its configuration (a length byte followed
+// by the notification payload, per notification). Without a capture a synthetic
+// IMA-ADPCM session is generated, so the decoder can be measured on any machine:
+//
+//   VoiceDecoderBenchmark [capture file|-] [pcm|adpcm] [rounds]
+
+#include "Administrator.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace WPEFramework;
+
+namespace {
+
+    typedef std::vector<std::vector<uint8_t>> Notifications;
+
+    bool Load(const string& fileName, Notifications& notifications)
+    {
+        Core::DataElementFile file(fileName, Core::File::USER_READ);
+
+        if (file.IsValid() == true) {
+            const uint8_t* data = file.Buffer();
+            uint64_t offset = 0;
+
+            while ((offset < file.Size()) && ((offset + 1 + data[offset]) <= file.Size())) {
+                notifications.emplace_back(&(data[offset + 1]), &(data[offset + 1 + data[offset]]));
+                offset += 1 + data[offset];
+            }
+        }
+
+        return (notifications.empty() == false);
+    }
+
+    // A header followed by data notifications, like the remotes send for every press-to-talk.
+    void Generate(const uint16_t count, Notifications& notifications)
+    {
+        uint32_t state = 0x5EED;
+
+        notifications.push_back({ 0x00, 0x00, 0x00, 0x00, 0x00 });
+
+        for (uint16_t index = 0; index < count; index++) {
+            std::vector<uint8_t> payload(20);
+
+            for (uint8_t& entry : payload) {
+                state = (state * 1664525) + 1013904223;
+                entry = static_cast<uint8_t>(state >> 16);
+            }
+            notifications.push_back(std::move(payload));
+        }
+
+        notifications.push_back({ 0x00 });
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    const string fileName(argc > 1 ? argv[1] : _T("-"));
+    const string codecName(argc > 2 ? argv[2] : _T("pcm"));
+    const uint32_t rounds = (argc > 3 ? atoi(argv[3]) : 1000);
+
+    Exchange::IVoiceProducer::IProfile::codec codec;
+
+    if (codecName == _T("pcm")) {
+        codec = Exchange::IVoiceProducer::IProfile::codec::PCM;
+    }
+    else if (codecName == _T("adpcm")) {
+        codec = Exchange::IVoiceProducer::IProfile::codec::ADPCM;
+    }
+    else {
+        fprintf(stderr, "Usage: %s [capture file|-] [pcm|adpcm] [rounds]\n", argv[0]);
+        return (1);
+    }
+
+    Notifications notifications;
+
+    if (fileName == _T("-")) {
+        Generate(4000, notifications);
+    }
+    else if (Load(fileName, notifications) == false) {
+        fprintf(stderr, "Could not load any notification from: %s\n", fileName.c_str());
+        return (1);
+    }
+
+    Decoders::IDecoder* decoder = Decoders::IDecoder::Instance(codec, string());
+
+    if (decoder == nullptr) {
+        fprintf(stderr, "No decoder available for: %s\n", codecName.c_str());
+        return (1);
+    }
+
+    uint8_t output[1024];
+    uint64_t input = 0;
+    uint64_t decoded = 0;
+    const uint64_t start = Core::Time::Now().Ticks();
+
+    for (uint32_t round = 0; round < rounds; round++) {
+        decoder->Reset();
+
+        for (const std::vector<uint8_t>& entry : notifications) {
+            input += entry.size();
+            decoded += decoder->Decode(static_cast<uint16_t>(entry.size()), entry.data(), sizeof(output), output);
+        }
+    }
+
+    const uint64_t duration = std::max(Core::Time::Now().Ticks() - start, static_cast<uint64_t>(1));
+
+    printf("%s, %u notifications, %u rounds\n", codecName.c_str(), static_cast<uint32_t>(notifications.size()), rounds);
+    printf("input:      %llu bytes\n", static_cast<unsigned long long>(input));
+    printf("output:     %llu bytes\n", static_cast<unsigned long long>(decoded));
+    printf("duration:   %llu us\n", static_cast<unsigned long long>(duration));
+    printf("throughput: %.2f MB/s output\n", static_cast<double>(decoded) / duration);
+    printf("last round: %u frames, %u dropped\n", decoder->Frames(), decoder->Dropped());
+
+    delete decoder;
+
+    Core::Singleton::Dispose();
+
+    return (0);
+}
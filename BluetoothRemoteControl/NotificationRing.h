@@ -0,0 +1,151 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+#include <atomic>
+
+namespace WPEFramework {
+
+namespace Plugin {
+
+    // Preallocated ring of fixed size notifications, for exactly one producer and one
+    // consumer thread. They coordinate through the head and tail indices only, so neither
+    // side allocates, copies more than once or takes a lock. If the ring is full, a new
+    // notification is dropped (and counted) rather than blocking the producer.
+    template <const uint16_t SLOTS, const uint16_t PAYLOAD>
+    class NotificationRing {
+    private:
+        static_assert((SLOTS & (SLOTS - 1)) == 0, "SLOTS must be a power of 2");
+        static_assert(PAYLOAD <= 255, "The length of a notification is kept in a byte");
+
+    public:
+        struct Slot {
+            uint64_t Submitted;
+            uint16_t Handle;
+            uint8_t Length;
+            uint8_t Data[PAYLOAD];
+        };
+
+        struct Statistics {
+            uint32_t Received;
+            uint32_t Dropped;
+            uint32_t AverageLatency; // us
+            uint32_t MaxLatency; // us
+        };
+
+    public:
+        NotificationRing(const NotificationRing<SLOTS, PAYLOAD>&) = delete;
+        NotificationRing<SLOTS, PAYLOAD>& operator=(const NotificationRing<SLOTS, PAYLOAD>&) = delete;
+
+        NotificationRing()
+            : _head(0)
+            , _tail(0)
+            , _received(0)
+            , _dropped(0)
+            , _totalLatency(0)
+            , _maxLatency(0)
+        {
+        }
+        ~NotificationRing()
+        {
+        }
+
+    public:
+        // Producer side. Returns false if the notification was dropped. Payloads longer than
+        // a slot are cut off.
+        bool Submit(const uint16_t handle, const uint8_t length, const uint8_t buffer[])
+        {
+            bool result = false;
+            const uint32_t head = _head.load(std::memory_order_relaxed);
+
+            if ((head - _tail.load(std::memory_order_acquire)) >= SLOTS) {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                Slot& slot(_slots[head & (SLOTS - 1)]);
+
+                slot.Submitted = Core::Time::Now().Ticks();
+                slot.Handle = handle;
+                slot.Length = std::min(length, static_cast<uint8_t>(PAYLOAD));
+                ::memcpy(slot.Data, buffer, slot.Length);
+
+                _head.store(head + 1, std::memory_order_release);
+
+                result = true;
+            }
+
+            return (result);
+        }
+
+        // Consumer side. The oldest notification, or nullptr if there is none. It is counted
+        // as received and stays untouched by the producer until it is released.
+        const Slot* Receive()
+        {
+            const Slot* result = nullptr;
+            const uint32_t tail = _tail.load(std::memory_order_relaxed);
+
+            if (tail != _head.load(std::memory_order_acquire)) {
+                result = &(_slots[tail & (SLOTS - 1)]);
+
+                const uint32_t latency = static_cast<uint32_t>(Core::Time::Now().Ticks() - result->Submitted);
+
+                _received.fetch_add(1, std::memory_order_relaxed);
+                _totalLatency.fetch_add(latency, std::memory_order_relaxed);
+                if (latency > _maxLatency.load(std::memory_order_relaxed)) {
+                    _maxLatency.store(latency, std::memory_order_relaxed);
+                }
+            }
+
+            return (result);
+        }
+        void Release()
+        {
+            const uint32_t tail = _tail.load(std::memory_order_relaxed);
+
+            ASSERT(tail != _head.load(std::memory_order_acquire));
+
+            // Only now the producer may reuse the slot.
+            _tail.store(tail + 1, std::memory_order_release);
+        }
+
+        Statistics Report() const
+        {
+            Statistics result;
+            result.Received = _received.load(std::memory_order_relaxed);
+            result.Dropped = _dropped.load(std::memory_order_relaxed);
+            result.AverageLatency = (result.Received != 0 ? static_cast<uint32_t>(_totalLatency.load(std::memory_order_relaxed) / result.Received) : 0);
+            result.MaxLatency = _maxLatency.load(std::memory_order_relaxed);
+            return (result);
+        }
+
+    private:
+        std::atomic<uint32_t> _head;
+        std::atomic<uint32_t> _tail;
+        std::atomic<uint32_t> _received;
+        std::atomic<uint32_t> _dropped;
+        std::atomic<uint64_t> _totalLatency;
+        std::atomic<uint32_t> _maxLatency;
+        Slot _slots[SLOTS];
+    };
+
+} // namespace Plugin
+
+} // namespace WPEFramework
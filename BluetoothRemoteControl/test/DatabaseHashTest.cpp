@@ -0,0 +1,108 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../DatabaseHash.h"
+#include "Test.h"
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace WPEFramework;
+
+namespace {
+
+    const uint8_t Hash[] = { 0x3A, 0x91, 0x00, 0xFF, 0x10, 0x22, 0x5E, 0x7C, 0x01, 0x02, 0x03, 0x04, 0xA0, 0xB0, 0xC0, 0xD0 };
+    const uint8_t Other[] = { 0x3A, 0x91, 0x00, 0xFF, 0x10, 0x22, 0x5E, 0x7C, 0x01, 0x02, 0x03, 0x04, 0xA0, 0xB0, 0xC0, 0xD1 };
+
+    void Discovery()
+    {
+        Plugin::DatabaseHash hash;
+
+        // Nothing discovered yet, nothing to validate.
+        CHECK(hash.IsSet() == false);
+        CHECK(hash.Validate(true, sizeof(Hash), Hash) == Plugin::DatabaseHash::UNKNOWN);
+
+        // A remote without the characteristic.
+        hash.Handle(0);
+        hash.Set(true, sizeof(Hash), Hash);
+        CHECK(hash.IsSet() == false);
+
+        // The characteristic is there, but could not be read.
+        hash.Handle(0x0021);
+        hash.Set(false, sizeof(Hash), Hash);
+        CHECK(hash.IsSet() == false);
+        CHECK(hash.Handle() == 0x0021);
+
+        hash.Set(true, 0, Hash);
+        CHECK(hash.IsSet() == false);
+
+        // Read after the discovery.
+        hash.Set(true, sizeof(Hash), Hash);
+        CHECK(hash.IsSet() == true);
+        CHECK(hash.Handle() == 0x0021);
+        CHECK(hash.Value().empty() == false);
+
+        // A new discovery forgets the previous value.
+        hash.Handle(0x0042);
+        CHECK(hash.IsSet() == false);
+        CHECK(hash.Value().empty() == true);
+
+        hash.Clear();
+        CHECK(hash.Handle() == 0);
+    }
+
+    void Reconnect()
+    {
+        Plugin::DatabaseHash discovered;
+        discovered.Handle(0x0021);
+        discovered.Set(true, sizeof(Hash), Hash);
+
+        // As stored in the settings file and read back on the next start.
+        Plugin::DatabaseHash stored(discovered.Handle(), discovered.Value());
+        CHECK(stored.IsSet() == true);
+
+        CHECK(stored.Validate(true, sizeof(Hash), Hash) == Plugin::DatabaseHash::VALID);
+
+        // The attribute table changed.
+        CHECK(stored.Validate(true, sizeof(Other), Other) == Plugin::DatabaseHash::STALE);
+        CHECK(stored.Validate(true, sizeof(Hash) - 1, Hash) == Plugin::DatabaseHash::STALE);
+
+        // A read that failed or returned nothing can not vouch for the handles.
+        CHECK(stored.Validate(false, sizeof(Hash), Hash) == Plugin::DatabaseHash::STALE);
+        CHECK(stored.Validate(true, 0, Hash) == Plugin::DatabaseHash::STALE);
+
+        // Settings of a remote that had no hash.
+        Plugin::DatabaseHash old(0, string());
+        CHECK(old.Validate(true, sizeof(Hash), Hash) == Plugin::DatabaseHash::UNKNOWN);
+        CHECK(old.Validate(false, 0, nullptr) == Plugin::DatabaseHash::UNKNOWN);
+
+        Plugin::DatabaseHash handleOnly(0x0021, string());
+        CHECK(handleOnly.Validate(true, sizeof(Hash), Hash) == Plugin::DatabaseHash::UNKNOWN);
+    }
+
+}
+
+int main(int, char*[])
+{
+    Discovery();
+    Reconnect();
+
+    Core::Singleton::Dispose();
+
+    return (Test::Failures());
+}
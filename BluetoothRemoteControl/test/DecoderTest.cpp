@@ -0,0 +1,296 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../Administrator.h"
+#include "Test.h"
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace WPEFramework;
+
+namespace {
+
+    // Straight from the IMA-ADPCM specification, one sample at a time, to hold the
+    // table driven decoder against.
+    class Reference {
+    public:
+        Reference(const Reference&) = delete;
+        Reference& operator=(const Reference&) = delete;
+
+        Reference()
+            : _predictor(0)
+            , _index(0)
+        {
+        }
+
+    public:
+        void Header(const uint8_t header[5])
+        {
+            _predictor = static_cast<int16_t>((header[3] << 8) | header[2]);
+            _index = std::min(header[1], static_cast<uint8_t>(88));
+        }
+        void Decode(const uint16_t length, const uint8_t data[], std::vector<int16_t>& output)
+        {
+            for (uint16_t index = 0; index < length; index++) {
+                output.push_back(Nibble(data[index] & 0xF));
+                output.push_back(Nibble((data[index] >> 4) & 0xF));
+            }
+        }
+
+    private:
+        int16_t Nibble(const uint8_t nibble)
+        {
+            static const int8_t IndexTable[] = { -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8 };
+            static const uint16_t StepTable[] = {
+                7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31,
+                34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143,
+                157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658,
+                724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024,
+                3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+                15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+            };
+
+            const int32_t step = StepTable[_index];
+            int32_t difference = (step >> 3);
+
+            if ((nibble & 4) != 0) {
+                difference += step;
+            }
+            if ((nibble & 2) != 0) {
+                difference += (step >> 1);
+            }
+            if ((nibble & 1) != 0) {
+                difference += (step >> 2);
+            }
+
+            int32_t predictor = ((nibble & 8) != 0 ? _predictor - difference : _predictor + difference);
+            _predictor = static_cast<int16_t>(std::min(std::max(predictor, static_cast<int32_t>(-32767)), static_cast<int32_t>(32767)));
+            _index = static_cast<uint8_t>(std::min(std::max(static_cast<int32_t>(_index) + IndexTable[nibble], static_cast<int32_t>(0)), static_cast<int32_t>(88)));
+
+            return (_predictor);
+        }
+
+    private:
+        int16_t _predictor;
+        uint8_t _index;
+    };
+
+    class Session {
+    public:
+        Session(const Session&) = delete;
+        Session& operator=(const Session&) = delete;
+
+        Session()
+            : _state(0x5EED)
+        {
+        }
+
+    public:
+        std::vector<uint8_t> Header(const uint8_t sequence, const uint8_t index, const int16_t predictor)
+        {
+            return (std::vector<uint8_t>({ sequence, index, static_cast<uint8_t>(predictor & 0xFF), static_cast<uint8_t>((predictor >> 8) & 0xFF), 0x00 }));
+        }
+        std::vector<uint8_t> Data(const uint8_t length)
+        {
+            std::vector<uint8_t> result(length);
+
+            for (uint8_t& entry : result) {
+                _state = (_state * 1664525) + 1013904223;
+                entry = static_cast<uint8_t>(_state >> 16);
+            }
+
+            return (result);
+        }
+
+    private:
+        uint32_t _state;
+    };
+
+    Decoders::IDecoder* Create()
+    {
+        Decoders::IDecoder* decoder = Decoders::IDecoder::Instance(Exchange::IVoiceProducer::IProfile::codec::PCM, string());
+
+        if (decoder != nullptr) {
+            decoder->Reset();
+        }
+
+        return (decoder);
+    }
+
+    uint16_t Decode(Decoders::IDecoder& decoder, const std::vector<uint8_t>& input, const uint16_t room, std::vector<int16_t>& output)
+    {
+        int16_t buffer[512];
+
+        ASSERT(room <= sizeof(buffer));
+
+        const uint16_t length = decoder.Decode(static_cast<uint16_t>(input.size()), input.data(), room, reinterpret_cast<uint8_t*>(buffer));
+        output.insert(output.end(), buffer, buffer + (length / sizeof(int16_t)));
+
+        return (length);
+    }
+
+    void Samples()
+    {
+        Decoders::IDecoder* decoder = Create();
+        CHECK(decoder != nullptr);
+
+        if (decoder != nullptr) {
+            Session session;
+            Reference reference;
+            std::vector<int16_t> decoded;
+            std::vector<int16_t> expected;
+
+            // Nothing comes out before the first header.
+            CHECK(Decode(*decoder, session.Data(20), 1024, decoded) == 0);
+
+            // A few frames, each header restarts the predictor and the step index.
+            const int16_t predictors[] = { 0, 1000, -1000, 32000, -32000 };
+            const uint8_t indices[] = { 0, 20, 45, 88, 200 };
+
+            for (uint8_t frame = 0; frame < 5; frame++) {
+                const std::vector<uint8_t> header(session.Header(frame, indices[frame], predictors[frame]));
+
+                CHECK(Decode(*decoder, header, 1024, decoded) == 0);
+                reference.Header(header.data());
+
+                for (uint8_t notification = 0; notification < 4; notification++) {
+                    const std::vector<uint8_t> data(session.Data(20));
+
+                    CHECK(Decode(*decoder, data, 1024, decoded) == (20 * 2 * sizeof(int16_t)));
+                    reference.Decode(static_cast<uint16_t>(data.size()), data.data(), expected);
+                }
+            }
+
+            CHECK(Decode(*decoder, std::vector<uint8_t>({ 0x00 }), 1024, decoded) == 0);
+
+            CHECK(decoded.size() == expected.size());
+            CHECK(decoded == expected);
+
+            delete decoder;
+        }
+    }
+
+    void Saturation()
+    {
+        Decoders::IDecoder* decoder = Create();
+        CHECK(decoder != nullptr);
+
+        if (decoder != nullptr) {
+            Session session;
+            std::vector<int16_t> decoded;
+
+            // The largest positive and negative steps, over and over again.
+            Decode(*decoder, session.Header(0, 88, 32000), 1024, decoded);
+            Decode(*decoder, std::vector<uint8_t>(16, 0x77), 1024, decoded);
+            CHECK(decoded.size() == 32);
+            CHECK(decoded.back() == 32767);
+
+            decoded.clear();
+            Decode(*decoder, session.Header(1, 88, -32000), 1024, decoded);
+            Decode(*decoder, std::vector<uint8_t>(16, 0xFF), 1024, decoded);
+            CHECK(decoded.size() == 32);
+            CHECK(decoded.back() == -32767);
+
+            delete decoder;
+        }
+    }
+
+    void Truncation()
+    {
+        Decoders::IDecoder* decoder = Create();
+        Decoders::IDecoder* full = Create();
+        CHECK((decoder != nullptr) && (full != nullptr));
+
+        if ((decoder != nullptr) && (full != nullptr)) {
+            Session session;
+            std::vector<int16_t> decoded;
+            std::vector<int16_t> expected;
+            const std::vector<uint8_t> header(session.Header(0, 30, 500));
+            const std::vector<uint8_t> first(session.Data(20));
+            const std::vector<uint8_t> second(session.Data(20));
+
+            Decode(*decoder, header, 1024, decoded);
+            Decode(*full, header, 1024, expected);
+
+            // Room for 5 input bytes only, or even less than a single one.
+            CHECK(Decode(*decoder, first, 5 * 2 * sizeof(int16_t), decoded) == (5 * 2 * sizeof(int16_t)));
+            CHECK(Decode(*full, first, 1024, expected) == (20 * 2 * sizeof(int16_t)));
+            CHECK(std::equal(decoded.begin(), decoded.end(), expected.begin()) == true);
+
+            CHECK(Decode(*decoder, second, 3, decoded) == 0);
+            Decode(*full, second, 1024, expected);
+
+            // The state followed the complete input, so the next notification is decoded as if nothing was cut off.
+            const std::vector<uint8_t> third(session.Data(20));
+            std::vector<int16_t> last;
+            std::vector<int16_t> lastExpected;
+
+            Decode(*decoder, third, 1024, last);
+            Decode(*full, third, 1024, lastExpected);
+            CHECK(last == lastExpected);
+
+            delete full;
+            delete decoder;
+        }
+    }
+
+    void Sequence()
+    {
+        Decoders::IDecoder* decoder = Create();
+        CHECK(decoder != nullptr);
+
+        if (decoder != nullptr) {
+            Session session;
+            std::vector<int16_t> decoded;
+
+            for (const uint8_t sequence : { 0, 1, 2, 5 }) {
+                Decode(*decoder, session.Header(sequence, 0, 0), 1024, decoded);
+                Decode(*decoder, session.Data(20), 1024, decoded);
+            }
+
+            CHECK(decoder->Frames() == 3);
+            CHECK(decoder->Dropped() == 2);
+
+            // The sequence number wraps at 32.
+            decoder->Reset();
+            for (const uint8_t sequence : { 30, 31, 1 }) {
+                Decode(*decoder, session.Header(sequence, 0, 0), 1024, decoded);
+                Decode(*decoder, session.Data(20), 1024, decoded);
+            }
+
+            CHECK(decoder->Frames() == 2);
+            CHECK(decoder->Dropped() == 1);
+
+            delete decoder;
+        }
+    }
+
+}
+
+int main(int, char*[])
+{
+    Samples();
+    Saturation();
+    Truncation();
+    Sequence();
+
+    Core::Singleton::Dispose();
+
+    return (Test::Failures());
+}
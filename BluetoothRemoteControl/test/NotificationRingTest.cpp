@@ -0,0 +1,222 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../NotificationRing.h"
+#include "Test.h"
+
+#include <thread>
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace WPEFramework;
+
+namespace {
+
+    using Ring = Plugin::NotificationRing<8, 20>;
+
+    // Every notification carries its sequence number, followed by a pattern derived from it.
+    uint8_t Fill(const uint32_t sequence, uint8_t buffer[])
+    {
+        const uint8_t length = static_cast<uint8_t>(4 + (sequence % 17));
+
+        ::memcpy(buffer, &sequence, sizeof(sequence));
+        for (uint8_t index = 4; index < length; index++) {
+            buffer[index] = static_cast<uint8_t>(sequence + index);
+        }
+
+        return (length);
+    }
+    bool Verify(const Ring::Slot& slot, uint32_t& sequence)
+    {
+        uint8_t expected[32];
+
+        ::memcpy(&sequence, slot.Data, sizeof(sequence));
+
+        const uint8_t length = Fill(sequence, expected);
+
+        return ((slot.Handle == static_cast<uint16_t>(sequence)) && (slot.Length == length) && (::memcmp(slot.Data, expected, length) == 0));
+    }
+
+    void Order()
+    {
+        Ring ring;
+        uint8_t buffer[32];
+        uint32_t sequence;
+
+        CHECK(ring.Receive() == nullptr);
+
+        // Run the indices around the ring a number of times, with the ring filled up to different levels.
+        uint32_t submitted = 0;
+        uint32_t received = 0;
+
+        for (uint32_t round = 0; round < 100; round++) {
+            for (uint32_t count = 0; count < ((round % 8) + 1); count++, submitted++) {
+                const uint8_t length = Fill(submitted, buffer);
+                CHECK(ring.Submit(static_cast<uint16_t>(submitted), length, buffer) == true);
+            }
+
+            const Ring::Slot* slot;
+            while ((slot = ring.Receive()) != nullptr) {
+                CHECK(Verify(*slot, sequence) == true);
+                CHECK(sequence == received);
+                received++;
+                ring.Release();
+            }
+        }
+
+        CHECK(received == submitted);
+
+        const Ring::Statistics stats(ring.Report());
+        CHECK(stats.Received == received);
+        CHECK(stats.Dropped == 0);
+        CHECK(stats.MaxLatency >= stats.AverageLatency);
+    }
+
+    void Overflow()
+    {
+        Ring ring;
+        uint8_t buffer[32];
+        uint32_t sequence;
+
+        for (uint32_t index = 0; index < 8; index++) {
+            const uint8_t length = Fill(index, buffer);
+            CHECK(ring.Submit(static_cast<uint16_t>(index), length, buffer) == true);
+        }
+
+        // Full, the new ones are dropped, the queued ones are kept.
+        for (uint32_t index = 8; index < 11; index++) {
+            const uint8_t length = Fill(index, buffer);
+            CHECK(ring.Submit(static_cast<uint16_t>(index), length, buffer) == false);
+        }
+        CHECK(ring.Report().Dropped == 3);
+
+        // A slot that is received, but not released yet, is not available to the producer.
+        const Ring::Slot* slot = ring.Receive();
+        CHECK((slot != nullptr) && (Verify(*slot, sequence) == true) && (sequence == 0));
+        CHECK(ring.Submit(11, Fill(11, buffer), buffer) == false);
+        ring.Release();
+
+        CHECK(ring.Submit(12, Fill(12, buffer), buffer) == true);
+
+        for (const uint32_t expected : { 1, 2, 3, 4, 5, 6, 7, 12 }) {
+            slot = ring.Receive();
+            CHECK((slot != nullptr) && (Verify(*slot, sequence) == true) && (sequence == expected));
+            ring.Release();
+        }
+        CHECK(ring.Receive() == nullptr);
+
+        const Ring::Statistics stats(ring.Report());
+        CHECK(stats.Received == 9);
+        CHECK(stats.Dropped == 4);
+    }
+
+    void Truncation()
+    {
+        Ring ring;
+        uint8_t buffer[255];
+
+        for (uint16_t index = 0; index < sizeof(buffer); index++) {
+            buffer[index] = static_cast<uint8_t>(index);
+        }
+
+        CHECK(ring.Submit(0x0042, sizeof(buffer), buffer) == true);
+
+        const Ring::Slot* slot = ring.Receive();
+        CHECK(slot != nullptr);
+        if (slot != nullptr) {
+            CHECK(slot->Handle == 0x0042);
+            CHECK(slot->Length == 20);
+            CHECK(::memcmp(slot->Data, buffer, 20) == 0);
+            ring.Release();
+        }
+    }
+
+    // The GATT socket thread against the decoupling thread: whatever is not dropped arrives
+    // once, intact and in order.
+    void Threads()
+    {
+        static constexpr uint32_t Count = 200000;
+
+        Ring ring;
+        uint32_t accepted = 0;
+        uint32_t received = 0;
+        uint32_t errors = 0;
+        std::atomic<bool> done(false);
+
+        std::thread consumer([&]() {
+            uint32_t previous = ~0;
+            uint32_t sequence;
+            const Ring::Slot* slot;
+
+            do {
+                const bool last = done.load();
+
+                while ((slot = ring.Receive()) != nullptr) {
+                    if ((Verify(*slot, sequence) == false) || ((previous != static_cast<uint32_t>(~0)) && (sequence <= previous))) {
+                        errors++;
+                    }
+                    previous = sequence;
+                    received++;
+                    ring.Release();
+                }
+
+                if (last == true) {
+                    break;
+                }
+                std::this_thread::yield();
+            } while (true);
+        });
+
+        uint8_t buffer[32];
+
+        for (uint32_t index = 0; index < Count; index++) {
+            const uint8_t length = Fill(index, buffer);
+
+            if (ring.Submit(static_cast<uint16_t>(index), length, buffer) == true) {
+                accepted++;
+            }
+            if ((index % 64) == 0) {
+                std::this_thread::yield();
+            }
+        }
+
+        done.store(true);
+        consumer.join();
+
+        const Ring::Statistics stats(ring.Report());
+
+        CHECK(errors == 0);
+        CHECK(received == accepted);
+        CHECK(stats.Received == accepted);
+        CHECK((stats.Received + stats.Dropped) == Count);
+    }
+
+}
+
+int main(int, char*[])
+{
+    Order();
+    Overflow();
+    Truncation();
+    Threads();
+
+    Core::Singleton::Dispose();
+
+    return (Test::Failures());
+}
@@ -18,6 +18,7 @@
  */
  
 #include "Cobalt.h"
+#include "MemoryPressure.h"
 
 namespace WPEFramework {
 namespace Cobalt {
@@ -52,6 +53,7 @@ static Core::ProxyPoolType<Web::JSONBodyType<Cobalt::Data>> jsonBodyDataFactory(
     // change to "register" the sink for these events !!! So do it ahead of
     // instantiation.
     _service->Register(&_notification);
+    MemoryPressureObserver::Host();
     _cobalt = _service->Root < Exchange::IBrowser
             > (_connectionId, 2000, _T("CobaltImplementation"));
 
@@ -121,8 +123,7 @@ static Core::ProxyPoolType<Web::JSONBodyType<Cobalt::Data>> jsonBodyDataFactory(
 }
 
 /* virtual */string Cobalt::Information() const {
-    // No additional info to report.
-    return (string());
+    return (MemoryPressureObserver::Report(_service));
 }
 
 /* virtual */void Cobalt::Inbound(Web::Request &request) {
@@ -20,6 +20,8 @@
 #include "Module.h"
 #include <interfaces/IMemory.h>
 #include <interfaces/IBrowser.h>
+#include "MemoryObserver.h"
+#include "MemoryPressure.h"
 
 #include "starboard/export.h"
 #include "third_party/starboard/wpe/shared/cobalt_api_wpe.h"
@@ -31,7 +33,8 @@ namespace Plugin {
 
 class CobaltImplementation:
         public Exchange::IBrowser,
-        public PluginHost::IStateControl {
+        public PluginHost::IStateControl,
+        public MemoryPressureObserver::ITrimmer {
 private:
     class Config: public Core::JSON::Container {
     private:
@@ -45,6 +48,7 @@ private:
             Add(_T("width"), &Width);
             Add(_T("height"), &Height);
             Add(_T("clientidentifier"), &ClientIdentifier);
+            Add(_T("memorytrim"), &MemoryTrim);
         }
         ~Config() {
         }
@@ -54,6 +58,7 @@ private:
         Core::JSON::DecUInt16 Width;
         Core::JSON::DecUInt16 Height;
         Core::JSON::String ClientIdentifier;
+        MemoryPressureObserver::Config MemoryTrim;
     };
 
     class NotificationSink: public Core::Thread {
@@ -197,10 +202,12 @@ public:
             _state(PluginHost::IStateControl::UNINITIALIZED),
             _cobaltClients(),
             _stateControlClients(),
-            _sink(*this) {
+            _sink(*this),
+            _pressure(*this) {
     }
 
     virtual ~CobaltImplementation() {
+        _pressure.Close();
     }
 
     virtual uint32_t Configure(PluginHost::IShell *service) {
@@ -208,6 +215,13 @@ public:
         _window.Suspend(true);
         _state = PluginHost::IStateControl::SUSPENDED;
 
+        Config config;
+        config.FromString(service->ConfigLine());
+
+        if ((config.MemoryTrim.Enabled.Value() == true) && (_pressure.Open(config.MemoryTrim, MemoryPressureObserver::FileName(service)) != Core::ERROR_NONE)) {
+            SYSLOG(Logging::Notification, (_T("Could not observe the memory pressure through %s"), config.MemoryTrim.Source.Value().c_str()));
+        }
+
         return (result);
     }
 
@@ -370,6 +384,14 @@ public:
     END_INTERFACE_MAP
 
 private:
+    // MemoryPressureObserver::ITrimmer
+    void Trim(const MemoryPressureObserver::level which) override {
+        // The starboard WPE API offers no hook into the image, font or JS caches of Cobalt, so
+        // all that is left is giving the free heap back to the system, which the observer does
+        // from the high level on.
+        TRACE_L1("Memory pressure %s, nothing to trim in Cobalt itself", MemoryPressureObserver::Name(which));
+    }
+
     inline bool RequestForStateChange(
             const PluginHost::IStateControl::command command) {
         bool result = false;
@@ -417,6 +439,7 @@ private:
     std::list<Exchange::IBrowser::INotification*> _cobaltClients;
     std::list<PluginHost::IStateControl::INotification*> _stateControlClients;
     NotificationSink _sink;
+    MemoryPressureObserver _pressure;
 };
 
 SERVICE_REGISTRATION(CobaltImplementation, 1, 0);
@@ -426,46 +449,9 @@ SERVICE_REGISTRATION(CobaltImplementation, 1, 0);
 
 namespace Cobalt {
 
-class MemoryObserverImpl: public Exchange::IMemory {
-private:
-    MemoryObserverImpl();
-    MemoryObserverImpl(const MemoryObserverImpl&);
-    MemoryObserverImpl& operator=(const MemoryObserverImpl&);
-
-    public:
-    MemoryObserverImpl(const RPC::IRemoteConnection* connection) :
-        _main(connection == nullptr ? Core::ProcessInfo().Id() : connection->RemoteId()) {
-    }
-    ~MemoryObserverImpl() {
-    }
-
-    public:
-    virtual uint64_t Resident() const {
-        return _main.Resident();
-    }
-    virtual uint64_t Allocated() const {
-        return _main.Allocated();
-    }
-    virtual uint64_t Shared() const {
-        return _main.Shared();
-    }
-    virtual uint8_t Processes() const {
-        return (IsOperational() ? 1 : 0);
-    }
-
-    virtual const bool IsOperational() const {
-        return _main.IsActive();
-    }
-
-    BEGIN_INTERFACE_MAP (MemoryObserverImpl)INTERFACE_ENTRY (Exchange::IMemory)END_INTERFACE_MAP
-
-private:
-    Core::ProcessInfo _main;
-    };
-
     Exchange::IMemory* MemoryObserver(const RPC::IRemoteConnection* connection) {
         ASSERT(connection != nullptr);
-        Exchange::IMemory* result = Core::Service<MemoryObserverImpl>::Create<Exchange::IMemory>(connection);
+        Exchange::IMemory* result = Core::Service<Plugin::MemoryObserverImpl>::Create<Exchange::IMemory>(connection->RemoteId());
         return (result);
     }
 }
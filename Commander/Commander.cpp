@@ -77,7 +77,8 @@ namespace Plugin {
                 Core::ProxyType<Sequencer>::Create(
                     index.Current().Value(),
                     &_commandAdministrator,
-                    _service)));
+                    _service,
+                    config.Parallel.Value())));
         }
 
         // On succes return "".
@@ -93,10 +94,8 @@ namespace Plugin {
 
         while (index != _sequencers.end()) {
 
-            Core::ProxyType<Core::IDispatchType<void>> job(Core::proxy_cast<Core::IDispatchType<void>>(index->second));
-
             index->second->Abort();
-            Core::IWorkerPool::Instance().Revoke(job);
+            index->second->Wait(Core::infinite);
 
             index++;
         }
@@ -203,12 +202,11 @@ namespace Plugin {
             } else {
                 // Current name, is the name of the sequencer
                 Core::ProxyType<Sequencer> sequencer(_sequencers[index.Current().Text()]);
-                Core::ProxyType<Core::IDispatchType<void>> job(Core::proxy_cast<Core::IDispatchType<void>>(sequencer));
 
                 if (sequencer->Abort() != Core::ERROR_NONE) {
                     response->ErrorCode = Web::STATUS_NO_CONTENT;
                     response->Message = _T("Sequencer was not in a running state");
-                } else if (Core::IWorkerPool::Instance().Revoke(job, 2000) == Core::ERROR_NONE) {
+                } else if (sequencer->Wait(2000) == Core::ERROR_NONE) {
                     response->ErrorCode = Web::STATUS_OK;
                     response->Message = _T("Sequencer available for next sequence");
                 } else {
@@ -225,7 +223,6 @@ namespace Plugin {
             } else {
                 // Current name, is the name of the sequencer
                 Core::ProxyType<Sequencer> sequencer(_sequencers[index.Current().Text()]);
-                Core::ProxyType<Core::IDispatchType<void>> job(Core::proxy_cast<Core::IDispatchType<void>>(sequencer));
 
                 if (sequencer->IsActive() == true) {
                     response->ErrorCode = Web::STATUS_TEMPORARY_REDIRECT;
@@ -234,8 +231,6 @@ namespace Plugin {
                     sequencer->Load(*(request.Body<Web::JSONBodyType<Core::JSON::ArrayType<Commander::Command>>>()));
                     sequencer->Execute();
 
-                    Core::IWorkerPool::Instance().Submit(job);
-
                     // Attach to response.
                     response->Message = _T("Sequence List Imported");
                     response->ErrorCode = Web::STATUS_OK;
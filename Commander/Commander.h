@@ -41,20 +41,28 @@ namespace Plugin {
                 , Item()
                 , Label()
                 , Parameters(false)
+                , After()
+                , Timeout(0)
             {
                 Add(_T("command"), &Item);
                 Add(_T("label"), &Label);
                 Add(_T("parameters"), &Parameters);
+                Add(_T("after"), &After);
+                Add(_T("timeout"), &Timeout);
             }
             Command(const Command& copy)
                 : Core::JSON::Container()
                 , Item(copy.Item)
                 , Label(copy.Label)
                 , Parameters(copy.Parameters)
+                , After(copy.After)
+                , Timeout(copy.Timeout)
             {
                 Add(_T("command"), &Item);
                 Add(_T("label"), &Label);
                 Add(_T("parameters"), &Parameters);
+                Add(_T("after"), &After);
+                Add(_T("timeout"), &Timeout);
             }
             ~Command()
             {
@@ -65,6 +73,8 @@ namespace Plugin {
                 Item = RHS.Item;
                 Label = RHS.Label;
                 Parameters = RHS.Parameters;
+                After = RHS.After;
+                Timeout = RHS.Timeout;
 
                 return (*this);
             }
@@ -73,6 +83,8 @@ namespace Plugin {
             Core::JSON::String Item;
             Core::JSON::String Label;
             Core::JSON::String Parameters;
+            Core::JSON::ArrayType<Core::JSON::String> After; // Labels of the steps to complete first
+            Core::JSON::DecUInt32 Timeout; // In ms, 0 means no timeout
         };
 
         class Data : public Core::JSON::Container {
@@ -146,8 +158,11 @@ namespace Plugin {
         public:
             Config()
                 : Core::JSON::Container()
+                , Sequencers()
+                , Parallel(4)
             {
                 Add(_T("sequencers"), &Sequencers);
+                Add(_T("parallel"), &Parallel);
             }
             ~Config()
             {
@@ -155,6 +170,7 @@ namespace Plugin {
 
         public:
             Core::JSON::ArrayType<Core::JSON::String> Sequencers;
+            Core::JSON::DecUInt8 Parallel;
         };
         class Administrator {
         private:
@@ -237,21 +253,87 @@ namespace Plugin {
             Core::CriticalSection _adminLock;
             std::map<const string, Exchange::ICommand::IFactory*> _factory;
         };
-        class Sequencer : public Core::IDispatchType<void> {
+        // A sequence is either a list of steps executed one after the other, where the label
+        // returned by a step selects the next step, or, as soon as one of the steps has an
+        // "after" list, a graph in which every step starts as soon as all steps carrying one
+        // of the labels in its "after" list completed. Independent steps then run concurrently,
+        // on at most "parallel" lanes (threads) of the sequencer.
+        class Sequencer {
+        private:
+            enum class status : uint8_t {
+                WAITING,
+                RUNNING,
+                DONE
+            };
+
+            struct Step {
+                Core::ProxyType<Exchange::ICommand> Command;
+                std::vector<uint32_t> Dependents;
+                uint32_t Pending;
+                uint32_t Timeout;
+                uint64_t Deadline;
+                status State;
+            };
+
+            class Lane : public Core::Thread {
+            public:
+                Lane() = delete;
+                Lane(const Lane&) = delete;
+                Lane& operator=(const Lane&) = delete;
+
+                Lane(Sequencer& parent)
+                    : Core::Thread(Core::Thread::DefaultStackSize(), _T("CommanderLane"))
+                    , _parent(parent)
+                {
+                }
+                ~Lane() override
+                {
+                }
+
+            private:
+                uint32_t Worker() override
+                {
+                    if (IsRunning() == true) {
+                        _parent.Process();
+                    }
+                    return (0);
+                }
+
+            private:
+                Sequencer& _parent;
+            };
+
+            using Labels = std::map<string, std::vector<uint32_t>>;
+            using Watchdog = Core::WorkerPool::JobType<Sequencer&>;
+
+            // Running steps are checked for their timeout at least this often (in ms).
+            enum { WATCHDOG_SLICE = 500 };
+
         private:
             Sequencer() = delete;
             Sequencer(const Sequencer& copy) = delete;
             Sequencer& operator=(const Sequencer&) = delete;
 
         public:
-            Sequencer(const string& name, Administrator* commandFactory, PluginHost::IShell* service)
+            Sequencer(const string& name, Administrator* commandFactory, PluginHost::IShell* service, const uint8_t parallel)
                 : _commandFactory(commandFactory)
                 , _adminLock()
                 , _currentIndex(0)
                 , _state(Commander::IDLE)
                 , _name(name)
                 , _service(service)
-                , _sequenceList(5)
+                , _steps()
+                , _labels()
+                , _ready()
+                , _graph(false)
+                , _running(0)
+                , _parallel(parallel == 0 ? 1 : parallel)
+                , _lanes()
+                , _progress(false, true)
+                , _idle(true, true)
+                , _watchdog(*this)
+                , _armed(false)
+                , _stopping(false)
             {
                 ASSERT(service != nullptr);
 
@@ -263,6 +345,25 @@ namespace Plugin {
             {
                 // Make sure we are not executing anything if we get destructed.
                 Abort();
+                Wait(Core::infinite);
+
+                _watchdog.Revoke();
+
+                for (Lane* lane : _lanes) {
+                    lane->Stop();
+                }
+
+                // A lane that is about to wait for progress checks this flag first, so it
+                // can not miss the wake-up below.
+                _adminLock.Lock();
+                _stopping = true;
+                _progress.SetEvent();
+                _adminLock.Unlock();
+
+                for (Lane* lane : _lanes) {
+                    lane->Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+                    delete lane;
+                }
 
                 if (_service != nullptr) {
                     _service->Release();
@@ -282,6 +383,7 @@ namespace Plugin {
             {
                 return (_state);
             }
+            // In a graph, this is the step that was started last.
             inline uint32_t Index() const
             {
 
@@ -305,9 +407,9 @@ namespace Plugin {
 
                 _adminLock.Lock();
 
-                if ((_state != Commander::IDLE) && (_state != Commander::LOADED) && (_currentIndex < _sequenceList.Count())) {
+                if ((_state != Commander::IDLE) && (_state != Commander::LOADED) && (_currentIndex < _steps.size())) {
 
-                    result = _sequenceList[_currentIndex]->Label();
+                    result = _steps[_currentIndex].Command->Label();
                 }
 
                 _adminLock.Unlock();
@@ -326,9 +428,9 @@ namespace Plugin {
 
                     ASSERT(_commandFactory != nullptr);
 
-                    if (_sequenceList.Count() > 0) {
-                        _sequenceList.Clear(0, _sequenceList.Count());
-                    }
+                    std::vector<std::vector<string>> after;
+
+                    Clear();
 
                     Core::JSON::ArrayType<Command>::ConstIterator index(commandList.Elements());
 
@@ -341,19 +443,36 @@ namespace Plugin {
                         Core::ProxyType<Exchange::ICommand> newCommand(_commandFactory->Create(label, className, parameters));
 
                         if (newCommand.IsValid() == true) {
-                            _sequenceList.Add(newCommand);
+                            if (label.empty() == false) {
+                                _labels[label].push_back(static_cast<uint32_t>(_steps.size()));
+                            }
+
+                            _steps.push_back({ newCommand, std::vector<uint32_t>(), 0, index.Current().Timeout.Value(), 0, status::WAITING });
+                            after.emplace_back();
+
+                            Core::JSON::ArrayType<Core::JSON::String>::ConstIterator dependency(index.Current().After.Elements());
+
+                            while (dependency.Next() == true) {
+                                after.back().push_back(dependency.Current().Value());
+                            }
+
+                            _graph = _graph || index.Current().After.IsSet();
                         }
                     }
 
-                    if (_sequenceList.Count() > 0) {
-                        _state = Commander::LOADED;
-                        _currentIndex = 0;
+                    if ((_graph == true) && (Link(after) == false)) {
+                        Clear();
                     }
+
+                    _state = (_steps.size() > 0 ? Commander::LOADED : Commander::IDLE);
+                    _currentIndex = 0;
                 }
 
+                const uint32_t result = static_cast<uint32_t>(_steps.size());
+
                 _adminLock.Unlock();
 
-                return (_sequenceList.Count());
+                return (result);
             }
             uint32_t Execute()
             {
@@ -365,6 +484,27 @@ namespace Plugin {
                 if (_state == Commander::LOADED) {
                     result = Core::ERROR_NONE;
                     _state = Commander::RUNNING;
+                    _idle.ResetEvent();
+
+                    uint32_t lanes = 1;
+
+                    if (_graph == true) {
+                        for (uint32_t index = 0; index < _steps.size(); index++) {
+                            if (_steps[index].Pending == 0) {
+                                _ready.push_back(index);
+                            }
+                        }
+                        lanes = std::min(static_cast<uint32_t>(_parallel), static_cast<uint32_t>(_steps.size()));
+                    }
+
+                    // Lanes are kept for the next sequences, so only add what is missing.
+                    while (_lanes.size() < lanes) {
+                        Lane* lane = new Lane(*this);
+                        _lanes.push_back(lane);
+                        lane->Run();
+                    }
+
+                    _progress.SetEvent();
                 }
 
                 _adminLock.Unlock();
@@ -380,7 +520,16 @@ namespace Plugin {
                 if (_state == Commander::RUNNING) {
                     result = Core::ERROR_NONE;
                     _state = Commander::ABORTING;
-                    _sequenceList[_currentIndex]->Abort();
+
+                    for (Step& step : _steps) {
+                        if (step.State == status::RUNNING) {
+                            step.Command->Abort();
+                        }
+                    }
+
+                    if (_running == 0) {
+                        Finished();
+                    }
                 }
 
                 _adminLock.Unlock();
@@ -388,16 +537,63 @@ namespace Plugin {
                 // Wait for the sequencer to reaach a safe positon..
                 return (result);
             }
+            // Wait till the sequence is completed or aborted.
+            uint32_t Wait(const uint32_t waitTime) const
+            {
+                return (_idle.Lock(waitTime));
+            }
 
         private:
-            virtual void Dispatch()
+            friend class Core::ThreadPool::JobType<Sequencer&>;
+
+            // Runs on the watchdog job, aborts all steps that ran out of time.
+            void Dispatch()
             {
                 _adminLock.Lock();
 
-                // See if we still need to take some "next steps"
-                while ((_currentIndex < _sequenceList.Count()) && (_state == Commander::RUNNING)) {
+                const uint64_t now = Core::Time::Now().Ticks();
+                uint64_t next = static_cast<uint64_t>(~0);
+
+                _armed = false;
+
+                for (Step& step : _steps) {
+                    if ((step.State == status::RUNNING) && (step.Deadline != 0)) {
+                        if (step.Deadline <= now) {
+                            SYSLOG(Logging::Notification, (_T("Sequencer %s: step %s timed out after %d ms"), _name.c_str(), step.Command->Label().c_str(), step.Timeout));
+                            step.Deadline = 0;
+                            step.Command->Abort();
+                        } else {
+                            next = std::min(next, step.Deadline);
+                        }
+                    }
+                }
+
+                if (next != static_cast<uint64_t>(~0)) {
+                    Arm(next);
+                }
+
+                _adminLock.Unlock();
+            }
+            // Executes one step, or waits till there is a step to execute.
+            void Process()
+            {
+                _adminLock.Lock();
+
+                const uint32_t index = Next();
+
+                if (index == static_cast<uint32_t>(~0)) {
+                    if (_stopping == true) {
+                        _adminLock.Unlock();
+                    } else {
+                        _progress.ResetEvent();
+                        _adminLock.Unlock();
+
+                        _progress.Lock(Core::infinite);
+                    }
+                } else {
+                    Core::ProxyType<Exchange::ICommand> step(_steps[index].Command);
 
-                    Core::ProxyType<Exchange::ICommand> step(_sequenceList[_currentIndex]);
+                    _running++;
 
                     _adminLock.Unlock();
 
@@ -405,44 +601,170 @@ namespace Plugin {
 
                     _adminLock.Lock();
 
-                    if (result.empty() == true) {
-                        _currentIndex++;
-                    } else {
-                        uint32_t index = _currentIndex + 1;
+                    _running--;
+
+                    Completed(index, result);
+
+                    _progress.SetEvent();
+
+                    _adminLock.Unlock();
+                }
+            }
+            // Expects the _adminLock to be taken.
+            uint32_t Next()
+            {
+                uint32_t result = static_cast<uint32_t>(~0);
 
-                        // See if we have a forward label, as mentioned from the execute
-                        while ((index < _sequenceList.Count()) && (_sequenceList[index]->Label() != result)) {
-                            index++;
+                if (_state == Commander::RUNNING) {
+                    if (_graph == false) {
+                        if ((_running == 0) && (_currentIndex < _steps.size())) {
+                            result = _currentIndex;
                         }
+                    } else if (_ready.empty() == false) {
+                        result = _ready.front();
+                        _ready.pop_front();
+                    }
+                }
 
-                        if (index < _sequenceList.Count()) {
-                            // Seems like we found a next step, set it..
-                            _currentIndex = index;
-                        } else {
-                            // There are no steps before our current step, so no label found, just progress...
-                            _currentIndex++;
+                if (result != static_cast<uint32_t>(~0)) {
+                    Step& step(_steps[result]);
+
+                    step.State = status::RUNNING;
+                    _currentIndex = result;
+
+                    if (step.Timeout != 0) {
+                        step.Deadline = Core::Time::Now().Add(step.Timeout).Ticks();
+                        Arm(step.Deadline);
+                    }
+                }
+
+                return (result);
+            }
+            // Expects the _adminLock to be taken.
+            void Completed(const uint32_t index, const string& label)
+            {
+                Step& step(_steps[index]);
 
-                            // But let's check if there is a step before us (or we are ourselves :-), we might need to jump to..
-                            index = _currentIndex;
+                step.State = status::DONE;
+                step.Deadline = 0;
 
-                            // Check if we have a step with the given label prior to our current step..
-                            while ((index > 0) && (_sequenceList[index - 1]->Label() != result)) {
-                                index--;
+                if (_state == Commander::RUNNING) {
+                    if (_graph == false) {
+                        _currentIndex = Jump(index, label);
+                    } else {
+                        for (const uint32_t dependent : step.Dependents) {
+                            if (--(_steps[dependent].Pending) == 0) {
+                                _ready.push_back(dependent);
                             }
+                        }
+                    }
+                }
+
+                if ((_running == 0) && ((_state == Commander::ABORTING) || (_graph == true ? _ready.empty() : (_currentIndex >= _steps.size())))) {
+                    Finished();
+                }
+            }
+            // The step after the given one: the first step with the given label after it,
+            // otherwise the closest one with that label before it, otherwise just the next.
+            uint32_t Jump(const uint32_t index, const string& label) const
+            {
+                uint32_t result = index + 1;
+
+                if (label.empty() == false) {
+                    Labels::const_iterator entry(_labels.find(label));
+
+                    if (entry != _labels.end()) {
+                        std::vector<uint32_t>::const_iterator position(std::upper_bound(entry->second.begin(), entry->second.end(), index));
 
-                            if (index > 0) {
-                                _currentIndex = (index - 1);
+                        if (position != entry->second.end()) {
+                            result = *position;
+                        } else {
+                            result = entry->second.back();
+                        }
+                    }
+                }
+
+                return (result);
+            }
+            // Resolve the "after" labels into dependencies, reject unknown labels and cycles.
+            bool Link(const std::vector<std::vector<string>>& after)
+            {
+                bool result = true;
+
+                for (uint32_t index = 0; (index < _steps.size()) && (result == true); index++) {
+                    for (const string& label : after[index]) {
+                        Labels::const_iterator entry(_labels.find(label));
+
+                        if (entry == _labels.end()) {
+                            SYSLOG(Logging::ParsingError, (_T("Sequencer %s: unknown label %s in the after list"), _name.c_str(), label.c_str()));
+                            result = false;
+                            break;
+                        }
+                        for (const uint32_t dependency : entry->second) {
+                            _steps[dependency].Dependents.push_back(index);
+                            _steps[index].Pending++;
+                        }
+                    }
+                }
+
+                if (result == true) {
+                    // Every step must be reachable, otherwise there is a cycle.
+                    std::vector<uint32_t> pending;
+                    std::list<uint32_t> ready;
+                    uint32_t reached = 0;
+
+                    for (uint32_t index = 0; index < _steps.size(); index++) {
+                        pending.push_back(_steps[index].Pending);
+                        if (pending.back() == 0) {
+                            ready.push_back(index);
+                        }
+                    }
+                    while (ready.empty() == false) {
+                        for (const uint32_t dependent : _steps[ready.front()].Dependents) {
+                            if (--pending[dependent] == 0) {
+                                ready.push_back(dependent);
                             }
                         }
+                        ready.pop_front();
+                        reached++;
+                    }
+
+                    if (reached != _steps.size()) {
+                        SYSLOG(Logging::ParsingError, (_T("Sequencer %s: the after lists contain a cycle"), _name.c_str()));
+                        result = false;
                     }
                 }
 
+                return (result);
+            }
+            // Expects the _adminLock to be taken.
+            void Arm(const uint64_t deadline)
+            {
+                if (_armed == false) {
+                    const uint64_t limit = Core::Time::Now().Add(WATCHDOG_SLICE).Ticks();
+
+                    _armed = true;
+                    _watchdog.Schedule(Core::Time(std::min(deadline, limit)));
+                }
+            }
+            // Expects the _adminLock to be taken.
+            void Finished()
+            {
                 ASSERT((_state == Commander::RUNNING) || (_state == Commander::ABORTING));
-                _state = IDLE;
 
-                _sequenceList.Clear(0, _sequenceList.Count());
+                _state = Commander::IDLE;
 
-                _adminLock.Unlock();
+                Clear();
+
+                _idle.SetEvent();
+            }
+            // Expects the _adminLock to be taken.
+            void Clear()
+            {
+                _steps.clear();
+                _labels.clear();
+                _ready.clear();
+                _graph = false;
             }
 
         private:
@@ -452,7 +774,18 @@ namespace Plugin {
             state _state;
             string _name;
             PluginHost::IShell* _service;
-            Core::ProxyList<Exchange::ICommand> _sequenceList;
+            std::vector<Step> _steps;
+            Labels _labels;
+            std::list<uint32_t> _ready;
+            bool _graph;
+            uint32_t _running;
+            const uint8_t _parallel;
+            std::list<Lane*> _lanes;
+            Core::Event _progress;
+            mutable Core::Event _idle;
+            Watchdog _watchdog;
+            bool _armed;
+            bool _stopping;
         };
 
         Commander(const Commander&) = delete;
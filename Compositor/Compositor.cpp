@@ -44,9 +44,13 @@ namespace Plugin {
     static void SetZOrderList (std::list<client_info>& list, uint16_t index = 0) {
 
         // Time to set the new ZOrder. All effected clients have been listed...
+        // Every call makes the backend recompose, so skip the ones already in place.
         std::list<client_info>::iterator loop(list.begin());
         while (loop != list.end()) {
-            loop->access->ZOrder(index);
+            if (loop->layer != index) {
+                loop->access->ZOrder(index);
+                loop->layer = index;
+            }
             index++;
             loop++;
         }
@@ -140,6 +144,9 @@ namespace Plugin {
     static Core::ProxyPoolType<Web::Response> responseFactory(2);
     static Core::ProxyPoolType<Web::JSONBodyType<Compositor::Data>> jsonResponseFactory(2);
 
+#ifdef __WINDOWS__
+#pragma warning(disable : 4355)
+#endif
     Compositor::Compositor()
         : _adminLock()
         , _skipURL()
@@ -149,11 +156,15 @@ namespace Plugin {
         , _connectionId()
         , _inputSwitch(nullptr)
         , _inputSwitchCallsign()
-
+        , _transaction(*this)
     {
         RegisterAll();
     }
 
+#ifdef __WINDOWS__
+#pragma warning(default : 4355)
+#endif
+
     Compositor::~Compositor()
     {
         UnregisterAll();
@@ -214,6 +225,8 @@ namespace Plugin {
             subSystems->Release();
         }
 
+        Abort();
+
         if (_inputSwitch != nullptr) {
             _inputSwitch->Release();
             _inputSwitch = nullptr;
@@ -296,7 +309,14 @@ namespace Plugin {
             Core::ProxyType<Web::JSONBodyType<Data>> response(jsonResponseFactory.Element());
 
             if (index.Next() == true) {
-                if (index.Current() == _T("Resolution")) { /* http://<ip>/Service/Compositor/Resolution/3 --> 720p*/
+                if ((index.Current() == _T("Begin")) || (index.Current() == _T("Commit")) || (index.Current() == _T("Abort"))) { /* http://<ip>/Service/Compositor/Begin */
+                    uint32_t error = (index.Current() == _T("Begin") ? Begin() : (index.Current() == _T("Commit") ? Commit() : Abort()));
+
+                    if (error != Core::ERROR_NONE) {
+                        result->ErrorCode = Web::STATUS_PRECONDITION_FAILED;
+                        result->Message = (error == Core::ERROR_INPROGRESS ? _T("Transaction already in progress") : _T("No transaction in progress"));
+                    }
+                } else if (index.Current() == _T("Resolution")) { /* http://<ip>/Service/Compositor/Resolution/3 --> 720p*/
                     if (index.Next() == true) {
                         Exchange::IComposition::ScreenResolution format(Exchange::IComposition::ScreenResolution_Unknown);
                         uint32_t number(Core::NumberType<uint32_t>(index.Current()).Value());
@@ -505,6 +525,17 @@ namespace Plugin {
 
         _adminLock.Lock();
 
+        if (_transaction.IsOpen() == true) {
+            if (Exists(callsign) == true) {
+                _transaction.Opacity(callsign, value);
+                result = Core::ERROR_NONE;
+            }
+
+            _adminLock.Unlock();
+
+            return (result);
+        }
+
         Clients::iterator it = _clients.begin();
 
         while (it != _clients.end()) {
@@ -539,6 +570,17 @@ namespace Plugin {
 
         _adminLock.Lock();
 
+        if (_transaction.IsOpen() == true) {
+            if (Exists(callsign) == true) {
+                _transaction.Geometry(callsign, rectangle);
+                result = Core::ERROR_NONE;
+            }
+
+            _adminLock.Unlock();
+
+            return (result);
+        }
+
         Clients::iterator it = _clients.begin();
 
         while (it != _clients.end()) {
@@ -602,6 +644,16 @@ namespace Plugin {
 
         _adminLock.Lock();
 
+        if (_transaction.IsOpen() == true) {
+            if (_transaction.PutBefore(relative, callsign) == false) {
+                result = Core::ERROR_FIRST_RESOURCE_NOT_FOUND;
+            }
+
+            _adminLock.Unlock();
+
+            return (result);
+        }
+
         GetZOrderList(_clients, list);
 
         // Find the index of what we need to move
@@ -655,6 +707,177 @@ namespace Plugin {
         return PutBefore(EMPTY_STRING, callsign);
     }
 
+    uint32_t Compositor::Begin()
+    {
+        uint32_t result = Core::ERROR_INPROGRESS;
+
+        _adminLock.Lock();
+
+        if (_transaction.IsOpen() == false) {
+            std::list<client_info> list;
+            std::list<string> order;
+
+            GetZOrderList(_clients, list);
+
+            for (const client_info& entry : list) {
+                order.push_back(entry.name);
+            }
+
+            _transaction.Open(std::move(order));
+            result = Core::ERROR_NONE;
+
+            TRACE(Trace::Information, (_T("Transaction started")));
+        }
+
+        _adminLock.Unlock();
+
+        return (result);
+    }
+
+    uint32_t Compositor::Commit()
+    {
+        uint32_t result = Core::ERROR_ILLEGAL_STATE;
+
+        _transaction.Revoke();
+
+        _adminLock.Lock();
+
+        if (_transaction.IsOpen() == true) {
+            Apply();
+            result = Core::ERROR_NONE;
+        }
+
+        _adminLock.Unlock();
+
+        return (result);
+    }
+
+    uint32_t Compositor::Abort()
+    {
+        uint32_t result = Core::ERROR_ILLEGAL_STATE;
+
+        _transaction.Revoke();
+
+        _adminLock.Lock();
+
+        if (_transaction.IsOpen() == true) {
+            _transaction.Close();
+            result = Core::ERROR_NONE;
+
+            TRACE(Trace::Information, (_T("Transaction aborted")));
+        }
+
+        _adminLock.Unlock();
+
+        return (result);
+    }
+
+    // Must be called with the _adminLock taken.
+    void Compositor::Apply()
+    {
+        std::list<client_info> list;
+        std::list<client_info> ordered;
+
+        GetZOrderList(_clients, list);
+
+        // Put the clients in the order the transaction ended up with. Clients that were
+        // attached while the transaction was open, stay on top (as Attached put them).
+        for (const string& name : _transaction.Order()) {
+            std::list<client_info>::iterator entry(list.begin());
+
+            while ((entry != list.end()) && (entry->name != name)) {
+                entry++;
+            }
+            if (entry != list.end()) {
+                ordered.splice(ordered.end(), list, entry);
+            }
+        }
+
+        ordered.splice(ordered.begin(), list);
+
+        SetZOrderList(ordered, 0);
+
+        for (const std::pair<const string, Transaction::Change>& change : _transaction.Pending()) {
+            Clients::iterator it = _clients.begin();
+
+            while (it != _clients.end()) {
+                if (change.first == PrimaryName(it->first)) {
+                    if (change.second.HasGeometry == true) {
+                        it->second->Geometry(change.second.Geometry);
+                    }
+                    if (change.second.HasOpacity == true) {
+                        it->second->Opacity(change.second.Opacity);
+                    }
+                }
+                it++;
+            }
+        }
+
+        TRACE(Trace::Information, (_T("Transaction committed, %d client(s) changed"), static_cast<uint32_t>(_transaction.Pending().size())));
+
+        _transaction.Close();
+    }
+
+    bool Compositor::Exists(const string& callsign) const
+    {
+        Clients::const_iterator it = _clients.cbegin();
+
+        while ((it != _clients.cend()) && (callsign != PrimaryName(it->first))) {
+            it++;
+        }
+
+        return (it != _clients.cend());
+    }
+
+    bool Compositor::Transaction::PutBefore(const string& relative, const string& callsign)
+    {
+        bool result = false;
+
+        if (relative != callsign) {
+            std::list<string>::iterator target(_order.begin());
+
+            if (relative.empty() == false) {
+                while ((target != _order.end()) && (PrimaryName(*target) != relative)) {
+                    target++;
+                }
+            }
+
+            if ((relative.empty() == true) || (target != _order.end())) {
+                std::list<string> moving;
+                std::list<string>::iterator index(_order.begin());
+
+                // Take out all surfaces of the callsign, keep their relative order.
+                while (index != _order.end()) {
+                    std::list<string>::iterator entry(index++);
+
+                    if (PrimaryName(*entry) == callsign) {
+                        moving.splice(moving.end(), _order, entry);
+                    }
+                }
+
+                if (moving.empty() == false) {
+                    _order.splice((relative.empty() == true ? _order.begin() : target), moving);
+                    result = true;
+                }
+            }
+        }
+
+        return (result);
+    }
+
+    void Compositor::Transaction::Dispatch()
+    {
+        TRACE(Trace::Information, (_T("Transaction not committed in time, committing it now")));
+
+        _parent._adminLock.Lock();
+
+        if (_open == true) {
+            _parent.Apply();
+        }
+
+        _parent._adminLock.Unlock();
+    }
+
     Exchange::IComposition::IClient* Compositor::InterfaceByCallsign(const string& callsign) const
     {
         Exchange::IComposition::IClient* client = nullptr;
@@ -99,6 +99,105 @@ namespace Plugin {
             PluginHost::IShell* _service;
         };
 
+        // Collects geometry, opacity and z-order changes, so they can be handed to the clients
+        // in one go. Transactions left open are committed automatically after TimeOut.
+        class Transaction {
+        private:
+            Transaction() = delete;
+            Transaction(const Transaction&) = delete;
+            Transaction& operator=(const Transaction&) = delete;
+
+            using Job = Core::WorkerPool::JobType<Transaction&>;
+
+        public:
+            static constexpr uint32_t TimeOut = 2000; // ms
+
+            struct Change {
+                Change()
+                    : HasGeometry(false)
+                    , Geometry()
+                    , HasOpacity(false)
+                    , Opacity(0)
+                {
+                }
+
+                bool HasGeometry;
+                Exchange::IComposition::Rectangle Geometry;
+                bool HasOpacity;
+                uint32_t Opacity;
+            };
+
+            using Changes = std::map<string, Change>;
+
+        public:
+            Transaction(Compositor& parent)
+                : _parent(parent)
+                , _job(*this)
+                , _open(false)
+                , _order()
+                , _changes()
+            {
+            }
+            ~Transaction()
+            {
+                _job.Revoke();
+            }
+
+        public:
+            inline bool IsOpen() const
+            {
+                return (_open);
+            }
+            void Open(std::list<string>&& order)
+            {
+                ASSERT(_open == false);
+
+                _open = true;
+                _order = std::move(order);
+                _job.Schedule(Core::Time::Now().Add(TimeOut));
+            }
+            void Close()
+            {
+                _open = false;
+                _order.clear();
+                _changes.clear();
+            }
+            void Revoke()
+            {
+                _job.Revoke();
+            }
+            inline const std::list<string>& Order() const
+            {
+                return (_order);
+            }
+            inline const Changes& Pending() const
+            {
+                return (_changes);
+            }
+            void Geometry(const string& callsign, const Exchange::IComposition::Rectangle& rectangle)
+            {
+                Change& entry(_changes[callsign]);
+                entry.HasGeometry = true;
+                entry.Geometry = rectangle;
+            }
+            void Opacity(const string& callsign, const uint32_t value)
+            {
+                Change& entry(_changes[callsign]);
+                entry.HasOpacity = true;
+                entry.Opacity = value;
+            }
+            bool PutBefore(const string& relative, const string& callsign);
+
+            void Dispatch();
+
+        private:
+            Compositor& _parent;
+            Job _job;
+            bool _open;
+            std::list<string> _order;
+            Changes _changes;
+        };
+
     public:
         typedef std::map<string, Exchange::IComposition::IClient*> Clients;
 
@@ -201,6 +300,11 @@ namespace Plugin {
         uint32_t ToTop(const string& callsign);
         uint32_t Select(const string& callsign);
         uint32_t PutBefore(const string& relative, const string& callsign);
+        uint32_t Begin();
+        uint32_t Commit();
+        uint32_t Abort();
+        void Apply();
+        bool Exists(const string& callsign) const;
 
         void ZOrder(std::list<string>& zOrderedList, const bool primary) const;
         Exchange::IComposition::IClient* InterfaceByCallsign(const string& callsign) const;
@@ -223,6 +327,9 @@ namespace Plugin {
         uint32_t endpoint_putontop(const JsonData::Compositor::PutontopParamsInfo& params);
         uint32_t endpoint_select(const JsonData::Compositor::PutontopParamsInfo& params);
         uint32_t endpoint_putbelow(const JsonData::Compositor::PutbelowParamsData& params);
+        uint32_t endpoint_begin();
+        uint32_t endpoint_commit();
+        uint32_t endpoint_abort();
         uint32_t get_resolution(Core::JSON::EnumType<JsonData::Compositor::ResolutionType>& response) const;
         uint32_t set_resolution(const Core::JSON::EnumType<JsonData::Compositor::ResolutionType>& param);
         uint32_t get_zorder(Core::JSON::ArrayType<Core::JSON::String>& response) const;
@@ -241,6 +348,7 @@ namespace Plugin {
         Clients _clients;
         Exchange::IInputSwitch* _inputSwitch;
         string _inputSwitchCallsign;
+        Transaction _transaction;
     };
 }
 }
@@ -35,6 +35,9 @@ namespace Plugin {
         Register<PutontopParamsInfo,void>(_T("putontop"), &Compositor::endpoint_putontop, this);
         Register<PutontopParamsInfo,void>(_T("select"), &Compositor::endpoint_select, this);
         Register<PutbelowParamsData,void>(_T("putbelow"), &Compositor::endpoint_putbelow, this);
+        Register<void,void>(_T("begin"), &Compositor::endpoint_begin, this);
+        Register<void,void>(_T("commit"), &Compositor::endpoint_commit, this);
+        Register<void,void>(_T("abort"), &Compositor::endpoint_abort, this);
         Property<Core::JSON::EnumType<ResolutionType>>(_T("resolution"), &Compositor::get_resolution, &Compositor::set_resolution, this);
         Property<Core::JSON::ArrayType<Core::JSON::String>>(_T("zorder"), &Compositor::get_zorder, nullptr, this);
         Property<GeometryData>(_T("geometry"), &Compositor::get_geometry, &Compositor::set_geometry, this);
@@ -55,6 +58,9 @@ namespace Plugin {
         Unregister(_T("geometry"));
         Unregister(_T("zorder"));
         Unregister(_T("resolution"));
+        Unregister(_T("abort"));
+        Unregister(_T("commit"));
+        Unregister(_T("begin"));
         Unregister(_T("putbelow"));
         Unregister(_T("select"));
         Unregister(_T("putontop"));
@@ -98,6 +104,33 @@ namespace Plugin {
         return PutBefore(relative, client);
     }
 
+    // Method: begin - Starts collecting geometry, opacity, visibility and z-order changes
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_INPROGRESS: A transaction is already in progress
+    uint32_t Compositor::endpoint_begin()
+    {
+        return Begin();
+    }
+
+    // Method: commit - Applies all changes collected since begin in one go
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_ILLEGAL_STATE: No transaction in progress
+    uint32_t Compositor::endpoint_commit()
+    {
+        return Commit();
+    }
+
+    // Method: abort - Drops all changes collected since begin
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_ILLEGAL_STATE: No transaction in progress
+    uint32_t Compositor::endpoint_abort()
+    {
+        return Abort();
+    }
+
     // Property: resolution - Screen resolution
     // Return codes:
     //  - ERROR_NONE: Success
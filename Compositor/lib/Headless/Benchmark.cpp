@@ -0,0 +1,312 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Drives the headless composition with a large number of clients that keep
+// changing geometry and z-order, and reports the latency of the control path
+// and the cost of the resulting frames. Clients are offered to the composition
+// and controlled through the IClient interfaces it attaches, just like the
+// Compositor plugin does. No display or GPU is needed, so this can run on any
+// CI machine:
+//
+//   CompositorBenchmark [clients] [rounds]
+
+#include "Module.h"
+#include "Composition.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+namespace WPEFramework {
+
+class Measurement {
+public:
+    Measurement(const Measurement&) = delete;
+    Measurement& operator=(const Measurement&) = delete;
+
+    Measurement()
+        : _count(0)
+        , _total(0)
+        , _max(0)
+    {
+    }
+
+public:
+    inline void Add(const uint64_t value)
+    {
+        _count++;
+        _total += value;
+        _max = std::max(_max, value);
+    }
+    void Print(const TCHAR label[]) const
+    {
+        printf("%-24s count=%-8u avg=%-10.2f max=%llu\n", label, _count,
+            (_count != 0 ? static_cast<double>(_total) / _count : 0.0), static_cast<unsigned long long>(_max));
+    }
+
+private:
+    uint32_t _count;
+    uint64_t _total;
+    uint64_t _max;
+};
+
+// Tiny deterministic generator, so runs are comparable between machines.
+class Random {
+public:
+    Random(const Random&) = delete;
+    Random& operator=(const Random&) = delete;
+
+    explicit Random(const uint32_t seed)
+        : _state(seed)
+    {
+    }
+
+public:
+    uint32_t Next(const uint32_t range)
+    {
+        _state = (_state * 1664525) + 1013904223;
+        return ((_state >> 8) % range);
+    }
+
+private:
+    uint32_t _state;
+};
+
+// The composition without the RPC server and the frame clock, frames are
+// composed on demand by the benchmark.
+class Composition : public Headless::Composition {
+public:
+    Composition(const Composition&) = delete;
+    Composition& operator=(const Composition&) = delete;
+
+    Composition() = default;
+    ~Composition() override = default;
+
+    BEGIN_INTERFACE_MAP(Composition)
+    INTERFACE_ENTRY(Exchange::IComposition)
+    END_INTERFACE_MAP
+
+public:
+    uint32_t Configure(PluginHost::IShell*) override
+    {
+        return (Core::ERROR_NONE);
+    }
+};
+
+// The client side, as a process would offer it over RPC.
+class Client : public Exchange::IComposition::IClient {
+public:
+    Client() = delete;
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    explicit Client(const string& name)
+        : _name(name)
+    {
+    }
+    ~Client() override = default;
+
+    BEGIN_INTERFACE_MAP(Client)
+    INTERFACE_ENTRY(Exchange::IComposition::IClient)
+    END_INTERFACE_MAP
+
+public:
+    string Name() const override
+    {
+        return (_name);
+    }
+    void Kill() override
+    {
+    }
+    void Opacity(const uint32_t) override
+    {
+    }
+    uint32_t Geometry(const Exchange::IComposition::Rectangle&) override
+    {
+        return (Core::ERROR_NONE);
+    }
+    Exchange::IComposition::Rectangle Geometry() const override
+    {
+        return (Exchange::IComposition::Rectangle());
+    }
+    uint32_t ZOrder(const uint16_t) override
+    {
+        return (Core::ERROR_NONE);
+    }
+    uint32_t ZOrder() const override
+    {
+        return (0);
+    }
+
+private:
+    const string _name;
+};
+
+// The plugin side, collects the clients as the composition attaches them.
+class Observer : public Exchange::IComposition::INotification {
+public:
+    Observer(const Observer&) = delete;
+    Observer& operator=(const Observer&) = delete;
+
+    Observer()
+        : _clients()
+    {
+    }
+    ~Observer() override
+    {
+        ASSERT(_clients.empty() == true);
+    }
+
+    BEGIN_INTERFACE_MAP(Observer)
+    INTERFACE_ENTRY(Exchange::IComposition::INotification)
+    END_INTERFACE_MAP
+
+public:
+    void Attached(const string&, Exchange::IComposition::IClient* client) override
+    {
+        client->AddRef();
+        _clients.push_back(client);
+    }
+    void Detached(const string& name) override
+    {
+        std::vector<Exchange::IComposition::IClient*>::iterator index(_clients.begin());
+        while ((index != _clients.end()) && ((*index)->Name() != name)) {
+            ++index;
+        }
+        if (index != _clients.end()) {
+            (*index)->Release();
+            _clients.erase(index);
+        }
+    }
+    inline std::vector<Exchange::IComposition::IClient*>& Clients()
+    {
+        return (_clients);
+    }
+
+private:
+    std::vector<Exchange::IComposition::IClient*> _clients;
+};
+
+} // namespace WPEFramework
+
+using namespace WPEFramework;
+
+int main(int argc, char* argv[])
+{
+    const uint32_t clients = (argc > 1 ? atoi(argv[1]) : 300);
+    const uint32_t rounds = (argc > 2 ? atoi(argv[2]) : 100);
+
+    if ((clients == 0) || (rounds == 0) || (clients > 0xFFFF)) {
+        fprintf(stderr, "Usage: %s [clients (1-65535)] [rounds]\n", argv[0]);
+        return (1);
+    }
+
+    {
+        Composition* composition = Core::Service<Composition>::Create<Composition>();
+        Exchange::IComposition* control = composition;
+        Core::Sink<Observer> observer;
+        std::vector<uint16_t> order(clients);
+        Random random(0x5EED);
+
+        Measurement geometry;
+        Measurement zorder;
+        Measurement opacity;
+        Measurement frame;
+        Measurement dirty;
+
+        control->Resolution(Exchange::IComposition::ScreenResolution::ScreenResolution_1080p60Hz);
+        control->Register(&observer);
+
+        for (uint32_t index = 0; index < clients; index++) {
+            Exchange::IComposition::IClient* client = Core::Service<Client>::Create<Exchange::IComposition::IClient>(_T("client-") + Core::NumberType<uint32_t>(index).Text());
+            composition->NewClientOffered(client);
+            client->Release();
+            order[index] = static_cast<uint16_t>(index);
+        }
+
+        std::vector<Exchange::IComposition::IClient*>& surfaces(observer.Clients());
+        ASSERT(surfaces.size() == clients);
+
+        const uint32_t width = Exchange::IComposition::WidthFromResolution(control->Resolution());
+        const uint32_t height = Exchange::IComposition::HeightFromResolution(control->Resolution());
+
+        composition->Compose();
+
+        for (uint32_t round = 0; round < rounds; round++) {
+            uint64_t start;
+
+            // Every client moves and resizes.
+            for (Exchange::IComposition::IClient* surface : surfaces) {
+                Exchange::IComposition::Rectangle rectangle;
+                rectangle.width = 64 + random.Next(width / 2);
+                rectangle.height = 64 + random.Next(height / 2);
+                rectangle.x = random.Next(width - rectangle.width);
+                rectangle.y = random.Next(height - rectangle.height);
+
+                start = Core::Time::Now().Ticks();
+                surface->Geometry(rectangle);
+                geometry.Add(Core::Time::Now().Ticks() - start);
+            }
+
+            // Restack everything, as SetZOrderList in the plugin does.
+            for (uint32_t index = clients - 1; index > 0; index--) {
+                std::swap(order[index], order[random.Next(index + 1)]);
+            }
+            start = Core::Time::Now().Ticks();
+            for (uint32_t index = 0; index < clients; index++) {
+                surfaces[order[index]]->ZOrder(static_cast<uint16_t>(index));
+            }
+            zorder.Add(Core::Time::Now().Ticks() - start);
+
+            // A few clients fade.
+            for (uint32_t count = 0; count < (clients / 10) + 1; count++) {
+                start = Core::Time::Now().Ticks();
+                surfaces[random.Next(clients)]->Opacity(random.Next(Exchange::IComposition::maxOpacity + 1));
+                opacity.Add(Core::Time::Now().Ticks() - start);
+            }
+
+            // Only frames that were actually composed count, a skipped one has no cost.
+            if (composition->Compose() == true) {
+                const Headless::Canvas::Statistics stats(composition->Report());
+                frame.Add(stats.LastFrameTime);
+                dirty.Add(stats.LastDirty);
+            }
+        }
+
+        printf("Headless composition, %u clients, %u rounds, %ux%u\n", clients, rounds, width, height);
+        geometry.Print(_T("geometry (us/call)"));
+        zorder.Print(_T("zorder (us/restack)"));
+        opacity.Print(_T("opacity (us/call)"));
+        frame.Print(_T("frame (us)"));
+        dirty.Print(_T("dirty (px/frame)"));
+
+        for (Exchange::IComposition::IClient* surface : surfaces) {
+            surface->Release();
+        }
+        surfaces.clear();
+
+        control->Unregister(&observer);
+        composition->Release();
+    }
+
+    Core::Singleton::Dispose();
+
+    return (0);
+}
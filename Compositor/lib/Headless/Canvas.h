@@ -0,0 +1,449 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+#include <interfaces/IComposition.h>
+
+namespace WPEFramework {
+namespace Headless {
+
+    // In-memory composition target. Every client is represented by a solid,
+    // name-coloured surface that is blended onto a 32 bits ARGB framebuffer by
+    // the CPU. Only the area touched by geometry, opacity or z-order changes
+    // since the previous frame is recomposed.
+    class Canvas {
+    private:
+        Canvas() = delete;
+        Canvas(const Canvas&) = delete;
+        Canvas& operator=(const Canvas&) = delete;
+
+        enum : uint32_t {
+            Background = 0xFF000000
+        };
+
+    public:
+        struct Statistics {
+            uint32_t Frames;
+            uint32_t Skipped; // Compose calls that found nothing damaged
+            uint32_t Clients;
+            uint64_t LastFrameTime; // us, 0 if the last call was skipped
+            uint64_t MaxFrameTime; // us
+            uint64_t TotalFrameTime; // us
+            uint64_t LastDirty; // pixels, 0 if the last call was skipped
+            uint64_t TotalDirty; // pixels
+        };
+
+        struct INotification {
+            virtual ~INotification() = default;
+
+            // Called with the canvas lock taken, on the first damage after a
+            // Compose, so keep it short and do not call back into the canvas.
+            virtual void Damaged() = 0;
+        };
+
+        class Surface : public Exchange::IComposition::IClient {
+        private:
+            Surface() = delete;
+            Surface(const Surface&) = delete;
+            Surface& operator=(const Surface&) = delete;
+
+        protected:
+            Surface(Canvas& parent, const string& name, Exchange::IComposition::IClient* remote)
+                : _parent(parent)
+                , _name(name)
+                , _remote(remote)
+                , _rectangle()
+                , _opacity(Exchange::IComposition::maxOpacity)
+                , _layer(0)
+                , _color(Colour(name))
+            {
+                _rectangle.x = 0;
+                _rectangle.y = 0;
+                _rectangle.width = parent.Width();
+                _rectangle.height = parent.Height();
+
+                if (_remote != nullptr) {
+                    _remote->AddRef();
+                }
+            }
+
+        public:
+            static Surface* Create(Canvas& parent, const string& name, Exchange::IComposition::IClient* remote)
+            {
+                return (Core::Service<Surface>::Create<Surface>(parent, name, remote));
+            }
+            virtual ~Surface()
+            {
+                if (_remote != nullptr) {
+                    _remote->Release();
+                }
+            }
+
+        public:
+            inline const Exchange::IComposition::IClient* Remote() const
+            {
+                return (_remote);
+            }
+            string Name() const override
+            {
+                return (_name);
+            }
+            void Kill() override
+            {
+                if (_remote != nullptr) {
+                    _remote->Kill();
+                }
+            }
+            void Opacity(const uint32_t value) override
+            {
+                _parent.Lock();
+                if (_opacity != value) {
+                    _opacity = value;
+                    _parent.Damage(_rectangle);
+                }
+                _parent.Unlock();
+
+                if (_remote != nullptr) {
+                    _remote->Opacity(value);
+                }
+            }
+            uint32_t Geometry(const Exchange::IComposition::Rectangle& rectangle) override
+            {
+                _parent.Lock();
+                _parent.Damage(_rectangle);
+                _rectangle = rectangle;
+                _parent.Damage(_rectangle);
+                _parent.Unlock();
+
+                return (_remote != nullptr ? _remote->Geometry(rectangle) : Core::ERROR_NONE);
+            }
+            Exchange::IComposition::Rectangle Geometry() const override
+            {
+                _parent.Lock();
+                Exchange::IComposition::Rectangle result(_rectangle);
+                _parent.Unlock();
+
+                return (result);
+            }
+            uint32_t ZOrder(const uint16_t index) override
+            {
+                _parent.Lock();
+                if (_layer != index) {
+                    _layer = index;
+                    _parent.Reorder(_rectangle);
+                }
+                _parent.Unlock();
+
+                return (_remote != nullptr ? _remote->ZOrder(index) : Core::ERROR_NONE);
+            }
+            uint32_t ZOrder() const override
+            {
+                return (_layer);
+            }
+
+            BEGIN_INTERFACE_MAP(Surface)
+                INTERFACE_ENTRY(Exchange::IComposition::IClient)
+            END_INTERFACE_MAP
+
+        private:
+            friend class Canvas;
+
+            static uint32_t Colour(const string& name)
+            {
+                // FNV-1a, just to get a stable, distinguishable colour per client.
+                uint32_t hash = 2166136261;
+                for (const char c : name) {
+                    hash = (hash ^ static_cast<uint8_t>(c)) * 16777619;
+                }
+                return (0xFF000000 | (hash & 0x00FFFFFF));
+            }
+
+        private:
+            Canvas& _parent;
+            const string _name;
+            Exchange::IComposition::IClient* _remote;
+            Exchange::IComposition::Rectangle _rectangle;
+            uint32_t _opacity;
+            uint16_t _layer;
+            const uint32_t _color;
+        };
+
+    private:
+        struct Region {
+            int32_t left;
+            int32_t top;
+            int32_t right;
+            int32_t bottom;
+
+            inline bool IsEmpty() const
+            {
+                return ((left >= right) || (top >= bottom));
+            }
+            inline uint64_t Area() const
+            {
+                return (IsEmpty() == true ? 0 : static_cast<uint64_t>(right - left) * static_cast<uint64_t>(bottom - top));
+            }
+        };
+
+    public:
+        Canvas(const uint32_t width, const uint32_t height)
+            : _adminLock()
+            , _width(width)
+            , _height(height)
+            , _frameBuffer(width * height, Background)
+            , _surfaces()
+            , _dirty({ 0, 0, static_cast<int32_t>(width), static_cast<int32_t>(height) })
+            , _reorder(false)
+            , _statistics()
+            , _callback(nullptr)
+        {
+        }
+        ~Canvas()
+        {
+            ASSERT(_surfaces.empty() == true);
+        }
+
+    public:
+        inline uint32_t Width() const
+        {
+            return (_width);
+        }
+        inline uint32_t Height() const
+        {
+            return (_height);
+        }
+        inline void Lock() const
+        {
+            _adminLock.Lock();
+        }
+        inline void Unlock() const
+        {
+            _adminLock.Unlock();
+        }
+        void Callback(INotification* callback)
+        {
+            _adminLock.Lock();
+            ASSERT((_callback == nullptr) || (callback == nullptr));
+            _callback = callback;
+            _adminLock.Unlock();
+        }
+        void Resize(const uint32_t width, const uint32_t height)
+        {
+            _adminLock.Lock();
+            if ((width != _width) || (height != _height)) {
+                const bool clean = _dirty.IsEmpty();
+
+                _width = width;
+                _height = height;
+                _frameBuffer.assign(width * height, Background);
+                _dirty = { 0, 0, static_cast<int32_t>(width), static_cast<int32_t>(height) };
+
+                if ((clean == true) && (_callback != nullptr)) {
+                    _callback->Damaged();
+                }
+            }
+            _adminLock.Unlock();
+        }
+        void Add(Surface* surface)
+        {
+            ASSERT(surface != nullptr);
+
+            _adminLock.Lock();
+            ASSERT(std::find(_surfaces.begin(), _surfaces.end(), surface) == _surfaces.end());
+            surface->AddRef();
+            _surfaces.push_back(surface);
+            Reorder(surface->_rectangle);
+            _adminLock.Unlock();
+        }
+        void Remove(Surface* surface)
+        {
+            _adminLock.Lock();
+            std::vector<Surface*>::iterator index(std::find(_surfaces.begin(), _surfaces.end(), surface));
+            if (index != _surfaces.end()) {
+                Damage(surface->_rectangle);
+                _surfaces.erase(index);
+            } else {
+                surface = nullptr;
+            }
+            _adminLock.Unlock();
+
+            // Release outside the lock, dropping the last reference releases the remote client.
+            if (surface != nullptr) {
+                surface->Release();
+            }
+        }
+        Statistics Report() const
+        {
+            _adminLock.Lock();
+            Statistics result(_statistics);
+            result.Clients = static_cast<uint32_t>(_surfaces.size());
+            _adminLock.Unlock();
+
+            return (result);
+        }
+        const uint32_t* FrameBuffer() const
+        {
+            return (_frameBuffer.data());
+        }
+        bool IsDamaged() const
+        {
+            _adminLock.Lock();
+            bool result = (_dirty.IsEmpty() == false);
+            _adminLock.Unlock();
+
+            return (result);
+        }
+
+        // Recompose whatever was damaged since the last call. Returns false if
+        // there was nothing to do, so the frame clock can idle cheaply.
+        bool Compose()
+        {
+            bool composed = false;
+
+            _adminLock.Lock();
+
+            Region area(Clip(_dirty));
+
+            if (area.IsEmpty() == false) {
+                uint64_t start = Core::Time::Now().Ticks();
+
+                if (_reorder == true) {
+                    // Layer 0 is the top most surface, so paint from the highest layer down.
+                    std::stable_sort(_surfaces.begin(), _surfaces.end(),
+                        [](const Surface* lhs, const Surface* rhs) { return (lhs->_layer > rhs->_layer); });
+                    _reorder = false;
+                }
+
+                Fill(area, Background, Exchange::IComposition::maxOpacity);
+
+                for (const Surface* surface : _surfaces) {
+                    if (surface->_opacity != Exchange::IComposition::minOpacity) {
+                        Fill(Intersect(area, surface->_rectangle), surface->_color, surface->_opacity);
+                    }
+                }
+
+                uint64_t duration = Core::Time::Now().Ticks() - start;
+
+                _statistics.Frames++;
+                _statistics.LastFrameTime = duration;
+                _statistics.TotalFrameTime += duration;
+                _statistics.MaxFrameTime = std::max(_statistics.MaxFrameTime, duration);
+                _statistics.LastDirty = area.Area();
+                _statistics.TotalDirty += _statistics.LastDirty;
+
+                composed = true;
+            } else {
+                // Do not leave the previous frame behind as if it was this one.
+                _statistics.Skipped++;
+                _statistics.LastFrameTime = 0;
+                _statistics.LastDirty = 0;
+            }
+
+            _dirty = { 0, 0, 0, 0 };
+
+            _adminLock.Unlock();
+
+            return (composed);
+        }
+
+    private:
+        // Below methods expect the lock to be taken.
+        void Damage(const Exchange::IComposition::Rectangle& rectangle)
+        {
+            if ((rectangle.width != 0) && (rectangle.height != 0)) {
+                const int32_t left = static_cast<int32_t>(rectangle.x);
+                const int32_t top = static_cast<int32_t>(rectangle.y);
+                const int32_t right = left + static_cast<int32_t>(rectangle.width);
+                const int32_t bottom = top + static_cast<int32_t>(rectangle.height);
+
+                if (_dirty.IsEmpty() == true) {
+                    _dirty = { left, top, right, bottom };
+
+                    if (_callback != nullptr) {
+                        _callback->Damaged();
+                    }
+                } else {
+                    _dirty.left = std::min(_dirty.left, left);
+                    _dirty.top = std::min(_dirty.top, top);
+                    _dirty.right = std::max(_dirty.right, right);
+                    _dirty.bottom = std::max(_dirty.bottom, bottom);
+                }
+            }
+        }
+        void Reorder(const Exchange::IComposition::Rectangle& rectangle)
+        {
+            _reorder = true;
+            Damage(rectangle);
+        }
+        Region Clip(const Region& region) const
+        {
+            return (Region({ std::max(region.left, 0), std::max(region.top, 0),
+                std::min(region.right, static_cast<int32_t>(_width)), std::min(region.bottom, static_cast<int32_t>(_height)) }));
+        }
+        Region Intersect(const Region& area, const Exchange::IComposition::Rectangle& rectangle) const
+        {
+            const int32_t left = static_cast<int32_t>(rectangle.x);
+            const int32_t top = static_cast<int32_t>(rectangle.y);
+
+            return (Region({ std::max(area.left, left), std::max(area.top, top),
+                std::min(area.right, left + static_cast<int32_t>(rectangle.width)),
+                std::min(area.bottom, top + static_cast<int32_t>(rectangle.height)) }));
+        }
+        void Fill(const Region& region, const uint32_t color, const uint32_t opacity)
+        {
+            if (region.IsEmpty() == false) {
+                const uint32_t alpha = std::min(opacity, static_cast<uint32_t>(Exchange::IComposition::maxOpacity));
+                const uint32_t inverse = Exchange::IComposition::maxOpacity - alpha;
+
+                for (int32_t y = region.top; y < region.bottom; y++) {
+                    uint32_t* line = &(_frameBuffer[(y * _width) + region.left]);
+                    uint32_t* end = line + (region.right - region.left);
+
+                    if (inverse == 0) {
+                        std::fill(line, end, color);
+                    } else {
+                        for (; line != end; ++line) {
+                            const uint32_t dst = *line;
+                            const uint32_t r = ((((color >> 16) & 0xFF) * alpha) + (((dst >> 16) & 0xFF) * inverse)) / Exchange::IComposition::maxOpacity;
+                            const uint32_t g = ((((color >> 8) & 0xFF) * alpha) + (((dst >> 8) & 0xFF) * inverse)) / Exchange::IComposition::maxOpacity;
+                            const uint32_t b = (((color & 0xFF) * alpha) + ((dst & 0xFF) * inverse)) / Exchange::IComposition::maxOpacity;
+                            *line = 0xFF000000 | (r << 16) | (g << 8) | b;
+                        }
+                    }
+                }
+            }
+        }
+
+    private:
+        mutable Core::CriticalSection _adminLock;
+        uint32_t _width;
+        uint32_t _height;
+        std::vector<uint32_t> _frameBuffer;
+        std::vector<Surface*> _surfaces;
+        Region _dirty;
+        bool _reorder;
+        Statistics _statistics;
+        INotification* _callback;
+    };
+
+} // namespace Headless
+} // namespace WPEFramework
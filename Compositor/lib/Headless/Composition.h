@@ -0,0 +1,210 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+#include "Canvas.h"
+
+namespace WPEFramework {
+namespace Headless {
+
+    // The IComposition side of the headless compositor: it wraps every client
+    // that is offered in a surface of the canvas and hands that surface to the
+    // observers, so whatever the plugin changes ends up in the composition.
+    // How clients get here (RPC) and what drives the frames is left to the
+    // implementation deriving from it, which also provides Configure.
+    class Composition : public Exchange::IComposition {
+    private:
+        Composition(const Composition&) = delete;
+        Composition& operator=(const Composition&) = delete;
+
+    public:
+        Composition()
+            : _adminLock()
+            , _observers()
+            , _clients()
+            , _resolution(Exchange::IComposition::ScreenResolution::ScreenResolution_720p)
+            , _canvas(Exchange::IComposition::WidthFromResolution(_resolution), Exchange::IComposition::HeightFromResolution(_resolution))
+        {
+        }
+        ~Composition() override
+        {
+            for (auto& client : _clients) {
+                _canvas.Remove(client.second);
+                client.second->Release();
+            }
+            _clients.clear();
+        }
+
+    public:
+        void Register(Exchange::IComposition::INotification* notification) override
+        {
+            _adminLock.Lock();
+            ASSERT(std::find(_observers.begin(),
+                       _observers.end(), notification)
+                == _observers.end());
+            notification->AddRef();
+            _observers.push_back(notification);
+            for (auto& client : _clients) {
+                notification->Attached(client.first, client.second);
+            }
+            _adminLock.Unlock();
+        }
+
+        void Unregister(Exchange::IComposition::INotification* notification) override
+        {
+            _adminLock.Lock();
+            std::list<Exchange::IComposition::INotification*>::iterator index(
+                std::find(_observers.begin(), _observers.end(), notification));
+            ASSERT(index != _observers.end());
+            if (index != _observers.end()) {
+                _observers.erase(index);
+                notification->Release();
+            }
+            _adminLock.Unlock();
+        }
+
+        uint32_t Resolution(const Exchange::IComposition::ScreenResolution format) override
+        {
+            uint32_t result = Core::ERROR_UNAVAILABLE;
+            const uint32_t width = Exchange::IComposition::WidthFromResolution(format);
+            const uint32_t height = Exchange::IComposition::HeightFromResolution(format);
+
+            if ((width != 0) && (height != 0)) {
+                _adminLock.Lock();
+                _resolution = format;
+                _canvas.Resize(width, height);
+                _adminLock.Unlock();
+
+                result = Core::ERROR_NONE;
+            } else {
+                TRACE(Trace::Information, (_T("Could not set screenresolution to %s."), Core::EnumerateType<Exchange::IComposition::ScreenResolution>(format).Data()));
+            }
+
+            return (result);
+        }
+
+        Exchange::IComposition::ScreenResolution Resolution() const override
+        {
+            return (_resolution);
+        }
+
+    public:
+        // Recompose whatever changed since the previous frame, returns false if nothing did.
+        inline bool Compose()
+        {
+            return (_canvas.Compose());
+        }
+        inline Headless::Canvas::Statistics Report() const
+        {
+            return (_canvas.Report());
+        }
+
+        void NewClientOffered(Exchange::IComposition::IClient* client)
+        {
+            ASSERT(client != nullptr);
+            if (client != nullptr) {
+
+                const string name(client->Name());
+                if (name.empty() == true) {
+                    ASSERT(false);
+                    TRACE(Trace::Information, (_T("Registration of a nameless client.")));
+                } else {
+                    _adminLock.Lock();
+
+                    std::map<string, Headless::Canvas::Surface*>::iterator element(_clients.find(name));
+
+                    if (element != _clients.end()) {
+                        // as the old one may be dangling because of a crash let's remove that one, this is the most logical thing to do
+                        Detach(element);
+
+                        TRACE(Trace::Information, (_T("Replace client %s."), name.c_str()));
+                    } else {
+                        TRACE(Trace::Information, (_T("Added client %s."), name.c_str()));
+                    }
+
+                    // The plugin talks to our surface, which forwards to the client after
+                    // recording the change, so the composition always follows the control path.
+                    Headless::Canvas::Surface* surface = Headless::Canvas::Surface::Create(_canvas, name, client);
+
+                    _canvas.Add(surface);
+                    _clients.emplace(name, surface);
+
+                    for (auto&& index : _observers) {
+                        index->Attached(name, surface);
+                    }
+
+                    _adminLock.Unlock();
+                }
+            }
+        }
+
+        void ClientRevoked(const IUnknown* client)
+        {
+            // note do not release by looking up the name, client might live in another process and the name call might fail if the connection is gone
+            ASSERT(client != nullptr);
+
+            _adminLock.Lock();
+
+            std::map<string, Headless::Canvas::Surface*>::iterator index(_clients.begin());
+            while ((index != _clients.end()) && (index->second->Remote() != client)) {
+                ++index;
+            }
+
+            if (index != _clients.end()) {
+                Detach(index);
+            }
+
+            _adminLock.Unlock();
+
+            TRACE(Trace::Information, (_T("Client detached completed")));
+        }
+
+    private:
+        void Detach(std::map<string, Headless::Canvas::Surface*>::iterator& index)
+        {
+            const string name(index->first);
+            Headless::Canvas::Surface* surface(index->second);
+
+            TRACE(Trace::Information, (_T("Remove client %s."), name.c_str()));
+
+            for (auto observer : _observers) {
+                observer->Detached(name.c_str());
+            }
+
+            _clients.erase(index);
+            _canvas.Remove(surface);
+            surface->Release();
+        }
+
+    protected:
+        mutable Core::CriticalSection _adminLock;
+
+    private:
+        std::list<Exchange::IComposition::INotification*> _observers;
+        std::map<string, Headless::Canvas::Surface*> _clients;
+        Exchange::IComposition::ScreenResolution _resolution;
+
+    protected:
+        Headless::Canvas _canvas;
+    };
+
+} // namespace Headless
+} // namespace WPEFramework
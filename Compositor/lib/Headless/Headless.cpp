@@ -0,0 +1,290 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Module.h"
+#include "Composition.h"
+
+#include <atomic>
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+namespace WPEFramework {
+namespace Plugin {
+
+    class CompositorImplementation : public Headless::Composition, public Headless::Canvas::INotification {
+    private:
+        CompositorImplementation(const CompositorImplementation&) = delete;
+        CompositorImplementation& operator=(const CompositorImplementation&) = delete;
+
+        using FrameClock = Core::WorkerPool::JobType<CompositorImplementation&>;
+
+        class ExternalAccess : public RPC::Communicator {
+        private:
+            ExternalAccess() = delete;
+            ExternalAccess(const ExternalAccess&) = delete;
+            ExternalAccess& operator=(const ExternalAccess&) = delete;
+
+        public:
+            ExternalAccess(
+                CompositorImplementation& parent,
+                const Core::NodeId& source,
+                const string& proxyStubPath,
+                const Core::ProxyType<RPC::InvokeServer>& handler)
+                : RPC::Communicator(source, proxyStubPath.empty() == false ? Core::Directory::Normalize(proxyStubPath) : proxyStubPath, Core::ProxyType<Core::IIPCServer>(handler))
+                , _parent(parent)
+            {
+                uint32_t result = RPC::Communicator::Open(RPC::CommunicationTimeOut);
+
+                handler->Announcements(Announcement());
+
+                if (result != Core::ERROR_NONE) {
+                    TRACE(Trace::Error, (_T("Could not open Headless Compositor RPCLink server. Error: %s"), Core::NumberType<uint32_t>(result).Text()));
+                } else {
+                    // We need to pass the communication channel NodeId via an environment variable, for process,
+                    // not being started by the rpcprocess...
+                    Core::SystemInfo::SetEnvironment(_T("COMPOSITOR"), RPC::Communicator::Connector(), true);
+                }
+            }
+
+            virtual ~ExternalAccess() override = default;
+
+        private:
+            void Offer(Core::IUnknown* element, const uint32_t interfaceID) override
+            {
+                Exchange::IComposition::IClient* result = element->QueryInterface<Exchange::IComposition::IClient>();
+
+                if (result != nullptr) {
+                    _parent.NewClientOffered(result);
+                    result->Release();
+                }
+            }
+
+            void Revoke(const Core::IUnknown* element, const uint32_t interfaceID) override
+            {
+                _parent.ClientRevoked(element);
+            }
+
+        private:
+            CompositorImplementation& _parent;
+        };
+
+        class Config : public Core::JSON::Container {
+        private:
+            Config(const Config&) = delete;
+            Config& operator=(const Config&) = delete;
+
+        public:
+            Config()
+                : Core::JSON::Container()
+                , Connector(_T("/tmp/compositor"))
+                , Resolution(Exchange::IComposition::ScreenResolution::ScreenResolution_720p)
+                , FrameRate(60)
+                , Statistics(10)
+            {
+                Add(_T("connector"), &Connector);
+                Add(_T("resolution"), &Resolution);
+                Add(_T("framerate"), &FrameRate);
+                Add(_T("statistics"), &Statistics);
+            }
+
+            ~Config()
+            {
+            }
+
+        public:
+            Core::JSON::String Connector;
+            Core::JSON::EnumType<Exchange::IComposition::ScreenResolution> Resolution;
+            Core::JSON::DecUInt8 FrameRate;
+            Core::JSON::DecUInt16 Statistics; // Seconds between statistics reports, 0 disables them.
+        };
+
+    public:
+#ifdef __WINDOWS__
+#pragma warning(disable : 4355)
+#endif
+        CompositorImplementation()
+            : Headless::Composition()
+            , _service(nullptr)
+            , _engine()
+            , _externalAccess(nullptr)
+            , _frameClock(*this)
+            , _idle(false)
+            , _period(0)
+            , _nextFrame(0)
+            , _reportInterval(0)
+            , _nextReport(0)
+        {
+        }
+#ifdef __WINDOWS__
+#pragma warning(default : 4355)
+#endif
+
+        ~CompositorImplementation()
+        {
+            _canvas.Callback(nullptr);
+
+            _adminLock.Lock();
+            _period = 0;
+            _adminLock.Unlock();
+
+            _frameClock.Revoke();
+
+            if (_externalAccess != nullptr) {
+                delete _externalAccess;
+                _engine.Release();
+            }
+        }
+
+        BEGIN_INTERFACE_MAP(CompositorImplementation)
+        INTERFACE_ENTRY(Exchange::IComposition)
+        END_INTERFACE_MAP
+
+    public:
+        uint32_t Configure(PluginHost::IShell* service) override
+        {
+            uint32_t result = Core::ERROR_NONE;
+            _service = service;
+
+            Config config;
+            config.FromString(service->ConfigLine());
+
+            if (config.Resolution.IsSet() == true) {
+                Resolution(config.Resolution.Value());
+            }
+
+            _engine = Core::ProxyType<RPC::InvokeServer>::Create(&Core::IWorkerPool::Instance());
+            _externalAccess = new ExternalAccess(*this, Core::NodeId(config.Connector.Value().c_str()), service->ProxyStubPath(), _engine);
+
+            if (_externalAccess->IsListening() == true) {
+                _adminLock.Lock();
+                _period = (config.FrameRate.Value() != 0 ? (Core::Time::TicksPerMillisecond * 1000) / config.FrameRate.Value() : 0);
+                _reportInterval = config.Statistics.Value() * Core::Time::TicksPerMillisecond * 1000;
+                _nextFrame = Core::Time::Now().Ticks();
+                _nextReport = _nextFrame + _reportInterval;
+                _adminLock.Unlock();
+
+                if (_period != 0) {
+                    _canvas.Callback(this);
+                    _frameClock.Submit();
+                }
+
+                PlatformReady();
+
+            } else {
+                delete _externalAccess;
+                _externalAccess = nullptr;
+                _engine.Release();
+                TRACE(Trace::Error, (_T("Could not report PlatformReady as there was a problem starting the Compositor RPC %s"), _T("server")));
+                result = Core::ERROR_OPENING_FAILED;
+            }
+            return result;
+        }
+
+    public:
+        // Frame clock: compose whatever was damaged, keep the cadence and
+        // periodically report how expensive that was. Once a frame finds
+        // nothing to do, the clock stops until the canvas gets damaged again.
+        void Dispatch()
+        {
+            const bool composed = Compose();
+
+            _adminLock.Lock();
+
+            if (_period != 0) {
+                const uint64_t now = Core::Time::Now().Ticks();
+
+                if ((_reportInterval != 0) && (now >= _nextReport)) {
+                    Log();
+                    _nextReport = now + _reportInterval;
+                }
+
+                _nextFrame += _period;
+
+                if (_nextFrame <= now) {
+                    // We missed one or more frames (or were idle), do not try to catch up.
+                    _nextFrame = now + _period;
+                }
+
+                if (composed == true) {
+                    _frameClock.Schedule(Core::Time(_nextFrame));
+                } else {
+                    _idle.store(true);
+
+                    // Damage that came in before we went idle did not wake us, so look again.
+                    if ((_canvas.IsDamaged() == true) && (_idle.exchange(false) == true)) {
+                        _frameClock.Schedule(Core::Time(_nextFrame));
+                    }
+                }
+            }
+
+            _adminLock.Unlock();
+        }
+
+    private:
+        // Headless::Canvas::INotification, called with the canvas lock taken,
+        // so only restart the clock here and stay away from our own lock.
+        void Damaged() override
+        {
+            if (_idle.exchange(false) == true) {
+                _frameClock.Submit();
+            }
+        }
+
+        void Log() const
+        {
+            const Headless::Canvas::Statistics stats(Report());
+
+            TRACE(Trace::Information, (_T("Headless composition: clients=%d frames=%d skipped=%d frametime(us) last=%d avg=%d max=%d dirty(px) last=%d avg=%d"),
+                stats.Clients,
+                stats.Frames,
+                stats.Skipped,
+                static_cast<uint32_t>(stats.LastFrameTime),
+                static_cast<uint32_t>(stats.Frames != 0 ? stats.TotalFrameTime / stats.Frames : 0),
+                static_cast<uint32_t>(stats.MaxFrameTime),
+                static_cast<uint32_t>(stats.LastDirty),
+                static_cast<uint32_t>(stats.Frames != 0 ? stats.TotalDirty / stats.Frames : 0)));
+        }
+
+        void PlatformReady()
+        {
+            PluginHost::ISubSystem* subSystems(_service->SubSystems());
+            ASSERT(subSystems != nullptr);
+            if (subSystems != nullptr) {
+                subSystems->Set(PluginHost::ISubSystem::PLATFORM, nullptr);
+                subSystems->Set(PluginHost::ISubSystem::GRAPHICS, nullptr);
+                subSystems->Release();
+            }
+        }
+
+    private:
+        PluginHost::IShell* _service;
+        Core::ProxyType<RPC::InvokeServer> _engine;
+        ExternalAccess* _externalAccess;
+        FrameClock _frameClock;
+        std::atomic<bool> _idle;
+        uint64_t _period;
+        uint64_t _nextFrame;
+        uint64_t _reportInterval;
+        uint64_t _nextReport;
+    };
+
+    SERVICE_REGISTRATION(CompositorImplementation, 1, 0);
+
+} // namespace Plugin
+} // namespace WPEFramework
@@ -43,176 +43,276 @@ namespace Plugin {
     /* static */ const Core::NodeId DIALServer::DIALServerImpl::DialServerInterface(_T("239.255.255.250"), 1900);
     /* static */ std::map<string, DIALServer::IApplicationFactory*> DIALServer::AppInformation::_applicationFactory;
 
-    class WebFlow {
-    private:
-        // -------------------------------------------------------------------
-        // This object should not be copied or assigned. Prevent the copy
-        // constructor and assignment constructor from being used. Compiler
-        // generated assignment and copy methods will be blocked by the
-        // following statments.
-        // Define them but do not implement them, compile error/link error.
-        // -------------------------------------------------------------------
-        WebFlow(const WebFlow& a_Copy) = delete;
-        WebFlow& operator=(const WebFlow& a_RHS) = delete;
-
-    public:
-        WebFlow(const Core::ProxyType<Web::Request>& request, const Core::NodeId& nodeId)
-        {
-            if (request.IsValid() == true) {
-                string text;
-                request->ToString(text);
-                _text = Core::ToString(string("\n[" + nodeId.HostAddress() + ']' + text + '\n'));
-            }
-        }
-        WebFlow(const Core::ProxyType<Web::Response>& response, const Core::NodeId& nodeId)
-        {
-            if (response.IsValid() == true) {
-                string text;
-                response->ToString(text);
-                _text = Core::ToString(string("\n[" + nodeId.HostAddress() + ']' + text + '\n'));
-            }
-        }
-        ~WebFlow()
-        {
-        }
-
-    public:
-        inline const char* Data() const
-        {
-            return (_text.c_str());
-        }
-        inline uint16_t Length() const
-        {
-            return (static_cast<uint16_t>(_text.length()));
-        }
-
-    private:
-        std::string _text;
-    };
-
-    uint16_t DIALServer::WebTransform::Transform(Web::Request::Deserializer& deserializer, uint8_t* dataFrame, const uint16_t maxSendSize)
+    static bool MatchKeyword(const uint8_t*& checker, const uint8_t* end, const TCHAR keyword[])
     {
-        uint16_t index = 0;
-        const uint8_t* checker = dataFrame;
-
-        // This is a UDP service, so a message should be complete. If the first keyword is not a keyword we
-        // expect, ignore the full message, it is not a DIAL server package and does not require any further
-        // processing.
-        // First skip the white sace, if applicable...
-        while (isspace(*checker)) {
-            checker++;
-        }
+        const uint8_t* position = checker;
 
-        // Now see if the first keyword is "M-SEARCH"
-        while ((index < _keywordLength) && (toupper(*checker) == Web::Request::MSEARCH[index])) {
-            checker++;
-            index++;
+        while ((*keyword != '\0') && (position < end) && (toupper(*position) == *keyword)) {
+            position++;
+            keyword++;
         }
 
-        // Now we need to find the keyword "M-SEARCH" see if we have it..
-        if (index == _keywordLength) {
-            deserializer.Flush();
-            index = deserializer.Deserialize(dataFrame, maxSendSize);
-        } else {
-            index = maxSendSize;
+        if (*keyword == '\0') {
+            checker = position;
         }
 
-        return (index);
+        return (*keyword == '\0');
     }
 
-    DIALServer::DIALServerImpl::DIALServerImpl(const string& MACAddress, const string& baseURL, const string& appPath)
-        : BaseClass(5, false, Core::NodeId(DialServerInterface.AnyInterface(), DialServerInterface.PortNumber()), DialServerInterface.AnyInterface(), 1024, 1024)
-        , _response(Core::ProxyType<Web::Response>::Create())
-        , _destinations()
+    DIALServer::DIALServerImpl::DIALServerImpl(const string& MACAddress, const string& baseURL, const string& appPath, const uint16_t maxDelay, const uint16_t suppression)
+        : Core::SocketDatagram(false, Core::NodeId(DialServerInterface.AnyInterface(), DialServerInterface.PortNumber()), DialServerInterface.AnyInterface(), 1024, 1024)
+        , _lock()
+        , _usn(_T("uuid:UniqueIdentifier::") + _SearchTarget)
         , _baseURL(baseURL)
         , _appPath(appPath)
+        , _template()
+        , _maxDelay(maxDelay)
+        , _suppression(suppression)
+        , _pending()
+        , _answered()
+        , _timer(Core::Thread::DefaultStackSize(), _T("SSDPResponder"))
     {
-        _response->ErrorCode = Web::STATUS_OK;
-        _response->Message = _T("OK");
-        _response->CacheControl = _T("max-age=1800");
-        _response->Server = _T("Linux/2.6 UPnP/1.0 quick_ssdp/1.0");
-        _response->ST = _SearchTarget;
-        _response->USN = _T("uuid:UniqueIdentifier::") + _SearchTarget;
-        // FIXME: Uncomment when adding WoL/WoWLAN support.
-        // This SHALL NOT be present if neither WoL nor WoWLAN is supported.
-        // Moreover real MAC address of the network iface (either wired or wireless one) should be passed
-        // where currently Device identifier is passed in MACAddress.
-        // _response->WakeUp = _T("MAC=") + MACAddress + _T(";Timeout=10");
-        _response->Mode(Web::MARSHAL_UPPERCASE);
-
-        if (Link().Open(1000) != Core::ERROR_NONE) {
+        // FIXME: Add a "WAKEUP: MAC=<MACAddress>;Timeout=10" line to the template when adding WoL/WoWLAN
+        // support. This SHALL NOT be present if neither WoL nor WoWLAN is supported. Moreover real MAC
+        // address of the network iface (either wired or wireless one) should be passed where currently
+        // Device identifier is passed in MACAddress.
+        _lock.Lock();
+        _template = Template();
+        _lock.Unlock();
+
+        if (SocketDatagram::Open(1000) != Core::ERROR_NONE) {
             ASSERT(false && "Seems we can not open the DIAL discovery port");
         }
 
-        Link().Join(DialServerInterface);
+        SocketDatagram::Join(DialServerInterface);
     }
 
     /* virtual */ DIALServer::DIALServerImpl::~DIALServerImpl()
     {
-        Link().Leave(DialServerInterface);
-        Link().Close(Core::infinite);
+        _timer.Revoke(TimeHandler(this));
+
+        SocketDatagram::Leave(DialServerInterface);
+        SocketDatagram::Close(Core::infinite);
     }
 
-    // Notification of a Partial Request received, time to attach a body..
-    /* virtual */ void DIALServer::DIALServerImpl::LinkBody(Core::ProxyType<Web::Request>& element)
+    string DIALServer::DIALServerImpl::Template() const
     {
-        // upnp requests are empty so no body needed...
+        return (_T("HTTP/1.1 200 OK\r\n")
+                _T("CACHE-CONTROL: max-age=1800\r\n")
+                _T("EXT:\r\n")
+                _T("LOCATION: ") + _baseURL + '/' + _appPath + '/' + _DefaultAppInfoDevice + _T("\r\n")
+                _T("SERVER: Linux/2.6 UPnP/1.0 quick_ssdp/1.0\r\n")
+                _T("ST: ") + _SearchTarget + _T("\r\n")
+                _T("USN: ") + _usn + _T("\r\n")
+                _T("\r\n"));
     }
-    // Notification of a Partial Request received, time to attach a body..
-    // upnp requests are empty so no body needed...
-    /* virtual */ void DIALServer::DIALServerImpl::Received(Core::ProxyType<Web::Request>& request)
+
+    void DIALServer::DIALServerImpl::Schedule(const Core::NodeId& remote, const uint16_t mx)
     {
-        Core::NodeId sourceNode(Link().ReceivedNode());
-        TRACE(WebFlow, (request, sourceNode));
+        const uint64_t now = Core::Time::Now().Ticks();
+        bool trigger = false;
 
-        if ((request->Verb == Web::Request::HTTP_MSEARCH) && (request->ST.IsSet() == true)) {
-            if (request->ST.Value() == _SearchTarget) {
+        _lock.Lock();
 
-                TRACE(Protocol, (&(*request)));
-                _destinations.push_back(sourceNode);
-                // remember the NodeId where this comes from.
-                if (_destinations.size() == 1) {
+        // Forget about the answers that are older than the suppression window.
+        while ((_answered.empty() == false) && ((_answered.front().Due() + (_suppression * Core::Time::TicksPerMillisecond)) < now)) {
+            _answered.pop_front();
+        }
+
+        std::list<Pending>::const_iterator index(_pending.begin());
+        while ((index != _pending.end()) && (index->Remote() != remote)) {
+            index++;
+        }
+
+        if (index != _pending.end()) {
+            TRACE(Protocol, (_T("M-SEARCH from [") + remote.HostAddress() + _T("] already scheduled.")));
+        } else {
+            index = _answered.begin();
+            while ((index != _answered.end()) && (index->Remote() != remote)) {
+                index++;
+            }
+
+            if (index != _answered.end()) {
+                TRACE(Protocol, (_T("M-SEARCH from [") + remote.HostAddress() + _T("] answered recently.")));
+            } else if (_pending.size() >= MaxPendingResponses) {
+                TRACE_L1("Too many pending SSDP responses, dropping M-SEARCH from %s", remote.HostAddress().c_str());
+            } else {
+                // The MX header (in seconds) tells us how much the sender is willing to wait. Spread the
+                // answers over that window (capped to what we are configured for) to avoid bursts.
+                uint32_t window = std::min(static_cast<uint32_t>(mx) * 1000, static_cast<uint32_t>(_maxDelay));
+                uint32_t delay = 0;
+
+                if (window > 0) {
+                    Crypto::Random(delay);
+                    delay %= (window + 1);
+                }
 
-                    Link().RemoteNode(_destinations.front());
+                const uint64_t due = now + (delay * Core::Time::TicksPerMillisecond);
 
-                    _response->Location = URL() + '/' + _DefaultAppInfoDevice;
+                std::list<Pending>::iterator position(_pending.begin());
+                while ((position != _pending.end()) && (position->Due() <= due)) {
+                    position++;
+                }
 
-                    Submit(_response);
+                if (position == _pending.begin()) {
+                    // This is the first one to go out, make sure we wake up in time.
+                    if (delay == 0) {
+                        trigger = true;
+                    } else {
+                        _timer.Revoke(TimeHandler(this));
+                        _timer.Schedule(Core::Time(due), TimeHandler(this));
+                    }
                 }
+
+                _pending.insert(position, Pending(remote, due));
             }
         }
+
+        _lock.Unlock();
+
+        if (trigger == true) {
+            SocketDatagram::Trigger();
+        }
     }
 
-    // Notification of a Response send.
-    /* virtual */ void DIALServer::DIALServerImpl::Send(const Core::ProxyType<Web::Response>& response)
+    // Signal a state change, Opened, Closed or Accepted
+    /* virtual */ void DIALServer::DIALServerImpl::StateChange()
+    {
+    }
+
+    /* virtual */ uint16_t DIALServer::DIALServerImpl::SendData(uint8_t* dataFrame, const uint16_t maxSendSize)
     {
-        TRACE(WebFlow, (response, _destinations.front()));
+        uint16_t result = 0;
+        const uint64_t now = Core::Time::Now().Ticks();
+
+        _lock.Lock();
+
+        if ((_pending.empty() == false) && (_pending.front().Due() <= now)) {
+
+            const Pending& entry(_pending.front());
 
-        TRACE(Protocol, (&(*response)));
+            ASSERT(_template.length() <= maxSendSize);
 
-        // Drop the current destination.
-        _destinations.pop_front();
+            result = static_cast<uint16_t>(std::min(_template.length(), static_cast<size_t>(maxSendSize)));
+            ::memcpy(dataFrame, _template.c_str(), result);
 
-        if (_destinations.size() > 0) {
-            _response->Location = URL() + '/' + _DefaultAppInfoDevice;
+            SocketDatagram::RemoteNode(entry.Remote());
 
-            // Move on to notifying the next one.
-            Link().RemoteNode(_destinations.front());
+            TRACE(Protocol, (_T("SSDP response to [") + entry.Remote().HostAddress() + _T("]")));
 
-            Submit(response);
+            _answered.push_back(Pending(entry.Remote(), now));
+            _pending.pop_front();
         }
+
+        if (_pending.empty() == false) {
+            if (_pending.front().Due() <= now) {
+                // More answers are due, keep the ball rolling.
+                SocketDatagram::Trigger();
+            } else {
+                _timer.Revoke(TimeHandler(this));
+                _timer.Schedule(Core::Time(_pending.front().Due()), TimeHandler(this));
+            }
+        }
+
+        _lock.Unlock();
+
+        return (result);
     }
 
-    // Notification of a channel state change..
-    /* virtual */ void DIALServer::DIALServerImpl::StateChange()
+    /* virtual */ uint16_t DIALServer::DIALServerImpl::ReceiveData(uint8_t* dataFrame, const uint16_t receivedSize)
     {
+        const uint8_t* checker = dataFrame;
+        const uint8_t* const end = &(dataFrame[receivedSize]);
+
+        // This is a UDP service, so a message should be complete. If the first keyword is not a keyword we
+        // expect, ignore the full message, it is not a DIAL server package and does not require any further
+        // processing. First skip the white space, if applicable...
+        while ((checker < end) && (isspace(*checker))) {
+            checker++;
+        }
+
+        if (MatchKeyword(checker, end, Web::Request::MSEARCH) == true) {
+            bool found = false;
+            uint16_t mx = 1;
+
+            // No need to deserialize the full request, we are only interested in the ST and MX headers.
+            while (checker < end) {
+                // Move to the beginning of the next header line.
+                while ((checker < end) && (*checker != '\n')) {
+                    checker++;
+                }
+                while ((checker < end) && (isspace(*checker))) {
+                    checker++;
+                }
+
+                if (MatchKeyword(checker, end, _T("ST:")) == true) {
+                    while ((checker < end) && ((*checker == ' ') || (*checker == '\t'))) {
+                        checker++;
+                    }
+                    const uint8_t* value = checker;
+                    while ((checker < end) && (*checker != '\r') && (*checker != '\n')) {
+                        checker++;
+                    }
+                    const string target(reinterpret_cast<const char*>(value), static_cast<size_t>(checker - value));
+
+                    found = ((target == _SearchTarget) || (target == _T("ssdp:all")));
+                } else if (MatchKeyword(checker, end, _T("MX:")) == true) {
+                    mx = 0;
+                    while ((checker < end) && ((*checker == ' ') || (*checker == '\t'))) {
+                        checker++;
+                    }
+                    while ((checker < end) && (isdigit(*checker)) && (mx < 120)) {
+                        mx = (mx * 10) + (*checker - '0');
+                        checker++;
+                    }
+                }
+            }
+
+            if (found == true) {
+                Schedule(SocketDatagram::ReceivedNode(), mx);
+            }
+        }
+
+        return (receivedSize);
+    }
+
+    void DIALServer::AppInformation::Refresh(const bool force)
+    {
+        // Query the handler outside of our lock, it might call out to other plugins.
+        const bool running = _application->IsRunning();
+        const bool hidden = (HasHideAndShow() == true) && (IsHidden() == true);
+
+        _lock.Lock();
+
+        if ((force == true) || (running != _running) || (hidden != _hidden)) {
+            _running = running;
+            _hidden = hidden;
+            _version++;
+        }
+
+        _lock.Unlock();
     }
 
     void DIALServer::AppInformation::GetData(string& data, const Version& version) const
     {
-        bool running = IsRunning();
-        bool hidden = HasHideAndShow() == true && IsHidden() == true;
-        bool isAtLeast2_1 = Version{2, 1, 0} <= version;
+        const bool isAtLeast2_1 = Version{2, 1, 0} <= version;
+        const uint8_t slot = (isAtLeast2_1 == true ? 1 : 0);
+
+        _lock.Lock();
+
+        if (_renderedVersion[slot] != _version) {
+            Render(_rendered[slot], isAtLeast2_1);
+            _renderedVersion[slot] = _version;
+        }
+
+        data = _rendered[slot];
+
+        _lock.Unlock();
+    }
+
+    // Should be called with the _lock taken.
+    void DIALServer::AppInformation::Render(string& data, const bool isAtLeast2_1) const
+    {
         // allowSop is mandatory to be true starting from 2.1
         string allowStop = isAtLeast2_1 == true || HasStartAndStop() == true ? "true" : "false";
         string dialVersion;
@@ -228,9 +328,9 @@ namespace Plugin {
             + allowStop + _T("\"/><state>")
             // 2.2 spec adds "hidden" state. It also introduces "installable" state.
             // We may consider adding support for it at some point - thanks to the Packager.
-            + (running == true ? (hidden == true && isAtLeast2_1 == true ? _T("hidden") : _T("running")) : _T("stopped")) + _T("</state>")
+            + (_running == true ? (_hidden == true && isAtLeast2_1 == true ? _T("hidden") : _T("running")) : _T("stopped")) + _T("</state>")
             // <link> element is DEPRECATED starting from 2.1
-            + (running == true && isAtLeast2_1 == false ? _T("<link rel=\"run\" href=\"" + _DefaultControlExtension + "\"/>") : _T(""))
+            + (_running == true && isAtLeast2_1 == false ? _T("<link rel=\"run\" href=\"" + _DefaultControlExtension + "\"/>") : _T(""))
             + _T("<additionalData>");
         auto additionalData = AdditionalData();
         if (additionalData.empty() == false) {
@@ -269,6 +369,8 @@ namespace Plugin {
 
         _application->AdditionalData(std::move(additionalData));
         _lock.Unlock();
+
+        Refresh(true);
     }
 
     /* virtual */ const string DIALServer::Initialize(PluginHost::IShell* service)
@@ -295,12 +397,14 @@ namespace Plugin {
 
             // TODO: THis used to be the MAC, but I think  it is just a unique number, otherwise, we need the MAC
             //       that goes with the selectedNode !!!!
-            _dialServiceImpl = new DIALServerImpl(deviceId, _dialURL.Text(), _DefaultAppInfoPath);
+            _dialServiceImpl = new DIALServerImpl(deviceId, _dialURL.Text(), _DefaultAppInfoPath, _config.ResponseDelay.Value(), _config.Suppression.Value());
 
             ASSERT(_dialServiceImpl != nullptr);
 
             _skipURL = static_cast<uint16_t>(service->WebPrefix().length());
 
+            _dialServiceImpl->URL(_applicationURL);
+
             (*_deviceInfo) = _T("<?xml version=\"1.0\"?>")
                              _T("<root xmlns=\"urn:schemas-upnp-org:device-1-0\">")
                              _T("<specVersion>")
@@ -369,10 +473,15 @@ namespace Plugin {
 
         _adminLock.Unlock();
 
+        _refresh.Revoke();
+
         delete _dialServiceImpl;
         _dialServiceImpl = nullptr;
 
+        _adminLock.Lock();
+        _changed.clear();
         _appInfo.clear();
+        _adminLock.Unlock();
 
         _service = nullptr;
     }
@@ -536,8 +645,9 @@ namespace Plugin {
                     result->Body(_deviceInfo);
                     result->ContentType = Web::MIME_XML;
 
-                    Core::URL newURL;
-                    _dialServiceImpl->URL(newURL);
+                    _adminLock.Lock();
+                    Core::URL newURL(_applicationURL);
+                    _adminLock.Unlock();
 
                     result->ApplicationURL = newURL;
                     TRACE(Protocol, (static_cast<const string&>(*_deviceInfo), &newURL));
@@ -590,9 +700,11 @@ namespace Plugin {
                         TRACE(Protocol, (static_cast<const string&>(*textBody)));
                     } else if (request.Verb == Web::Request::HTTP_POST) {
                         StartApplication(request, result, selectedApp->second);
+                        selectedApp->second.Refresh();
                     }
                     else if (request.Verb == Web::Request::HTTP_DELETE) {
                         StopApplication(request, result, selectedApp->second);
+                        selectedApp->second.Refresh();
                     }
                 } else if (index.Current() == _DefaultDataUrlExtension) {
                     if (request.Verb == Web::Request::HTTP_GET) {
@@ -606,6 +718,7 @@ namespace Plugin {
                 } else if (index.Current() == _DefaultControlExtension) {
                     if (request.Verb == Web::Request::HTTP_DELETE) {
                         StopApplication(request, result, selectedApp->second);
+                        selectedApp->second.Refresh();
                     } else if (request.Verb == Web::Request::HTTP_POST) {
                       if (index.Next() == true && index.Current() == kHideCommand) {
                           if (selectedApp->second.HasHideAndShow() == true) {
@@ -619,12 +732,14 @@ namespace Plugin {
                       } else {
                           StartApplication(request, result, selectedApp->second);
                       }
+                      selectedApp->second.Refresh();
                     }
                 } else if (index.Current() == _DefaultRunningExtension) {
                     if ((request.Verb == Web::Request::HTTP_POST) || (request.Verb == Web::Request::HTTP_DELETE)) {
                         result->ErrorCode = Web::STATUS_OK;
                         result->Message = _T("OK");
                         selectedApp->second.Running(request.Verb == Web::Request::HTTP_POST);
+                        selectedApp->second.Refresh();
                     }
                 } else if (index.Current() == _DefaultDataExtension) {
                     result->ErrorCode = Web::STATUS_OK;
@@ -658,6 +773,7 @@ namespace Plugin {
 
         // Let's set the URL of the WebServer, as it is active :-)
         _dialServiceImpl->Locator(pluginInterface->Accessor() + _dialPath);
+        _dialServiceImpl->URL(_applicationURL);
 
         // Redirect all calls to the DIALServer, via a proxy.
         pluginInterface->AddProxy(_dialPath, _dialPath, remote);
@@ -672,6 +788,7 @@ namespace Plugin {
         _adminLock.Lock();
 
         _dialServiceImpl->Locator(_dialURL.Text());
+        _dialServiceImpl->URL(_applicationURL);
         pluginInterface->RemoveProxy(_dialPath);
 
         _adminLock.Unlock();
@@ -680,31 +797,84 @@ namespace Plugin {
     void DIALServer::Activated(Exchange::ISwitchBoard* switchBoard)
     {
 
+        std::list<AppInformation*> refresh;
+
         _adminLock.Lock();
 
         std::map<const string, AppInformation>::iterator index(_appInfo.begin());
 
         while (index != _appInfo.end()) {
             index->second.SwitchBoard(switchBoard);
+            refresh.push_back(&(index->second));
             index++;
         }
 
         _adminLock.Unlock();
+
+        // The refresh calls out to the applications, do not hold the lock while doing so.
+        for (AppInformation* application : refresh) {
+            application->Refresh();
+        }
     }
 
     void DIALServer::Deactivated(Exchange::ISwitchBoard* /* switchBoard */)
     {
 
+        std::list<AppInformation*> refresh;
+
         _adminLock.Lock();
 
         std::map<const string, AppInformation>::iterator index(_appInfo.begin());
 
         while (index != _appInfo.end()) {
             index->second.SwitchBoard(nullptr);
+            refresh.push_back(&(index->second));
             index++;
         }
 
         _adminLock.Unlock();
+
+        // The refresh calls out to the applications, do not hold the lock while doing so.
+        for (AppInformation* application : refresh) {
+            application->Refresh();
+        }
+    }
+
+    // Reported from notification callbacks, the refresh calls out to the handlers, so it is
+    // done from the worker pool.
+    void DIALServer::Changed(const string& callsign)
+    {
+        _adminLock.Lock();
+        _changed.insert(callsign);
+        _adminLock.Unlock();
+
+        _refresh.Submit();
+    }
+
+    void DIALServer::Dispatch()
+    {
+        std::list<AppInformation*> refresh;
+
+        _adminLock.Lock();
+
+        std::set<string> changed;
+        changed.swap(_changed);
+
+        std::map<const string, AppInformation>::iterator index(_appInfo.begin());
+
+        while (index != _appInfo.end()) {
+            if (changed.find(index->second.Callsign()) != changed.end()) {
+                refresh.push_back(&(index->second));
+            }
+            index++;
+        }
+
+        _adminLock.Unlock();
+
+        // The entries of _appInfo only go away in Deinitialize, after this job has been revoked.
+        for (AppInformation* application : refresh) {
+            application->Refresh();
+        }
     }
 }
 }
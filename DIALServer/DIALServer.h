@@ -25,6 +25,8 @@
 #include <interfaces/IWebServer.h>
 #include <interfaces/IBrowser.h>
 
+#include <set>
+
 namespace WPEFramework {
 namespace Plugin {
 
@@ -101,6 +103,8 @@ namespace Plugin {
                 , Interface()
                 , WebServer()
                 , SwitchBoard()
+                , ResponseDelay(1000)
+                , Suppression(250)
             {
                 Add(_T("interface"), &Interface);
                 Add(_T("name"), &Name);
@@ -114,6 +118,8 @@ namespace Plugin {
                 Add(_T("upc"), &UPC);
                 Add(_T("webserver"), &WebServer);
                 Add(_T("switchboard"), &SwitchBoard);
+                Add(_T("responsedelay"), &ResponseDelay);
+                Add(_T("suppression"), &Suppression);
                 Add(_T("apps"), &Apps);
             }
             ~Config()
@@ -133,6 +139,8 @@ namespace Plugin {
             Core::JSON::String Interface;
             Core::JSON::String WebServer;
             Core::JSON::String SwitchBoard;
+            Core::JSON::DecUInt16 ResponseDelay;
+            Core::JSON::DecUInt16 Suppression;
             Core::JSON::ArrayType<App> Apps;
         };
 
@@ -397,6 +405,13 @@ namespace Plugin {
                 return (_service->QueryInterface<REQUESTEDINTERFACE>());
             }
 
+            // Handlers tracking state on their own (e.g. visibility) should report
+            // a change, so the DIALServer can refresh its cached application state.
+            void Changed()
+            {
+                _parent->Changed(_callsign);
+            }
+
         private:
             Exchange::ISwitchBoard* _switchBoard;
             PluginHost::IShell* _service;
@@ -581,51 +596,100 @@ namespace Plugin {
         private:
             std::string _text;
         };
-        class WebTransform {
+        class DIALServerImpl : public Core::SocketDatagram {
         private:
-            WebTransform(const WebTransform&);
-            WebTransform& operator=(const WebTransform&);
+            static const Core::NodeId DialServerInterface;
 
-        public:
-            inline WebTransform()
-                : _keywordLength(static_cast<uint8_t>(_tcslen(Web::Request::MSEARCH)))
-            {
-            }
-            inline ~WebTransform()
-            {
-            }
+            // Upper bound of M-SEARCH senders we keep track of. Anything beyond this is
+            // dropped, the sender will repeat its query anyway.
+            static constexpr uint16_t MaxPendingResponses = 64;
 
-            // Methods to extract and insert data into the socket buffers
-            uint16_t Transform(Web::Request::Deserializer& deserializer, uint8_t* dataFrame, const uint16_t maxSendSize);
+            class Pending {
+            public:
+                Pending() = delete;
+                Pending& operator=(const Pending&) = delete;
 
-        private:
-            uint8_t _keywordLength;
-        };
-        class DIALServerImpl : public Web::WebLinkType<Core::SocketDatagram, Web::Request, Web::Response, Core::ProxyPoolType<Web::Request>, WebTransform> {
-        private:
-            static const Core::NodeId DialServerInterface;
-            typedef Web::WebLinkType<Core::SocketDatagram, Web::Request, Web::Response, Core::ProxyPoolType<Web::Request>, WebTransform> BaseClass;
+                Pending(const Core::NodeId& remote, const uint64_t due)
+                    : _remote(remote)
+                    , _due(due)
+                {
+                }
+                Pending(const Pending& copy)
+                    : _remote(copy._remote)
+                    , _due(copy._due)
+                {
+                }
+                ~Pending()
+                {
+                }
 
-            DIALServerImpl(const DIALServerImpl&) = delete;
-            DIALServerImpl& operator=(const DIALServerImpl&) = delete;
+            public:
+                inline const Core::NodeId& Remote() const
+                {
+                    return (_remote);
+                }
+                inline uint64_t Due() const
+                {
+                    return (_due);
+                }
 
-        public:
-            DIALServerImpl(const string& MACAddress, const string& baseURL, const string& appPath);
-            virtual ~DIALServerImpl();
+            private:
+                Core::NodeId _remote;
+                uint64_t _due;
+            };
 
-        public:
-            // Notification of a Partial Request received, time to attach a body..
-            virtual void LinkBody(Core::ProxyType<Web::Request>& element);
+            class TimeHandler {
+            public:
+                TimeHandler()
+                    : _parent(nullptr)
+                {
+                }
+                TimeHandler(DIALServerImpl* parent)
+                    : _parent(parent)
+                {
+                }
+                TimeHandler(const TimeHandler& copy)
+                    : _parent(copy._parent)
+                {
+                }
+                ~TimeHandler()
+                {
+                }
 
-            // Notification of a Request received.
-            virtual void Received(Core::ProxyType<Web::Request>& text);
+                TimeHandler& operator=(const TimeHandler& RHS)
+                {
+                    _parent = RHS._parent;
+                    return (*this);
+                }
+                bool operator==(const TimeHandler& RHS) const
+                {
+                    return (_parent == RHS._parent);
+                }
+                bool operator!=(const TimeHandler& RHS) const
+                {
+                    return (_parent != RHS._parent);
+                }
 
-            // Notification of a Response send.
-            virtual void Send(const Core::ProxyType<Web::Response>& text);
+            public:
+                uint64_t Timed(const uint64_t /* scheduledTime */)
+                {
+                    ASSERT(_parent != nullptr);
+                    _parent->Trigger();
+                    return (0);
+                }
+
+            private:
+                DIALServerImpl* _parent;
+            };
 
-            // Notification of a channel state change..
-            virtual void StateChange();
+            DIALServerImpl(const DIALServerImpl&) = delete;
+            DIALServerImpl& operator=(const DIALServerImpl&) = delete;
+
+        public:
+            DIALServerImpl(const string& MACAddress, const string& baseURL, const string& appPath, const uint16_t maxDelay, const uint16_t suppression);
+            ~DIALServerImpl() override;
 
+        public:
             inline string URL() const
             {
                 string result;
@@ -647,17 +711,34 @@ namespace Plugin {
                 _lock.Lock();
 
                 _baseURL = hostName;
+                _template = Template();
 
                 _lock.Unlock();
             }
 
+        private:
+            // Signal a state change, Opened, Closed or Accepted
+            void StateChange() override;
+            uint16_t SendData(uint8_t* dataFrame, const uint16_t maxSendSize) override;
+            uint16_t ReceiveData(uint8_t* dataFrame, const uint16_t receivedSize) override;
+
+            // Should be called with the _lock taken.
+            string Template() const;
+            void Schedule(const Core::NodeId& remote, const uint16_t mx);
+
         private:
             mutable Core::CriticalSection _lock;
-            // This should be the "Response" as depicted by the parent/DIALserver.
-            Core::ProxyType<Web::Response> _response;
-            std::list<Core::NodeId> _destinations;
+            const string _usn;
             string _baseURL;
             const string _appPath;
+            // The complete, serialized SSDP answer. Only the LOCATION changes, so it is
+            // rebuild once the Locator changes and copied as is for every M-SEARCH.
+            string _template;
+            const uint16_t _maxDelay;
+            const uint16_t _suppression;
+            std::list<Pending> _pending;
+            std::list<Pending> _answered;
+            Core::TimerType<TimeHandler> _timer;
         };
         class AppInformation {
         private:
@@ -669,8 +750,14 @@ namespace Plugin {
             AppInformation(PluginHost::IShell* service, const Config::App& info, DIALServer* parent)
                 : _lock()
                 , _name(info.Name.Value())
+                , _callsign(info.Callsign.IsSet() == true ? info.Callsign.Value() : info.Name.Value())
                 , _url(info.URL.Value())
                 , _application(nullptr)
+                , _running(false)
+                , _hidden(false)
+                , _version(1)
+                , _rendered()
+                , _renderedVersion()
             {
                 ASSERT(parent != nullptr);
 
@@ -692,6 +779,8 @@ namespace Plugin {
                     // since we still have nothing, fall back to the default
                     _application = new DIALServer::Default(service, info, parent);
                 }
+
+                Refresh();
             }
             ~AppInformation()
             {
@@ -705,6 +794,10 @@ namespace Plugin {
             {
                 return (_name);
             }
+            inline const string& Callsign() const
+            {
+                return (_callsign);
+            }
             inline const string& AppURL() const
             {
                 return (_url);
@@ -794,10 +887,17 @@ namespace Plugin {
                 return (_url.find('?') != string::npos);
             }
 
+            // Re-evaluate the running/hidden state of the application. The description is only
+            // rendered again if something changed since the last time it was served.
+            void Refresh(const bool force = false);
+
             void GetData(string& data, const Version& version = {}) const;
             void SetData(const string& data);
 
         private:
+            void Render(string& data, const bool isAtLeast2_1) const;
+
+
             string XMLEncode(const string& source) const
             {
                 string result;
@@ -832,8 +932,15 @@ namespace Plugin {
         private:
             mutable Core::CriticalSection _lock;
             const string _name;
+            const string _callsign;
             const string _url;
             IApplication* _application;
+            bool _running;
+            bool _hidden;
+            uint32_t _version;
+            // Pre-rendered descriptions, pre DIAL 2.1 and 2.1+ clients get a different one.
+            mutable std::array<string, 2> _rendered;
+            mutable std::array<uint32_t, 2> _renderedVersion;
 
             static std::map<string, IApplicationFactory*> _applicationFactory;
         };
@@ -866,27 +973,27 @@ namespace Plugin {
                 _webServer = webServer;
                 _switchBoard = switchBoard;
 
-                if ((_webServer.empty() == false) || (_switchBoard.empty() == false)) {
-                    service->Register(this);
-                }
+                // All state changes are of interest, they drive the cached application state.
+                service->Register(this);
             }
 
             void Unregister(PluginHost::IShell* service)
             {
-                if ((_webServer.empty() == false) || (_switchBoard.empty() == false)) {
-                    service->Unregister(this);
+                service->Unregister(this);
 
-                    if (_webServerPtr != nullptr) {
-                        _parent.Deactivated(_webServerPtr);
-                        _webServerPtr->Release();
-                        _webServerPtr = nullptr;
-                    }
-                    if (_switchBoardPtr != nullptr) {
-                        _parent.Deactivated(_switchBoardPtr);
-                        _switchBoardPtr->Release();
-                        _switchBoardPtr = nullptr;
-                    }
+                if (_webServerPtr != nullptr) {
+                    _parent.Deactivated(_webServerPtr);
+                    _webServerPtr->Release();
+                    _webServerPtr = nullptr;
+                }
+                if (_switchBoardPtr != nullptr) {
+                    _parent.Deactivated(_switchBoardPtr);
+                    _switchBoardPtr->Release();
+                    _switchBoardPtr = nullptr;
                 }
+
+                _webServer.clear();
+                _switchBoard.clear();
             }
 
             BEGIN_INTERFACE_MAP(ThisClass)
@@ -896,6 +1003,10 @@ namespace Plugin {
         private:
             virtual void StateChange(PluginHost::IShell* shell)
             {
+                if (shell->Callsign().empty() == false) {
+                    _parent.Changed(shell->Callsign());
+                }
+
                 if (shell->Callsign() == _webServer) {
 
                     if (shell->State() == PluginHost::IShell::ACTIVATED) {
@@ -976,8 +1087,11 @@ namespace Plugin {
             , _dialPath()
             , _dialServiceImpl(NULL)
             , _deviceInfo(Core::ProxyType<Web::TextBody>::Create())
+            , _applicationURL()
             , _sink(this)
             , _appInfo()
+            , _changed()
+            , _refresh(*this)
         {
         }
 #ifdef __WINDOWS__
@@ -1034,6 +1148,10 @@ namespace Plugin {
         void Deactivated(Exchange::ISwitchBoard* switchBoard);
         void StartApplication(const Web::Request& request, Core::ProxyType<Web::Response>& response, AppInformation& app);
         void StopApplication(const Web::Request& request, Core::ProxyType<Web::Response>& response, AppInformation& app);
+        void Changed(const string& callsign);
+
+        friend Core::ThreadPool::JobType<DIALServer&>;
+        void Dispatch();
 
         //JsonRpc
         void event_start(const string& application, const string& parameters);
@@ -1048,8 +1166,11 @@ namespace Plugin {
         string _dialPath;
         DIALServerImpl* _dialServiceImpl;
         Core::ProxyType<Web::TextBody> _deviceInfo;
+        Core::URL _applicationURL;
         Core::Sink<Notification> _sink;
         std::map<const string, AppInformation> _appInfo;
+        std::set<string> _changed;
+        Core::WorkerPool::JobType<DIALServer&> _refresh;
     };
 }
 }
@@ -24,6 +24,7 @@
 #define MODULE_NAME Plugin_DIALServer
 #endif
 
+#include <cryptalgo/cryptalgo.h>
 #include <plugins/plugins.h>
 
 #undef EXTERNAL
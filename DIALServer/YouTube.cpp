@@ -104,7 +104,11 @@ namespace DIALHandlers {
             explicit Notification(YouTube* parent) : _parent(parent) {}
             void LoadFinished(const string& URL) override {}
             void URLChanged(const string& URL) override {}
-            void Hidden(const bool hidden) override { _parent->_hidden = hidden; }
+            void Hidden(const bool hidden) override
+            {
+                _parent->_hidden = hidden;
+                _parent->Changed();
+            }
             void Closure() override {}
 
             BEGIN_INTERFACE_MAP(YouTube)
@@ -377,6 +377,20 @@ namespace Plugin {
         _adminLock.Unlock();
     }
 
+    void LocationService::Update(const string& publicIPAddress, const string& timeZone, const string& country, const string& region, const string& city)
+    {
+        _adminLock.Lock();
+
+        _publicIPAddress = publicIPAddress;
+        _timeZone = timeZone;
+        _country = country;
+        _region = region;
+        _city = city;
+        _state = LOADED;
+
+        _adminLock.Unlock();
+    }
+
     // Methods to extract and insert data into the socket buffers
     /* virtual */ void LocationService::LinkBody(Core::ProxyType<Web::Response>& element)
     {
@@ -391,6 +405,7 @@ namespace Plugin {
     /* virtual */ void LocationService::Received(Core::ProxyType<Web::Response>& element)
     {
         if (element->HasBody() == true) {
+            bool report = false;
 
             // ASSERT(element->Body<Web::JSONBodyType<IGeography> >() == _response);
 
@@ -432,7 +447,7 @@ namespace Plugin {
                     _country.c_str());
 
                 TRACE(Trace::Information, (_T("LocationSync: Network connectivity established. Type: %s, on %s"), (node.Type() == Core::NodeId::TYPE_IPV6 ? _T("IPv6") : _T("IPv4")), node.HostAddress().c_str()));
-                _callback->Dispatch();
+                report = true;
             }
 
             ASSERT(_infoCarrier.IsValid() == true);
@@ -440,6 +455,11 @@ namespace Plugin {
             _infoCarrier.Release();
 
             _adminLock.Unlock();
+
+            // Report outside of the lock, the receiver might be racing other LocationServices.
+            if (report == true) {
+                _callback->Dispatch();
+            }
         } else {
             TRACE_L1("Got a response but had an empty body. %d", __LINE__);
         }
@@ -68,6 +68,26 @@ namespace Plugin {
         uint32_t Probe(const string& remoteNode, const uint32_t retries, const uint32_t retryTimeSpan);
         void Stop();
 
+        // Take over a location that was determined elsewhere (another probe or a cached one).
+        void Update(const string& publicIPAddress, const string& timeZone, const string& country, const string& region, const string& city);
+
+        inline bool IsLoaded() const
+        {
+            _adminLock.Lock();
+            bool result = (_state == LOADED);
+            _adminLock.Unlock();
+
+            return (result);
+        }
+        inline bool IsFailed() const
+        {
+            _adminLock.Lock();
+            bool result = (_state == FAILED);
+            _adminLock.Unlock();
+
+            return (result);
+        }
+
         /*
        * ------------------------------------------------------------------------------------------------------------
        * ISubSystem::INetwork methods
@@ -116,7 +136,7 @@ namespace Plugin {
         void Dispatch();
 
     private:
-        Core::CriticalSection _adminLock;
+        mutable Core::CriticalSection _adminLock;
         state _state;
         string _remoteId;
         Core::NodeId _sourceNode;
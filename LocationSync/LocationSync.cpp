@@ -55,11 +55,23 @@ namespace Plugin {
         string version = service->Version();
 
         if (LocationService::IsSupported(config.Source.Value()) == Core::ERROR_NONE) {
+            std::list<string> sources({ config.Source.Value() });
+
+            // Additional endpoints are probed in parallel, the first one to answer wins.
+            Core::JSON::ArrayType<Core::JSON::String>::Iterator index(config.Sources.Elements());
+            while (index.Next() == true) {
+                if (LocationService::IsSupported(index.Current().Value()) == Core::ERROR_NONE) {
+                    sources.push_back(index.Current().Value());
+                } else {
+                    SYSLOG(Logging::Startup, (_T("Location source [%s] is not supported, skipping it."), index.Current().Value().c_str()));
+                }
+            }
+
             _skipURL = static_cast<uint16_t>(service->WebPrefix().length());
             _source = config.Source.Value();
             _service = service;
 
-            _sink.Initialize(service, config.Source.Value(), config.Interval.Value(), config.Retries.Value());
+            _sink.Initialize(service, sources, config.Interval.Value(), config.Retries.Value(), config.TimeToLive.Value());
         } else {
             result = _T("URL for retrieving location is incorrect !!!");
         }
@@ -120,7 +132,7 @@ namespace Plugin {
             index.Next();
             if (index.Next()) {
                 if ((index.Current() == "Sync") && (_source.empty() == false)) {
-                    uint32_t error = _sink.Probe(_source, 1, 1);
+                    uint32_t error = _sink.Probe(1, 1);
 
                     if (error != Core::ERROR_NONE) {
                         result->ErrorCode = Web::STATUS_INTERNAL_SERVER_ERROR;
@@ -136,6 +148,55 @@ namespace Plugin {
         return result;
     }
 
+    bool LocationSync::Notification::Load()
+    {
+        bool loaded = false;
+
+        if (_timeToLive != 0) {
+            Core::File cacheFile(_cacheFile);
+
+            if (cacheFile.Open(true) == true) {
+                Cache cache;
+                Core::OptionalType<Core::JSON::Error> error;
+                cache.IElement::FromFile(cacheFile, error);
+                cacheFile.Close();
+
+                if (error.IsSet() == true) {
+                    SYSLOG(Logging::ParsingError, (_T("Parsing failed with %s"), ErrorDisplayMessage(error.Value()).c_str()));
+                } else if ((cache.PublicIp.Value().empty() == false) && ((cache.Timestamp.Value() + (static_cast<uint64_t>(_timeToLive) * 1000 * Core::Time::TicksPerMillisecond)) > Core::Time::Now().Ticks())) {
+                    _locator->Update(cache.PublicIp.Value(), cache.TimeZone.Value(), cache.Country.Value(), cache.Region.Value(), cache.City.Value());
+                    loaded = true;
+
+                    TRACE(Trace::Information, (_T("LocationSync: Using cached location, public ip: %s"), cache.PublicIp.Value().c_str()));
+                }
+            }
+        }
+
+        return (loaded);
+    }
+
+    void LocationSync::Notification::Save() const
+    {
+        if (_timeToLive != 0) {
+            Core::File cacheFile(_cacheFile);
+
+            if (cacheFile.Create() == true) {
+                Cache cache;
+                cache.PublicIp = _locator->PublicIPAddress();
+                cache.TimeZone = _locator->TimeZone();
+                cache.Region = _locator->Region();
+                cache.Country = _locator->Country();
+                cache.City = _locator->City();
+                cache.Timestamp = Core::Time::Now().Ticks();
+
+                cache.IElement::ToFile(cacheFile);
+                cacheFile.Close();
+            } else {
+                TRACE_L1("Could not store the location in the persistent storage area. %d", __LINE__);
+            }
+        }
+    }
+
     void LocationSync::SyncedLocation()
     {
         PluginHost::ISubSystem* subSystem = _service->SubSystems();
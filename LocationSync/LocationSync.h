@@ -62,6 +62,40 @@ namespace Plugin {
         };
 
     private:
+        class Cache : public Core::JSON::Container {
+        public:
+            Cache(const Cache&) = delete;
+            Cache& operator=(const Cache&) = delete;
+
+            Cache()
+                : Core::JSON::Container()
+                , PublicIp()
+                , TimeZone()
+                , Region()
+                , Country()
+                , City()
+                , Timestamp(0)
+            {
+                Add(_T("ip"), &PublicIp);
+                Add(_T("timezone"), &TimeZone);
+                Add(_T("region"), &Region);
+                Add(_T("country"), &Country);
+                Add(_T("city"), &City);
+                Add(_T("timestamp"), &Timestamp);
+            }
+            ~Cache()
+            {
+            }
+
+        public:
+            Core::JSON::String PublicIp;
+            Core::JSON::String TimeZone;
+            Core::JSON::String Region;
+            Core::JSON::String Country;
+            Core::JSON::String City;
+            Core::JSON::DecUInt64 Timestamp;
+        };
+
         class Notification : public Core::IDispatch {
         private:
             Notification() = delete;
@@ -74,10 +108,15 @@ namespace Plugin {
 #endif
             explicit Notification(LocationSync* parent)
                 : _parent(*parent)
-                , _source()
+                , _adminLock()
+                , _sources()
                 , _interval()
                 , _retries()
+                , _racing(false)
+                , _cacheFile()
+                , _timeToLive(0)
                 , _locator(Core::Service<LocationService>::Create<LocationService>(this))
+                , _probes()
             {
                 ASSERT(parent != nullptr);
             }
@@ -86,24 +125,49 @@ namespace Plugin {
 #endif
             ~Notification()
             {
+                Deinitialize();
+
                 _locator->Release();
             }
 
         public:
-            inline void Initialize(PluginHost::IShell* service, const string& source, const uint16_t interval, const uint8_t retries)
+            inline void Initialize(PluginHost::IShell* service, const std::list<string>& sources, const uint16_t interval, const uint8_t retries, const uint32_t timeToLive)
             {
-                _source = source;
+                ASSERT(_probes.empty() == true);
+
+                _sources = sources;
                 _interval = interval;
                 _retries = retries;
+                _timeToLive = timeToLive;
+                _cacheFile = service->PersistentPath() + _T("location.json");
+
+                if ((_timeToLive != 0) && (Core::File(service->PersistentPath(), true).IsDirectory() == false)) {
+                    if (Core::Directory(service->PersistentPath().c_str()).CreatePath() == false) {
+                        TRACE(Trace::Error, (_T("Failed to create persistent storage folder [%s]"), service->PersistentPath().c_str()));
+                    }
+                }
+
+                for (uint32_t index = 0; index < _sources.size(); index++) {
+                    _probes.push_back(Core::Service<LocationService>::Create<LocationService>(this));
+                }
+
+                // Report what we knew from the last run right away, the probes will refresh it.
+                if (Load() == true) {
+                    _parent.SyncedLocation();
+                }
 
                 Probe();
             }
             inline void Deinitialize()
             {
+                for (LocationService* probe : _probes) {
+                    probe->Stop();
+                    probe->Release();
+                }
+                _probes.clear();
             }
-            uint32_t Probe(const string& remoteNode, const uint32_t retries, const uint32_t retryTimeSpan)
+            uint32_t Probe(const uint32_t retries, const uint32_t retryTimeSpan)
             {
-                _source = remoteNode;
                 _interval = retryTimeSpan;
                 _retries = retries;
 
@@ -120,25 +184,96 @@ namespace Plugin {
             }
 
         private:
-            inline uint32_t Probe()
+            // All configured sources are raced, the first one that delivers a location wins.
+            uint32_t Probe()
             {
+                uint32_t result = Core::ERROR_UNAVAILABLE;
 
-                ASSERT(_locator != nullptr);
+                _adminLock.Lock();
 
-                return (_locator != nullptr ? _locator->Probe(_source, _retries, _interval) : Core::ERROR_UNAVAILABLE);
+                _racing = true;
+
+                std::list<string>::const_iterator source(_sources.begin());
+                for (LocationService* probe : _probes) {
+                    uint32_t status = probe->Probe(*source, _retries, _interval);
+
+                    if ((result != Core::ERROR_NONE) && (status != Core::ERROR_UNAVAILABLE)) {
+                        result = status;
+                    }
+                    source++;
+                }
+
+                _adminLock.Unlock();
+
+                return (result);
             }
 
             virtual void Dispatch()
             {
-                _parent.SyncedLocation();
+                LocationService* winner = nullptr;
+                bool report = false;
+
+                _adminLock.Lock();
+
+                if (_racing == true) {
+                    std::list<LocationService*>::iterator index(_probes.begin());
+
+                    while ((index != _probes.end()) && ((*index)->IsLoaded() == false)) {
+                        index++;
+                    }
+
+                    if (index != _probes.end()) {
+                        winner = (*index);
+                        _racing = false;
+                        report = true;
+
+                        _locator->Update(winner->PublicIPAddress(), winner->TimeZone(), winner->Country(), winner->Region(), winner->City());
+                    } else {
+                        index = _probes.begin();
+
+                        while ((index != _probes.end()) && ((*index)->IsFailed() == true)) {
+                            index++;
+                        }
+
+                        if (index == _probes.end()) {
+                            // Nobody could get us a location. If we reported a cached one, stick to it.
+                            _racing = false;
+                            report = (_locator->IsLoaded() == false);
+                        }
+                    }
+                }
+
+                _adminLock.Unlock();
+
+                if (winner != nullptr) {
+                    for (LocationService* probe : _probes) {
+                        if (probe != winner) {
+                            probe->Stop();
+                        }
+                    }
+
+                    Save();
+                }
+
+                if (report == true) {
+                    _parent.SyncedLocation();
+                }
             }
 
+            bool Load();
+            void Save() const;
+
         private:
             LocationSync& _parent;
-            string _source;
+            Core::CriticalSection _adminLock;
+            std::list<string> _sources;
             uint16_t _interval;
             uint8_t _retries;
+            bool _racing;
+            string _cacheFile;
+            uint32_t _timeToLive;
             LocationService* _locator;
+            std::list<LocationService*> _probes;
         };
 
         class Config : public Core::JSON::Container {
@@ -151,10 +286,14 @@ namespace Plugin {
                 : Interval(30)
                 , Retries(8)
                 , Source()
+                , Sources()
+                , TimeToLive(24 * 60 * 60)
             {
                 Add(_T("interval"), &Interval);
                 Add(_T("retries"), &Retries);
                 Add(_T("source"), &Source);
+                Add(_T("sources"), &Sources);
+                Add(_T("ttl"), &TimeToLive);
             }
             ~Config()
             {
@@ -164,6 +303,8 @@ namespace Plugin {
             Core::JSON::DecUInt16 Interval;
             Core::JSON::DecUInt8 Retries;
             Core::JSON::String Source;
+            Core::JSON::ArrayType<Core::JSON::String> Sources;
+            Core::JSON::DecUInt32 TimeToLive;
         };
 
     private:
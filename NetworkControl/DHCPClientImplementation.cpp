@@ -42,9 +42,12 @@ namespace Plugin {
         , _adminLock()
         , _interfaceName(interfaceName)
         , _state(IDLE)
+        , _modus(CLASSIFICATION_INVALID)
+        , _request(REQUEST_SELECTING)
         , _serverIdentifier(0)
         , _xid(0)
         , _preferred()
+        , _ciaddr()
         , _discoverCallback(discoverCallback)
         , _claimCallback(claimCallback)
         , _unleasedOffers()
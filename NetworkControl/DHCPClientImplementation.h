@@ -40,6 +40,14 @@ namespace Plugin {
             CLASSIFICATION_INFORM = 8,
         };
 
+        // RFC 2131 section 4.3.2, the client state determines how a REQUEST is composed.
+        enum requests {
+            REQUEST_SELECTING,
+            REQUEST_INIT_REBOOT,
+            REQUEST_RENEWING,
+            REQUEST_REBINDING
+        };
+
     private:
         DHCPClientImplementation() = delete;
         DHCPClientImplementation(const DHCPClientImplementation&) = delete;
@@ -300,6 +308,7 @@ namespace Plugin {
                     , leaseTime()
                     , renewalTime()
                     , rebindingTime()
+                    , acquired()
                 {
                     Add("source", &source);
                     Add("offer", &offer);
@@ -310,6 +319,7 @@ namespace Plugin {
                     Add("leaseTime", &leaseTime);
                     Add("renewalTime", &renewalTime);
                     Add("rebindingTime", &rebindingTime);
+                    Add("acquired", &acquired);
                 }
 
                 JSON(Offer& object) 
@@ -323,6 +333,7 @@ namespace Plugin {
                     Add("leaseTime", &leaseTime);
                     Add("renewalTime", &renewalTime);
                     Add("rebindingTime", &rebindingTime);
+                    Add("acquired", &acquired);
 
                     Set(object);
                 }
@@ -337,6 +348,7 @@ namespace Plugin {
                     , leaseTime(copy.leaseTime)
                     , renewalTime(copy.renewalTime)
                     , rebindingTime(copy.rebindingTime)
+                    , acquired(copy.acquired)
                 {
                     Add("source", &source);
                     Add("offer", &offer);
@@ -347,6 +359,7 @@ namespace Plugin {
                     Add("leaseTime", &leaseTime);
                     Add("renewalTime", &renewalTime);
                     Add("rebindingTime", &rebindingTime);
+                    Add("acquired", &acquired);
                 }
 
                 void Set(Offer& object) {
@@ -365,6 +378,7 @@ namespace Plugin {
                     leaseTime = object._leaseTime;
                     renewalTime = object._renewalTime;
                     rebindingTime = object._rebindingTime;
+                    acquired = object._acquired;
                 }
 
                 Offer Get() {
@@ -383,6 +397,7 @@ namespace Plugin {
                     result._leaseTime = leaseTime.Value();
                     result._renewalTime = renewalTime.Value();
                     result._rebindingTime = rebindingTime.Value();
+                    result._acquired = acquired.Value();
 
                     return result;
                 }
@@ -398,6 +413,7 @@ namespace Plugin {
                 Core::JSON::DecUInt32 leaseTime;
                 Core::JSON::DecUInt32 renewalTime;
                 Core::JSON::DecUInt32 rebindingTime;
+                Core::JSON::DecUInt64 acquired;
             };
         public:
             Offer()
@@ -410,6 +426,7 @@ namespace Plugin {
                 , _leaseTime(0)
                 , _renewalTime(0)
                 , _rebindingTime(0)
+                , _acquired(0)
             {
                 Crypto::Random(_id);
             }
@@ -423,6 +440,7 @@ namespace Plugin {
                 , _leaseTime(0)
                 , _renewalTime(0)
                 , _rebindingTime(0)
+                , _acquired(0)
             {
                 _source = frame.siaddr;
                 _offer = frame.yiaddr;
@@ -440,6 +458,7 @@ namespace Plugin {
                 , _leaseTime(copy._leaseTime)
                 , _renewalTime(copy._renewalTime)
                 , _rebindingTime(copy._rebindingTime)
+                , _acquired(copy._acquired)
                 , _id(copy._id)
             {
             }
@@ -509,6 +528,7 @@ namespace Plugin {
                 _leaseTime = rhs._leaseTime;
                 _renewalTime = rhs._renewalTime;
                 _rebindingTime = rhs._rebindingTime;
+                _acquired = rhs._acquired;
                 _id = rhs._id;
 
                 return (*this);
@@ -559,8 +579,43 @@ namespace Plugin {
             {
                 return (_rebindingTime);
             }
+            uint64_t Acquired() const
+            {
+                return (_acquired);
+            }
+            void Acquired(const uint64_t ticks)
+            {
+                _acquired = ticks;
+            }
+            // RFC 2131 section 4.4.5, if the server did not pass the timers, T1 is at 50% and
+            // T2 at 87.5% of the lease. All these return 0 if there is no (finite) lease.
+            uint64_t Expiry() const
+            {
+                return (HasFiniteLease() == true ? _acquired + Seconds(_leaseTime) : 0);
+            }
+            uint64_t Renewal() const
+            {
+                return (HasFiniteLease() == true ? _acquired + Seconds(_renewalTime != 0 ? _renewalTime : (_leaseTime / 2)) : 0);
+            }
+            uint64_t Rebinding() const
+            {
+                return (HasFiniteLease() == true ? _acquired + Seconds(_rebindingTime != 0 ? _rebindingTime : ((_leaseTime / 8) * 7)) : 0);
+            }
+            bool IsLeaseValid() const
+            {
+                return ((_acquired != 0) && ((HasFiniteLease() == false) || (Expiry() > Core::Time::Now().Ticks())));
+            }
+            inline bool HasFiniteLease() const
+            {
+                return ((_acquired != 0) && (_leaseTime != 0) && (_leaseTime != static_cast<uint32_t>(~0)));
+            }
 
         private:
+            static inline uint64_t Seconds(const uint32_t seconds)
+            {
+                return (static_cast<uint64_t>(seconds) * 1000 * Core::Time::TicksPerMillisecond);
+            }
+
             Core::NodeId _source; /* address of DHCP server that sent this offer */
             Core::NodeId _offer; /* the IP address that was offered to us */
             Core::NodeId _gateway; /* the IP address that was offered to us */
@@ -570,6 +625,7 @@ namespace Plugin {
             uint32_t _leaseTime; /* lease time in seconds */
             uint32_t _renewalTime; /* renewal time in seconds */
             uint32_t _rebindingTime; /* rebinding time in seconds */
+            uint64_t _acquired; /* moment the lease was acknowledged, 0 if never leased */
             uint32_t _id; /* unique offer identifier */
         };
 
@@ -624,11 +680,13 @@ namespace Plugin {
                     _unleasedOffers.clear();
 
                     SocketDatagram::Broadcast(true);
+                    SocketDatagram::RemoteNode(Core::NodeId(_T("255.255.255.255"), DefaultDHCPServerPort));
                     
                     Crypto::Random(_discoverXID);
                     _state = SENDING;
                     _modus = CLASSIFICATION_DISCOVER;
                     _preferred = preferredAddres;
+                    _ciaddr = Core::NodeId();
                     _xid = _discoverXID;
                     result = Core::ERROR_NONE;
 
@@ -646,7 +704,7 @@ namespace Plugin {
             return (result);
         }
 
-        uint32_t Request(const Offer& offer) {
+        uint32_t Request(const Offer& offer, const requests type = REQUEST_SELECTING) {
 
             uint32_t result = Core::ERROR_INPROGRESS;
 
@@ -660,11 +718,34 @@ namespace Plugin {
                     TRACE(Trace::Information, ("Sending REQUEST for %s", offer.Address().HostAddress().c_str()));
                     _state = SENDING;
                     _modus = CLASSIFICATION_REQUEST;
-                    _preferred = offer.Address();
+                    _request = type;
+                    _serverIdentifier = 0;
                     // Use offer id as transaction id to pair request with correct response
                     _xid = offer.Id(); 
 
-                    if (offer.Source().IsEmpty() == false) {
+                    if ((type == REQUEST_RENEWING) || (type == REQUEST_REBINDING)) {
+                        // We own the address, it goes in ciaddr and the requested IP option must not be filled.
+                        _preferred = Core::NodeId();
+                        _ciaddr = offer.Address();
+                    } else {
+                        _preferred = offer.Address();
+                        _ciaddr = Core::NodeId();
+                    }
+
+                    // The ACK is matched against the pending offers, make sure a lease we held is amongst them.
+                    if ((type != REQUEST_SELECTING) && (std::find_if(_unleasedOffers.begin(), _unleasedOffers.end(), [&offer](const Offer& o) { return o.Id() == offer.Id(); }) == _unleasedOffers.end())) {
+                        _unleasedOffers.push_back(offer);
+                    }
+
+                    if ((type == REQUEST_RENEWING) && (offer.Source().IsEmpty() == false)) {
+                        // Renewals are unicasted to the server that granted the lease.
+                        SocketDatagram::RemoteNode(Core::NodeId(offer.Source().HostAddress().c_str(), DefaultDHCPServerPort));
+                    } else {
+                        SocketDatagram::RemoteNode(Core::NodeId(_T("255.255.255.255"), DefaultDHCPServerPort));
+                    }
+
+                    // The server identifier is only allowed when selecting an offer (not for INIT-REBOOT)
+                    if ((type == REQUEST_SELECTING) && (offer.Source().IsEmpty() == false)) {
                         auto addr = reinterpret_cast<const sockaddr_in*>(static_cast<const struct sockaddr*>(offer.Source()));
                         
                         memcpy(&_serverIdentifier, &(addr->sin_addr), 4);
@@ -793,6 +874,7 @@ namespace Plugin {
             _adminLock.Lock();
 
             _leasedOffer = offer;
+            _leasedOffer.Acquired(Core::Time::Now().Ticks());
             _unleasedOffers.remove_if([offer] (Offer& o) {return o.Id() == offer.Id();}); 
             
             _adminLock.Unlock();
@@ -825,8 +907,15 @@ namespace Plugin {
             /*discover_packet.secs=htons(65535);*/
             frame.secs = 0xFF;
 
-            /* tell server it should broadcast its response */
-            frame.flags = htons(BroadcastValue);
+            /* tell server it should broadcast its response, unless we extend a lease: we own the address then (RFC 2131 4.4.5) */
+            const bool extending((_modus == CLASSIFICATION_REQUEST) && ((_request == REQUEST_RENEWING) || (_request == REQUEST_REBINDING)));
+            frame.flags = (extending == true ? 0 : htons(BroadcastValue));
+
+            /* our current address, if we are extending a lease (RENEWING/REBINDING) */
+            if ((_ciaddr.Type() == Core::NodeId::TYPE_IPV4) && (_ciaddr.IsEmpty() == false)) {
+                const struct sockaddr_in* data(reinterpret_cast<const struct sockaddr_in*>(static_cast<const struct sockaddr*>(_ciaddr)));
+                frame.ciaddr = data->sin_addr;
+            }
 
             /* our hardware address */
             ::memcpy(frame.chaddr, _MAC, frame.hlen);
@@ -949,11 +1038,13 @@ namespace Plugin {
         string _interfaceName;
         state _state;
         classifications _modus;
+        requests _request;
         uint8_t _MAC[6];
         mutable uint32_t _serverIdentifier;
         mutable uint32_t _xid;
         mutable uint32_t _discoverXID;
         Core::NodeId _preferred;
+        Core::NodeId _ciaddr;
         DiscoverCallback _discoverCallback;
         RequestCallback _claimCallback;
         std::list<Offer> _unleasedOffers;
@@ -130,39 +130,38 @@ namespace Plugin
         }
 
         Core::JSON::ArrayType<Entry>::Iterator index(config.Interfaces.Elements());
+        std::list<Entry> pending;
 
         while (index.Next() == true) {
             if (index.Current().Interface.IsSet() == true) {
-                string interfaceName(index.Current().Interface.Value());
-                Core::AdapterIterator adapter;
-                uint8_t retries = (_responseTime * 2);
-
-                // Some interfaces take some time, to be available. Wait a certain amount
-                // of time in which the interface should come up.
-                do {
-                    adapter = Core::AdapterIterator(interfaceName);
+                pending.push_back(index.Current());
+            }
+        }
 
-                    if (adapter.IsValid() == false) {
-                        Core::AdapterIterator::Flush();
-                        SleepMs(500);
-                    }
+        // Some interfaces take some time, to be available. Wait a certain amount of time in
+        // which the interfaces should come up. Bring up each interface as soon as it shows up,
+        // the DHCP negotiations run asynchronously, so interfaces are configured in parallel.
+        uint8_t retries = (_responseTime * 2);
 
-                } while ((retries-- != 0) && (adapter.IsValid() == false));
+        while (pending.empty() == false) {
+            std::list<Entry>::iterator entry(pending.begin());
 
-                if (adapter.IsValid() == false) {
-                    SYSLOG(Logging::Startup, (_T("Interface [%s], not available"), interfaceName.c_str()));
-                } else {
+            while (entry != pending.end()) {
+                string interfaceName(entry->Interface.Value());
+                Core::AdapterIterator adapter(interfaceName);
 
+                if (adapter.IsValid() == true) {
                     adapter.Up(true);
 
                     auto dhcpInterface = _dhcpInterfaces.emplace(std::piecewise_construct,
                         std::make_tuple(interfaceName),
                         std::make_tuple(Core::ProxyType<DHCPEngine>::Create(this, interfaceName, _persistentStoragePath)));
-                    _interfaces.emplace(std::piecewise_construct,
+                    auto info = _interfaces.emplace(std::piecewise_construct,
                         std::make_tuple(interfaceName),
-                        std::make_tuple(index.Current()));
+                        std::make_tuple(*entry));
+                    info.first->second.Linked((adapter.IsRunning() == true) && (adapter.IsUp() == true));
 
-                    JsonData::NetworkControl::NetworkData::ModeType how(index.Current().Mode);
+                    JsonData::NetworkControl::NetworkData::ModeType how(entry->Mode);
                     if (how == JsonData::NetworkControl::NetworkData::ModeType::MANUAL) {
                         SYSLOG(Logging::Startup, (_T("Interface [%s] activated, no IP associated"), interfaceName.c_str()));
                     } else {
@@ -178,6 +177,22 @@ namespace Plugin
                             Reload(interfaceName, false);
                         }
                     }
+
+                    entry = pending.erase(entry);
+                } else {
+                    entry++;
+                }
+            }
+
+            if (pending.empty() == false) {
+                if (retries-- == 0) {
+                    for (const Entry& missing : pending) {
+                        SYSLOG(Logging::Startup, (_T("Interface [%s], not available"), missing.Interface.Value().c_str()));
+                    }
+                    pending.clear();
+                } else {
+                    Core::AdapterIterator::Flush();
+                    SleepMs(500);
                 }
             }
         }
@@ -235,6 +250,7 @@ namespace Plugin
         }
 
         _dns.clear();
+        _dnsSection.clear();
         _dhcpInterfaces.clear();
         _interfaces.clear();
         _service = nullptr;
@@ -392,24 +408,14 @@ namespace Plugin
                     ClearAssignedIPV4IPs(adapter);
                     addIt = true;
                 } else {
-                    Core::IPV4AddressIterator checker(adapter.IPV4Addresses());
-                    while ((checker.Next() == true) && (checker.Address() != ipAddress)) {   
-                        /* INTENTINALLY LEFT EMPTY */
-                    }
-
-                    addIt = (checker.IsValid() == false);
+                    addIt = (IsAssigned(adapter, ipAddress) == false);
                 }
             } else if (ipAddress.Type() == Core::NodeId::TYPE_IPV6) {
                 if (clearOld == true) {
                     ClearAssignedIPV6IPs(adapter);
                     addIt = true;
                 } else {
-                    Core::IPV6AddressIterator checker(adapter.IPV6Addresses());
-                    while ((checker.Next() == true) && (checker.Address() != ipAddress)) {   
-                        /* INTENTINALLY LEFT EMPTY */
-                    }
-
-                    addIt = (checker.IsValid() == false);
+                    addIt = (IsAssigned(adapter, ipAddress) == false);
                 }
             }
 
@@ -504,6 +510,70 @@ namespace Plugin
         return result;
     }
 
+    void NetworkControl::DHCPEngine::ScheduleRenewal(const DHCPClientImplementation::Offer& offer)
+    {
+        const uint64_t renewal = offer.Renewal();
+
+        if (renewal != 0) {
+            Core::ProxyType<Core::IDispatch> job(*this);
+
+            TRACE(Trace::Information, (_T("Lease for %s on [%s] will be renewed in %d seconds"), offer.Address().HostAddress().c_str(), _client.Interface().c_str(), offer.RenewalTime() != 0 ? offer.RenewalTime() : offer.LeaseTime() / 2));
+            Core::IWorkerPool::Instance().Schedule(Core::Time(renewal), job);
+        }
+    }
+
+    void NetworkControl::DHCPEngine::Lease()
+    {
+        const DHCPClientImplementation::Offer leased(_client.LeasedOffer());
+        const uint64_t now = Core::Time::Now().Ticks();
+
+        if ((leased.IsLeaseValid() == true) && (leased.HasFiniteLease() == false)) {
+            // An infinite lease is never renewed, Expiry() is 0 for it.
+            TRACE(Trace::Information, (_T("Lease for %s on [%s] does not expire"), leased.Address().HostAddress().c_str(), _client.Interface().c_str()));
+        } else if (leased.Expiry() <= now) {
+            // Nobody extended our lease, start over, but try to hold on to the same address.
+            TRACE(Trace::Information, (_T("Lease for %s on [%s] expired"), leased.Address().HostAddress().c_str(), _client.Interface().c_str()));
+            Discover(leased.Address());
+        } else if (now < leased.Renewal()) {
+            // Too early, somebody triggered us before T1.
+            Core::ProxyType<Core::IDispatch> job(*this);
+            Core::IWorkerPool::Instance().Schedule(Core::Time(leased.Renewal()), job);
+        } else {
+            uint64_t deadline;
+            Core::ProxyType<Core::IDispatch> job(*this);
+
+            if (now >= leased.Rebinding()) {
+                // T2 passed, our server is gone, ask any server on the segment.
+                deadline = leased.Expiry();
+
+                if (_phase != REBINDING) {
+                    _phase = REBINDING;
+                    _client.Request(leased, DHCPClientImplementation::REQUEST_REBINDING);
+                } else {
+                    _client.Resend();
+                }
+            } else {
+                // T1 passed, ask the server that granted the lease.
+                deadline = leased.Rebinding();
+
+                if (_phase != RENEWING) {
+                    _phase = RENEWING;
+                    _client.Request(leased, DHCPClientImplementation::REQUEST_RENEWING);
+                } else {
+                    _client.Resend();
+                }
+            }
+
+            // Retransmit every response time, but always wake up on the next boundary.
+            Core::Time entry(Core::Time::Now().Add(_parent.ResponseTime() * 1000));
+            if (entry.Ticks() > deadline) {
+                entry = Core::Time(deadline);
+            }
+
+            Core::IWorkerPool::Instance().Schedule(entry, job);
+        }
+    }
+
     uint32_t NetworkControl::Reload(const string& interfaceName, const bool dynamic)
     {
 
@@ -691,25 +761,29 @@ namespace Plugin
                 bool update = false;
                 _adminLock.Lock();
 
-                // First add all new entries.
-                DHCPClientImplementation::Offer::DnsIterator servers(offer.DNS());
+                // First remove all old ones.
+                DHCPClientImplementation::Offer::DnsIterator servers(info->second.Offer().DNS());
                 while (servers.Next() == true) {
-                    update = AddDNSEntry(_dns, servers.Current()) | update;
+                    update = RemoveDNSEntry(_dns, servers.Current()) | update;
                 }
 
-                // Than remove all old ones.
-                servers = info->second.Offer().DNS();
+                // Than add all new entries.
+                servers = offer.DNS();
                 while (servers.Next() == true) {
-                    update = RemoveDNSEntry(_dns, servers.Current()) | update;
+                    update = AddDNSEntry(_dns, servers.Current()) | update;
                 }
 
+                // A renewed or re-confirmed lease keeps the address, no need to flush the interface.
+                const bool renewed = (info->second.Offer().Address() == offer.Address());
+                info->second.Offer(offer);
+
                 _adminLock.Unlock();
 
                 if (update == true) {
                     RefreshDNS();
                 }
 
-                SetIP(adapter, Core::IPNode(offer.Address(), offer.Netmask()), offer.Gateway(), offer.Broadcast(), true);
+                SetIP(adapter, Core::IPNode(offer.Address(), offer.Netmask()), offer.Gateway(), offer.Broadcast(), !renewed);
                 
                 // Update leases file
                 entry->second->SaveLeases();
@@ -768,78 +842,83 @@ namespace Plugin
 
     void NetworkControl::RefreshDNS()
     {
-        Core::DataElementFile file(_dnsFile, Core::File::SHAREABLE|Core::File::USER_READ|Core::File::USER_WRITE|Core::File::USER_EXECUTE|Core::File::GROUP_READ|Core::File::GROUP_WRITE, 0);
+        const string startMarker((_T("#++SECTION: ")) + _service->Callsign() + '\n');
+        const string endMarker((_T("#--SECTION: ")) + _service->Callsign() + '\n');
+        string section(startMarker);
 
-        if (file.IsValid() == false) {
-            SYSLOG(Logging::Startup, (_T("DNS functionality could NOT be updated [%s]"), _dnsFile.c_str()));
-        } else {
-            string data((_T("#++SECTION: ")) + _service->Callsign() + '\n');
-            string endMarker((_T("#--SECTION: ")) + _service->Callsign() + '\n');
-            uint16_t start = 0;
-            uint16_t end = 0;
-            uint16_t offset = 1;
-            uint8_t index = 0;
-
-            do {
-                index += offset - 1;
-                offset = 0;
-
-                // Find the first comparible character && check the remainder in the next step...
-                while ((index < file.Size()) && (file[index] != data[offset])) {
-                    index++;
-                }
-                while ((index < file.Size()) && (offset < data.length()) && (file[index] == data[offset])) {
-                    index++;
-                    offset++;
-                }
+        _adminLock.Lock();
+
+        std::list<std::pair<uint16_t, Core::NodeId>>::const_iterator pointer(_dns.begin());
 
-            } while ((index < file.Size()) && (offset != data.length()));
+        while (pointer != _dns.end()) {
+            section += string(NAMESERVER, sizeof(NAMESERVER) - 1) + pointer->second.HostAddress() + '\n';
+            pointer++;
+        }
 
-            start = index - offset;
-            offset = 1;
+        section += endMarker;
 
-            do {
-                index += offset - 1;
-                offset = 0;
+        // Resolvers re-read the file on every change, so do not touch it if nothing changed.
+        const bool changed = (section != _dnsSection);
 
-                // Find the first comparible character && check the remainder in the next step...
-                while ((index < file.Size()) && (file[index] != endMarker[offset])) {
-                    index++;
-                }
-                while ((index < file.Size()) && (offset < endMarker.length()) && (file[index] == endMarker[offset])) {
-                    index++;
-                    offset++;
-                }
+        _adminLock.Unlock();
 
-            } while ((index < file.Size()) && (offset != endMarker.length()));
+        if (changed == true) {
+            string content;
+            Core::File file(_dnsFile, true);
 
-            end = index;
-            uint16_t reduction = end - start;
+            if (file.Open(true) == true) {
+                uint8_t buffer[512];
+                uint32_t loaded;
 
-            if (reduction != 0) {
-                // move everything after de marker, over the marker sections.
-                ::memcpy(&(file[start]), &file[end], static_cast<uint16_t>(file.Size()) - end);
+                while ((loaded = file.Read(buffer, sizeof(buffer))) != 0) {
+                    content.append(reinterpret_cast<const char*>(buffer), loaded);
+                }
+                file.Close();
             }
 
-            offset = (static_cast<uint16_t>(file.Size()) - reduction);
+            // Replace our own section, leave the rest of the file as is.
+            size_t start = content.find(startMarker);
 
-            _adminLock.Lock();
+            if (start != string::npos) {
+                size_t end = content.find(endMarker, start);
+                content.erase(start, (end == string::npos ? content.length() : end + endMarker.length()) - start);
+                content.insert(start, section);
+            } else {
+                content += section;
+            }
 
-            std::list<std::pair<uint16_t, Core::NodeId>>::const_iterator pointer(_dns.begin());
+            // Write a new file and swap it in, so readers never see a half written file.
+            const string temporary(_dnsFile + _T(".tmp"));
+            Core::File newFile(temporary, false);
+            bool written = false;
 
-            while (pointer != _dns.end()) {
-                data += string(NAMESERVER, sizeof(NAMESERVER) - 1) + pointer->second.HostAddress() + '\n';
-                pointer++;
+            if ((newFile.Create() == true) && (newFile.Write(reinterpret_cast<const uint8_t*>(content.c_str()), static_cast<uint32_t>(content.length())) == content.length())) {
+                newFile.Close();
+                ::chmod(temporary.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+                written = (::rename(temporary.c_str(), _dnsFile.c_str()) == 0);
             }
 
-            _adminLock.Unlock();
+            if (written == false) {
+                // Could be a bind mount or a read-only directory, fall back to rewriting in place.
+                newFile.Destroy();
+
+                Core::File target(_dnsFile, false);
+
+                if ((target.Create() == true) && (target.Write(reinterpret_cast<const uint8_t*>(content.c_str()), static_cast<uint32_t>(content.length())) == content.length())) {
+                    written = true;
+                }
+                target.Close();
+            }
 
-            data += endMarker;
-            file.Size(offset + data.length());
-            ::memcpy(&(file[offset]), data.c_str(), data.length());
-            file.Sync();
+            if (written == false) {
+                SYSLOG(Logging::Startup, (_T("DNS functionality could NOT be updated [%s]"), _dnsFile.c_str()));
+            } else {
+                _adminLock.Lock();
+                _dnsSection = section;
+                _adminLock.Unlock();
 
-            SYSLOG(Logging::Startup, (_T("DNS functionality updated [%s]"), _dnsFile.c_str()));
+                SYSLOG(Logging::Startup, (_T("DNS functionality updated [%s]"), _dnsFile.c_str()));
+            }
         }
     }
 
@@ -874,21 +953,49 @@ namespace Plugin
                 TRACE(Trace::Information, (_T("Updated interface: %s"), interfaceName.c_str()));
             }
 
-            if ((adapter.IsRunning() == true) && (adapter.IsUp() == true)) {
-                std::map<const string, StaticInfo>::iterator index(_interfaces.find(interfaceName));
+            const bool linked = ((adapter.IsRunning() == true) && (adapter.IsUp() == true));
+            std::map<const string, StaticInfo>::iterator index(_interfaces.find(interfaceName));
+
+            ASSERT(index != _interfaces.end());
 
-                if (index != _interfaces.end()) {
+            JsonData::NetworkControl::NetworkData::ModeType how(index->second.Mode());
 
-                    JsonData::NetworkControl::NetworkData::ModeType how(index->second.Mode());
+            if (index->second.Linked() != linked) {
+                // The link changed, this is the only reason to (re)configure the interface.
+                index->second.Linked(linked);
+
+                if (linked == true) {
                     if (how != JsonData::NetworkControl::NetworkData::ModeType::MANUAL) {
                         Reload(interfaceName, how == JsonData::NetworkControl::NetworkData::ModeType::DYNAMIC);
                     }
+                } else {
+                    std::map<const string, Core::ProxyType<DHCPEngine>>::iterator dhcp(_dhcpInterfaces.find(interfaceName));
+                    if (dhcp != _dhcpInterfaces.end()) {
+                        // No use in talking DHCP on a dead link, the lease is re-confirmed once it returns.
+                        dhcp->second->CleanUp();
+                    }
+
+                    ClearAssignedIPV4IPs(adapter);
+                    ClearAssignedIPV6IPs(adapter);
+
+                    Core::AdapterIterator::Flush();
                 }
-            } else {
-                ClearAssignedIPV4IPs(adapter);
-                ClearAssignedIPV6IPs(adapter);
+            } else if (linked == true) {
+                // Only addresses or routes changed. Just restore what we own, if it went missing. Our
+                // own SetIP() raises these events too, so leave the adapter alone while our address
+                // is still there.
+                if (how == JsonData::NetworkControl::NetworkData::ModeType::STATIC) {
+                    if (IsAssigned(adapter, index->second.Address()) == false) {
+                        SetIP(adapter, index->second.Address(), index->second.Gateway(), index->second.Broadcast());
+                    }
+                } else if ((how == JsonData::NetworkControl::NetworkData::ModeType::DYNAMIC) && (index->second.Offer().IsValid() == true)) {
+                    const DHCPClientImplementation::Offer& offer(index->second.Offer());
+                    const Core::IPNode address(offer.Address(), offer.Netmask());
 
-                Core::AdapterIterator::Flush();
+                    if (IsAssigned(adapter, address) == false) {
+                        SetIP(adapter, address, offer.Gateway(), offer.Broadcast());
+                    }
+                }
             }
 
             _adminLock.Unlock();
@@ -937,6 +1044,29 @@ namespace Plugin
         }
     }
 
+    /* static */ bool NetworkControl::IsAssigned(Core::AdapterIterator& adapter, const Core::IPNode& ipAddress)
+    {
+        bool result = false;
+
+        if (ipAddress.Type() == Core::NodeId::TYPE_IPV4) {
+            Core::IPV4AddressIterator checker(adapter.IPV4Addresses());
+            while ((checker.Next() == true) && (checker.Address() != ipAddress)) {
+                /* INTENTINALLY LEFT EMPTY */
+            }
+
+            result = checker.IsValid();
+        } else if (ipAddress.Type() == Core::NodeId::TYPE_IPV6) {
+            Core::IPV6AddressIterator checker(adapter.IPV6Addresses());
+            while ((checker.Next() == true) && (checker.Address() != ipAddress)) {
+                /* INTENTINALLY LEFT EMPTY */
+            }
+
+            result = checker.IsValid();
+        }
+
+        return (result);
+    }
+
 
 } // namespace Plugin
 } // namespace WPEFramework
@@ -125,6 +125,7 @@ namespace Plugin {
                 , _adminLock()
                 , _observer(this)
                 , _reporting()
+                , _scheduled(0)
             {
                 ASSERT(parent != nullptr);
             }
@@ -150,51 +151,119 @@ namespace Plugin {
                 Core::IWorkerPool::Instance().Revoke(job);
 
                 _reporting.clear();
+                _scheduled = 0;
 
                 _adminLock.Unlock();
             }
             virtual void Event(const string& interface) override
             {
+                const uint64_t now = Core::Time::Now().Ticks();
 
                 _adminLock.Lock();
 
-                if (std::find(_reporting.begin(), _reporting.end(), interface) == _reporting.end()) {
-                    // We need to add this interface, it is currently not present.
-                    _reporting.push_back(interface);
+                // These events tend to "dender" a lot, especially on link flaps. Only act on an
+                // interface once it has been quiet for SettleTime, but never hold off longer
+                // than MaxHoldOff.
+                std::map<string, Pending>::iterator index(_reporting.find(interface));
 
-                    // If this is the first entry, we need to submit a job for processing
-                    if (_reporting.size() == 1) {
-                        // These events tend to "dender" a lot. Give it some time
-                        Core::Time entry(Core::Time::Now().Add(100));
-                        Core::ProxyType<Core::IDispatch> job(*this);
+                if (index == _reporting.end()) {
+                    _reporting.emplace(std::piecewise_construct,
+                        std::forward_as_tuple(interface),
+                        std::forward_as_tuple(now));
+                } else {
+                    index->second.Touch(now);
+                }
 
-                        Core::IWorkerPool::Instance().Schedule(entry, job);
-                    }
+                // Anything due is always later than the earliest job already scheduled.
+                if (_scheduled == 0) {
+                    Schedule(now + (SettleTime * Core::Time::TicksPerMillisecond));
                 }
 
                 _adminLock.Unlock();
             }
             virtual void Dispatch() override
             {
-                // Yippie a yee, we have an interface notification:
+                // Yippie a yee, we have interface notifications:
                 _adminLock.Lock();
-                while (_reporting.size() != 0) {
-                    const string interfaceName(_reporting.front());
-                    _reporting.pop_front();
-                    _adminLock.Unlock();
 
-                    _parent.Activity(interfaceName);
+                _scheduled = 0;
+
+                std::map<string, Pending>::iterator index(_reporting.begin());
+                while (index != _reporting.end()) {
+                    if (index->second.Due() > Core::Time::Now().Ticks()) {
+                        index++;
+                    } else {
+                        const string interfaceName(index->first);
+                        _reporting.erase(index);
+                        _adminLock.Unlock();
+
+                        _parent.Activity(interfaceName);
+
+                        _adminLock.Lock();
+                        index = _reporting.begin();
+                    }
+                }
 
-                    _adminLock.Lock();
+                // Still flapping ones, come back when the first one settled.
+                if ((_reporting.empty() == false) && (_scheduled == 0)) {
+                    uint64_t due = _reporting.begin()->second.Due();
+                    for (const std::pair<const string, Pending>& entry : _reporting) {
+                        due = std::min(due, entry.second.Due());
+                    }
+                    Schedule(due);
                 }
+
                 _adminLock.Unlock();
             }
 
+        private:
+            static constexpr uint16_t SettleTime = 250; // ms
+            static constexpr uint16_t MaxHoldOff = 2000; // ms
+
+            class Pending {
+            public:
+                Pending() = delete;
+                Pending(const Pending&) = delete;
+                Pending& operator=(const Pending&) = delete;
+
+                Pending(const uint64_t now)
+                    : _first(now)
+                    , _due(now + (SettleTime * Core::Time::TicksPerMillisecond))
+                {
+                }
+                ~Pending()
+                {
+                }
+
+            public:
+                void Touch(const uint64_t now)
+                {
+                    _due = std::min(now + (SettleTime * Core::Time::TicksPerMillisecond), _first + (MaxHoldOff * Core::Time::TicksPerMillisecond));
+                }
+                uint64_t Due() const
+                {
+                    return (_due);
+                }
+
+            private:
+                uint64_t _first;
+                uint64_t _due;
+            };
+
+            void Schedule(const uint64_t due)
+            {
+                Core::ProxyType<Core::IDispatch> job(*this);
+
+                _scheduled = due;
+                Core::IWorkerPool::Instance().Schedule(Core::Time(due), job);
+            }
+
         private:
             NetworkControl& _parent;
             Core::CriticalSection _adminLock;
             Core::AdapterObserver _observer;
-            std::list<string> _reporting;
+            std::map<string, Pending> _reporting;
+            uint64_t _scheduled;
         };
 
         class Config : public Core::JSON::Container {
@@ -242,6 +311,8 @@ namespace Plugin {
                 , _address()
                 , _gateway()
                 , _broadcast()
+                , _offer()
+                , _linked(false)
             {
             }
             StaticInfo(const Entry& info)
@@ -249,6 +320,8 @@ namespace Plugin {
                 , _address(Core::IPNode(Core::NodeId(info.Address.Value().c_str()), info.Mask.Value()))
                 , _gateway(Core::NodeId(info.Gateway.Value().c_str()))
                 , _broadcast(info.Broadcast())
+                , _offer()
+                , _linked(false)
             {
             }
             StaticInfo(const StaticInfo& copy)
@@ -256,6 +329,8 @@ namespace Plugin {
                 , _address(copy._address)
                 , _gateway(copy._gateway)
                 , _broadcast(copy._broadcast)
+                , _offer(copy._offer)
+                , _linked(copy._linked)
             {
             }
             ~StaticInfo()
@@ -287,6 +362,15 @@ namespace Plugin {
             {
                 _offer = offer;
             }
+            // Last link state (up and running) we acted upon.
+            inline bool Linked() const
+            {
+                return (_linked);
+            }
+            inline void Linked(const bool linked)
+            {
+                _linked = linked;
+            }
             inline void Store(Entry& info)
             {
                 info.Mode = _mode;
@@ -302,9 +386,22 @@ namespace Plugin {
             Core::NodeId _gateway;
             Core::NodeId _broadcast;
             DHCPClientImplementation::Offer _offer;
+            bool _linked;
         };
         class DHCPEngine : public Core::IDispatch {
         private:
+            // Answering an INIT-REBOOT is cheap for a server, if it does not come quickly,
+            // it will not come at all, so do not hold up the fallback to a full DISCOVER.
+            static constexpr uint16_t RebootResponseTime = 1000;
+            static constexpr uint8_t RebootRetries = 1;
+
+            enum phase {
+                ACQUIRING,
+                BOUND,
+                RENEWING,
+                REBINDING
+            };
+
             DHCPEngine() = delete;
             DHCPEngine(const DHCPEngine&) = delete;
             DHCPEngine& operator=(const DHCPEngine&) = delete;
@@ -316,6 +413,8 @@ namespace Plugin {
             DHCPEngine(NetworkControl* parent, const string& interfaceName, const string& persistentStoragePath)
                 : _parent(*parent)
                 , _retries(0)
+                , _responseTime(0)
+                , _phase(ACQUIRING)
                 , _client(interfaceName, std::bind(&DHCPEngine::NewOffer, this, std::placeholders::_1), 
                           std::bind(&DHCPEngine::RequestResult, this, std::placeholders::_1, std::placeholders::_2))
                 , _leaseFilePath((persistentStoragePath.empty()) ? "" :  (persistentStoragePath + _client.Interface() + ".json"))
@@ -344,6 +443,7 @@ namespace Plugin {
 
             inline uint32_t Discover(const Core::NodeId& preferred)
             {
+                _phase = ACQUIRING;
                 SetupWatchdog();
                 uint32_t result = _client.Discover(preferred);
 
@@ -363,13 +463,45 @@ namespace Plugin {
             void GetIP(const Core::NodeId& preferred)
             {
                 auto offerIterator = _client.UnleasedOffers();
+
+                _phase = ACQUIRING;
+
                 if (offerIterator.Next() == true) {
-                    Request(offerIterator.Current());
+                    if (offerIterator.Current().Acquired() == 0) {
+                        Request(offerIterator.Current());
+                    } else {
+                        Reboot(DHCPClientImplementation::Offer(offerIterator.Current()));
+                    }
+                } else if (_client.LeasedOffer().IsValid() == true) {
+                    // Link bounced, see if our current lease still holds.
+                    Reboot(DHCPClientImplementation::Offer(_client.LeasedOffer()));
                 } else {
                     Discover(preferred);
                 }
             }
 
+            inline void Forfeit(const DHCPClientImplementation::Offer& offer)
+            {
+                // Our lease was refused or ignored, do not try to re-confirm it again.
+                if (_client.LeasedOffer().Id() == offer.Id()) {
+                    _client.LeasedOffer().Acquired(0);
+                }
+            }
+
+            void Reboot(const DHCPClientImplementation::Offer& lease)
+            {
+                if (lease.IsLeaseValid() == true) {
+                    // We held this lease before and it has not expired, try to get it
+                    // confirmed (INIT-REBOOT) without going through DISCOVER/OFFER.
+                    SetupWatchdog(RebootResponseTime, RebootRetries);
+                    _client.Request(lease, DHCPClientImplementation::REQUEST_INIT_REBOOT);
+                } else {
+                    // Expired lease, but the server is likely to hand out the same address again.
+                    _client.RemoveUnleasedOffer(lease);
+                    Discover(lease.Address());
+                }
+            }
+
             void NewOffer(const DHCPClientImplementation::Offer& offer) {
                 StopWatchdog();
                 if (_parent.NewOffer(_client.Interface(), offer) == true) {
@@ -382,9 +514,13 @@ namespace Plugin {
 
                 JsonData::NetworkControl::ConnectionchangeParamsData::StatusType status;
                 if (result == true) {
+                    _phase = BOUND;
                     _parent.RequestAccepted(_client.Interface(), offer);
+                    ScheduleRenewal(offer);
                     status = JsonData::NetworkControl::ConnectionchangeParamsData::StatusType::CONNECTED;
                 } else {
+                    _phase = ACQUIRING;
+                    Forfeit(offer);
                     _parent.RequestFailed(_client.Interface(), offer);
                     status = JsonData::NetworkControl::ConnectionchangeParamsData::StatusType::CONNECTIONFAILED;
                 }
@@ -394,6 +530,7 @@ namespace Plugin {
 
             inline void Request(const DHCPClientImplementation::Offer& offer) {
 
+                _phase = ACQUIRING;
                 SetupWatchdog();
                 _client.Request(offer);
             }
@@ -413,9 +550,14 @@ namespace Plugin {
 
             void SetupWatchdog() 
             {
-                const uint16_t responseMS = _parent.ResponseTime() * 1000;
+                SetupWatchdog(_parent.ResponseTime() * 1000, _parent.Retries());
+            }
+
+            void SetupWatchdog(const uint16_t responseMS, const uint8_t retries) 
+            {
                 Core::Time entry(Core::Time::Now().Add(responseMS));
-                _retries = _parent.Retries();
+                _retries = retries;
+                _responseTime = responseMS;
 
                 Core::ProxyType<Core::IDispatch> job(*this);    
 
@@ -431,14 +573,16 @@ namespace Plugin {
             void CleanUp() 
             {
                 StopWatchdog();
+                _phase = ACQUIRING;
                 _client.Completed();
             }
 
             virtual void Dispatch() override
             {
-                if (_retries > 0) {
-                    const uint16_t responseMS = _parent.ResponseTime() * 1000;
-                    Core::Time entry(Core::Time::Now().Add(responseMS));
+                if (_phase != ACQUIRING) {
+                    Lease();
+                } else if (_retries > 0) {
+                    Core::Time entry(Core::Time::Now().Add(_responseTime));
                     Core::ProxyType<Core::IDispatch> job(*this);
 
                     _retries--;
@@ -459,15 +603,23 @@ namespace Plugin {
                             // Remove unresponsive offer from potential candidates
                             DHCPClientImplementation::Offer copy = offer.Current(); 
                             _client.RemoveUnleasedOffer(offer.Current());
+                            Forfeit(copy);
                             _parent.RequestFailed(_client.Interface(), copy);
                         }
                     }
                 }
             }
 
+        private:
+            // RFC 2131 section 4.4.5, keep the lease alive (T1 = renew, T2 = rebind).
+            void ScheduleRenewal(const DHCPClientImplementation::Offer& offer);
+            void Lease();
+
         private:
             NetworkControl& _parent;
             uint8_t _retries;
+            uint16_t _responseTime;
+            phase _phase;
             DHCPClientImplementation _client;
             string _leaseFilePath;
         };
@@ -528,6 +680,7 @@ namespace Plugin {
         }
         void ClearAssignedIPV4IPs(Core::AdapterIterator& adapter);
         void ClearAssignedIPV6IPs(Core::AdapterIterator& adapter);
+        static bool IsAssigned(Core::AdapterIterator& adapter, const Core::IPNode& ipAddress);
 
         void RegisterAll();
         void UnregisterAll();
@@ -547,6 +700,7 @@ namespace Plugin {
         uint8_t _responseTime;
         uint8_t _retries;
         string _dnsFile;
+        string _dnsSection;
         string _persistentStoragePath;
         std::list<std::pair<uint16_t, Core::NodeId>> _dns;
         std::map<const string, StaticInfo> _interfaces;
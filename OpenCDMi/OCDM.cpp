@@ -20,6 +20,7 @@
 #include "OCDM.h"
 #include <ocdm/open_cdm.h>
 #include <interfaces/IDRM.h>
+#include "MemoryObserver.h"
 
 namespace WPEFramework {
 
@@ -27,52 +28,7 @@ namespace OCDM {
 
     Exchange::IMemory* MemoryObserver(const RPC::IRemoteConnection* connection)
     {
-        class MemoryObserverImpl : public Exchange::IMemory {
-        private:
-            MemoryObserverImpl();
-            MemoryObserverImpl(const MemoryObserverImpl&);
-            MemoryObserverImpl& operator=(const MemoryObserverImpl&);
-
-        public:
-            MemoryObserverImpl(const RPC::IRemoteConnection* connection)
-                : _main(connection  == 0 ? Core::ProcessInfo().Id() : connection->RemoteId())
-            {
-            }
-            ~MemoryObserverImpl()
-            {
-            }
-
-        public:
-            virtual uint64_t Resident() const
-            {
-                return _main.Resident();
-            }
-            virtual uint64_t Allocated() const
-            {
-                return _main.Allocated();
-            }
-            virtual uint64_t Shared() const
-            {
-                return _main.Shared();
-            }
-            virtual uint8_t Processes() const
-            {
-                return (IsOperational() ? 1 : 0);
-            }
-            virtual const bool IsOperational() const
-            {
-                return _main.IsActive();
-            }
-
-            BEGIN_INTERFACE_MAP(MemoryObserverImpl)
-            INTERFACE_ENTRY(Exchange::IMemory)
-            END_INTERFACE_MAP
-
-        private:
-            Core::ProcessInfo _main;
-        };
-
-        Exchange::IMemory* result = Core::Service<MemoryObserverImpl>::Create<Exchange::IMemory>(connection);
+        Exchange::IMemory* result = Core::Service<Plugin::MemoryObserverImpl>::Create<Exchange::IMemory>(connection == nullptr ? 0 : connection->RemoteId());
 
         return (result);
     }
@@ -22,6 +22,7 @@
 #include <interfaces/IKeyHandler.h>
 #include <libudev.h>
 #include <linux/uinput.h>
+#include <sys/epoll.h>
 
 namespace WPEFramework {
 namespace Plugin {
@@ -45,15 +46,85 @@ namespace Plugin {
         LinuxDevice(const LinuxDevice&) = delete;
         LinuxDevice& operator=(const LinuxDevice&) = delete;
 
+        static constexpr uint8_t MaxEvents = 64;
+
+        // What an evdev node can report, queried once when it is opened.
+        class Capabilities {
+        private:
+            Capabilities() = delete;
+            Capabilities(const Capabilities&) = delete;
+            Capabilities& operator=(const Capabilities&) = delete;
+
+        public:
+            Capabilities(const int fd)
+            {
+                memset(_events, 0, sizeof(_events));
+                memset(_keys, 0, sizeof(_keys));
+                memset(_relatives, 0, sizeof(_relatives));
+                memset(_absolutes, 0, sizeof(_absolutes));
+
+                if (ioctl(fd, EVIOCGBIT(0, sizeof(_events)), _events) >= 0) {
+                    if (Bit(_events, EV_KEY) == true) {
+                        ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(_keys)), _keys);
+                    }
+                    if (Bit(_events, EV_REL) == true) {
+                        ioctl(fd, EVIOCGBIT(EV_REL, sizeof(_relatives)), _relatives);
+                    }
+                    if (Bit(_events, EV_ABS) == true) {
+                        ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(_absolutes)), _absolutes);
+                    }
+                }
+            }
+
+        public:
+            bool Key(const uint16_t first, const uint16_t last) const
+            {
+                uint16_t index = first;
+                while ((index < last) && (Bit(_keys, index) == false)) {
+                    index++;
+                }
+                return (index < last);
+            }
+            bool Relative(const uint16_t code) const
+            {
+                return (Bit(_relatives, code));
+            }
+            bool Absolute(const uint16_t code) const
+            {
+                return (Bit(_absolutes, code));
+            }
+
+        private:
+            static bool Bit(const uint8_t bitfield[], const uint16_t bit)
+            {
+                return ((bitfield[bit / 8] & (1 << (bit % 8))) != 0);
+            }
+
+        private:
+            uint8_t _events[(EV_MAX / 8) + 1];
+            uint8_t _keys[(KEY_MAX / 8) + 1];
+            uint8_t _relatives[(REL_MAX / 8) + 1];
+            uint8_t _absolutes[(ABS_MAX / 8) + 1];
+        };
+
         struct IDevInputDevice {
             virtual ~IDevInputDevice() { }
             virtual type Type() const { return (type::NONE); }
             virtual bool Setup() { return true; }
             virtual bool Teardown() { return true; }
+            virtual bool Supports(const Capabilities& capabilities) const = 0;
             virtual bool HandleInput(uint16_t code, uint16_t type, int32_t value) = 0;
+            virtual void Reset() { }
             virtual void ProducerEvent(const Exchange::ProducerEvents event) { }
         };
 
+        // An opened /dev/input/eventX node and the producers its events are routed to.
+        struct InputDevice {
+            int descriptor;
+            bool dropped;
+            std::vector<IDevInputDevice*> routes;
+        };
+
         class KeyDevice : public Exchange::IKeyProducer, public IDevInputDevice {
         public:
             KeyDevice(const KeyDevice&) = delete;
@@ -122,6 +193,10 @@ namespace Plugin {
             {
                 return type::KEYBOARD;
             }
+            bool Supports(const Capabilities& capabilities) const override
+            {
+                return ((capabilities.Key(KEY_ESC, BTN_MISC) == true) || (capabilities.Key(KEY_OK, KEY_MAX) == true));
+            }
             bool HandleInput(uint16_t code, uint16_t type, int32_t value) override
             {
                 if (type == EV_KEY) {
@@ -158,6 +233,8 @@ namespace Plugin {
             WheelDevice(LinuxDevice* parent)
                 : _parent(parent)
                 , _callback(nullptr)
+                , _horizontal(0)
+                , _vertical(0)
             {
                 Remotes::RemoteAdministrator::Instance().Announce(*this);
             }
@@ -187,21 +264,35 @@ namespace Plugin {
             {
                 return (Name());
             }
+            bool Supports(const Capabilities& capabilities) const override
+            {
+                return ((capabilities.Relative(REL_WHEEL) == true) || (capabilities.Relative(REL_HWHEEL) == true));
+            }
             bool HandleInput(uint16_t code, uint16_t type, int32_t value) override
             {
+                // Both axis are accumulated and reported once per SYN_REPORT frame.
                 if (type == EV_REL) {
                     switch(code)
                     {
                     case REL_WHEEL:
-                        _callback->AxisEvent(0, value);
+                        _vertical += value;
                         return true;
                     case REL_HWHEEL:
-                        _callback->AxisEvent(value, 0);
+                        _horizontal += value;
                         return true;
                     }
                 }
+                else if ((type == EV_SYN) && ((_horizontal != 0) || (_vertical != 0))) {
+                    _callback->AxisEvent(_horizontal, _vertical);
+                    Reset();
+                }
                 return false;
             }
+            void Reset() override
+            {
+                _horizontal = 0;
+                _vertical = 0;
+            }
 
             BEGIN_INTERFACE_MAP(WheelDevice)
             INTERFACE_ENTRY(Exchange::IWheelProducer)
@@ -210,6 +301,8 @@ namespace Plugin {
         private:
             LinuxDevice* _parent;
             Exchange::IWheelHandler* _callback;
+            int16_t _horizontal;
+            int16_t _vertical;
         };
 
         class PointerDevice : public Exchange::IPointerProducer, public IDevInputDevice {
@@ -220,6 +313,10 @@ namespace Plugin {
             PointerDevice(LinuxDevice* parent)
                 : _parent(parent)
                 , _callback(nullptr)
+                , _x(0)
+                , _y(0)
+                , _buttons(0)
+                , _changed(0)
             {
                 Remotes::RemoteAdministrator::Instance().Announce(*this);
             }
@@ -246,27 +343,57 @@ namespace Plugin {
             {
                 return (Name());
             }
+            bool Supports(const Capabilities& capabilities) const override
+            {
+                return ((capabilities.Relative(REL_X) == true) || (capabilities.Relative(REL_Y) == true) || (capabilities.Key(BTN_MOUSE, BTN_TASK + 1) == true));
+            }
             bool HandleInput(uint16_t code, uint16_t type, int32_t value) override
             {
+                // Motion is accumulated and button changes are latched, both are reported per
+                // SYN_REPORT frame, the motion first, so a click lands where the pointer moved to.
                 if (type == EV_REL) {
                     switch(code)
                     {
                     case REL_X:
-                        _callback->PointerMotionEvent(value, 0);
+                        _x += value;
                         return true;
                     case REL_Y:
-                        _callback->PointerMotionEvent(0, value);
+                        _y += value;
                         return true;
                     }
                 }
                 else if (type == EV_KEY) {
                     if ((code >= BTN_MOUSE) && (code <= BTN_TASK)) {
-                        _callback->PointerButtonEvent((value != 0), (code - BTN_MOUSE));
+                        const uint8_t mask = (1 << (code - BTN_MOUSE));
+                        if (((_buttons & mask) != 0) != (value != 0)) {
+                            _buttons ^= mask;
+                            _changed ^= mask;
+                        }
                         return true;
                     }
                 }
+                else if (type == EV_SYN) {
+                    if ((_x != 0) || (_y != 0)) {
+                        _callback->PointerMotionEvent(_x, _y);
+                    }
+                    for (uint8_t button = 0; _changed != 0; button++, _changed >>= 1) {
+                        if ((_changed & 1) != 0) {
+                            _callback->PointerButtonEvent(((_buttons & (1 << button)) != 0), button);
+                        }
+                    }
+                    _x = 0;
+                    _y = 0;
+                }
                 return false;
             }
+            void Reset() override
+            {
+                _x = 0;
+                _y = 0;
+                // Forget the unreported changes, the buttons are as the handler last heard.
+                _buttons ^= _changed;
+                _changed = 0;
+            }
 
             BEGIN_INTERFACE_MAP(PointerDevice)
             INTERFACE_ENTRY(Exchange::IPointerProducer)
@@ -275,6 +402,10 @@ namespace Plugin {
         private:
             LinuxDevice* _parent;
             Exchange::IPointerHandler* _callback;
+            int16_t _x;
+            int16_t _y;
+            uint8_t _buttons;
+            uint8_t _changed;
         };
 
         class TouchDevice : public Exchange::ITouchProducer, public IDevInputDevice {
@@ -305,6 +436,10 @@ namespace Plugin {
             {
                 _parent->Pair();
             }
+            bool Supports(const Capabilities& capabilities) const override
+            {
+                return ((capabilities.Absolute(ABS_X) == true) || (capabilities.Absolute(ABS_MT_POSITION_X) == true));
+            }
             bool Setup() override
             {
                 _have_multitouch = false;
@@ -313,24 +448,28 @@ namespace Plugin {
                     uint8_t absbits[(ABS_MAX / 8) + 1];
                     memset(absbits, 0, sizeof(absbits));
 
-                    if (ioctl(index.second.first, EVIOCGBIT(EV_ABS, sizeof(absbits)), absbits) >= 0) {
+                    if (std::find(index.second.routes.begin(), index.second.routes.end(), this) == index.second.routes.end()) {
+                        continue;
+                    }
+
+                    if (ioctl(index.second.descriptor, EVIOCGBIT(EV_ABS, sizeof(absbits)), absbits) >= 0) {
                         if (CheckBit(absbits, ABS_X) == true) {
                             // Note: Only multitouch protocol B supported. In case of protocol A multitouch device, will run as single-touch.
                             _have_multitouch = (CheckBit(absbits, ABS_MT_SLOT) == true) && (CheckBit(absbits, ABS_MT_POSITION_X) == true);
 
                             struct input_absinfo absinfo;
                             if (_have_multitouch == true) {
-                                if (ioctl(index.second.first, EVIOCGABS(ABS_MT_POSITION_X), &absinfo) >= 0) {
+                                if (ioctl(index.second.descriptor, EVIOCGABS(ABS_MT_POSITION_X), &absinfo) >= 0) {
                                     _abs_x_multiplier = ((1 << 16) << ABS_MULTIPLIER_PRECISSION) / absinfo.maximum;
                                 }
-                                if (ioctl(index.second.first, EVIOCGABS(ABS_MT_POSITION_Y), &absinfo) >= 0) {
+                                if (ioctl(index.second.descriptor, EVIOCGABS(ABS_MT_POSITION_Y), &absinfo) >= 0) {
                                     _abs_y_multiplier = ((1 << 16) << ABS_MULTIPLIER_PRECISSION) / absinfo.maximum;
                                 }
                             } else {
-                                if (ioctl(index.second.first, EVIOCGABS(ABS_X), &absinfo) >= 0) {
+                                if (ioctl(index.second.descriptor, EVIOCGABS(ABS_X), &absinfo) >= 0) {
                                     _abs_x_multiplier = ((1 << 16) << ABS_MULTIPLIER_PRECISSION) / absinfo.maximum;
                                 }
-                                if (ioctl(index.second.first, EVIOCGABS(ABS_Y), &absinfo) >= 0) {
+                                if (ioctl(index.second.descriptor, EVIOCGABS(ABS_Y), &absinfo) >= 0) {
                                     _abs_y_multiplier = ((1 << 16) << ABS_MULTIPLIER_PRECISSION) / absinfo.maximum;
                                 }
                             }
@@ -426,6 +565,14 @@ namespace Plugin {
                 }
                 return false;
             }
+            void Reset() override
+            {
+                _have_abs = false;
+                _abs_slot = 0;
+                for (auto& latch : _abs_latch) {
+                    latch.Reset();
+                }
+            }
 
         private:
             bool CheckBit(const uint8_t bitfield[], const uint16_t bit)
@@ -513,6 +660,7 @@ namespace Plugin {
             , _devices()
             , _monitor(nullptr)
             , _update(-1)
+            , _epoll(-1)
         {
             _pipe[0] = -1;
             _pipe[1] = -1;
@@ -538,6 +686,12 @@ namespace Plugin {
 
                 udev_unref(udev);
 
+                // One epoll set for the control pipe, udev and all input nodes. The pipe and udev
+                // are tagged with their own address, input nodes with their InputDevice entry.
+                _epoll = epoll_create1(EPOLL_CLOEXEC);
+                Watch(_pipe[0], &_pipe[0]);
+                Watch(_update, &_update);
+
                 _inputDevices.emplace_back(Core::Service<KeyDevice>::Create<KeyDevice>(this));
                 _inputDevices.emplace_back(Core::Service<WheelDevice>::Create<WheelDevice>(this));
                 _inputDevices.emplace_back(Core::Service<PointerDevice>::Create<PointerDevice>(this));
@@ -565,6 +719,10 @@ namespace Plugin {
                 udev_monitor_unref(_monitor);
             }
 
+            if (_epoll != -1) {
+                ::close(_epoll);
+            }
+
             for (auto& device : _inputDevices) {
                 device->Teardown();
             }
@@ -608,26 +766,31 @@ namespace Plugin {
                 Core::File entry(dir.Current(), false);
                 if ((entry.IsDirectory() == false) && (entry.FileName().substr(0, 5) == _T("event"))) {
 
-                    TRACE(Trace::Information, (_T("Opening input device: %s"), entry.Name().c_str()));
-
-                    if (entry.Open(true) == true) {
-                        int fd = entry.DuplicateHandle();
-                        std::map<string, std::pair<int, IDevInputDevice*>>::iterator device(_devices.find(entry.Name()));
-                        if (device == _devices.end()) {
-                            string deviceName;
-                            ReadDeviceName(entry.Name(), deviceName);
-                            std::transform(deviceName.begin(), deviceName.end(), deviceName.begin(), std::ptr_fun<int, int>(std::toupper));
-
-                            IDevInputDevice* inputDevice = nullptr;
-                            for (auto& device : _inputDevices) {
-                                std::size_t found = deviceName.find(Core::EnumerateType<LinuxDevice::type>(device->Type()).Data());
-                                if (found != std::string::npos) {
-                                    inputDevice = device;
-                                    break;
-                                }
+                    if ((_devices.find(entry.Name()) == _devices.end()) && (entry.Open(true) == true)) {
+                        TRACE(Trace::Information, (_T("Opening input device: %s"), entry.Name().c_str()));
+
+                        InputDevice& device(_devices[entry.Name()]);
+                        device.descriptor = entry.DuplicateHandle();
+                        device.dropped = false;
+
+                        // Route on what the node can report, so events do not have to be offered
+                        // to producers that can never handle them.
+                        Capabilities capabilities(device.descriptor);
+                        for (auto& producer : _inputDevices) {
+                            if (producer->Supports(capabilities) == true) {
+                                device.routes.push_back(producer);
                             }
+                        }
+
+                        string deviceName;
+                        ReadDeviceName(entry.Name(), deviceName);
+                        TRACE(Trace::Information, (_T("Input device %s [%s] routed to %d producer(s)"), entry.Name().c_str(), deviceName.c_str(), static_cast<uint32_t>(device.routes.size())));
 
-                            _devices.insert(std::make_pair(entry.Name(), std::make_pair(fd, inputDevice)));
+                        if (device.routes.empty() == true) {
+                            close(device.descriptor);
+                            _devices.erase(entry.Name());
+                        } else {
+                            Watch(device.descriptor, &device);
                         }
                     }
                 }
@@ -640,12 +803,23 @@ namespace Plugin {
         }
         void Clear()
         {
-            for (std::map<string, std::pair<int, IDevInputDevice*>>::const_iterator it = _devices.begin(), end = _devices.end();
-                 it != end; ++it) {
-                close(it->second.first);
+            for (auto& device : _devices) {
+                epoll_ctl(_epoll, EPOLL_CTL_DEL, device.second.descriptor, nullptr);
+                close(device.second.descriptor);
             }
             _devices.clear();
         }
+        void Watch(const int fd, void* tag)
+        {
+            struct epoll_event event;
+            memset(&event, 0, sizeof(event));
+            event.events = EPOLLIN;
+            event.data.ptr = tag;
+
+            if (epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+                TRACE(Trace::Error, (_T("Could not watch descriptor %d, error %d"), fd, errno));
+            }
+        }
         void Block()
         {
             Core::Thread::Block();
@@ -655,28 +829,18 @@ namespace Plugin {
         virtual uint32_t Worker()
         {
             while (IsRunning() == true) {
-                fd_set readset;
-                FD_ZERO(&readset);
-                FD_SET(_pipe[0], &readset);
-                FD_SET(_update, &readset);
+                struct epoll_event events[8];
 
-                int result = std::max(_pipe[0], _update);
+                int count = epoll_wait(_epoll, events, (sizeof(events) / sizeof(struct epoll_event)), -1);
 
-                // set up all the input devices
-                for (std::map<string, std::pair<int, IDevInputDevice*>>::const_iterator index = _devices.begin(), end = _devices.end(); index != end; ++index) {
-                    FD_SET(index->second.first, &readset);
-                    result = std::max(result, index->second.first);
-                }
-
-                result = select(result + 1, &readset, 0, 0, nullptr);
+                for (int index = 0; index < count; index++) {
+                    void* tag = events[index].data.ptr;
 
-                if (result > 0) {
-                    if (FD_ISSET(_pipe[0], &readset)) {
+                    if (tag == &_pipe[0]) {
                         char buff;
                         (void)read(_pipe[0], &buff, 1);
-                    }
-                    if (FD_ISSET(_update, &readset)) {
-                        // Make the call to receive the device. select() ensured that this will not block.
+                    } else if (tag == &_update) {
+                        // Make the call to receive the device. epoll ensured that this will not block.
                         udev_device* dev = udev_monitor_receive_device(_monitor);
                         if (dev) {
                             const char* nodeId = udev_device_get_devnode(dev);
@@ -687,45 +851,61 @@ namespace Plugin {
                                 Refresh();
                             }
                         }
-                    }
-
-                    // find the devices to read from
-                    std::map<string, std::pair<int, IDevInputDevice*>>::iterator index = _devices.begin();
-
-                    while (index != _devices.end()) {
-                        if (FD_ISSET(index->second.first, &readset)) {
-
-                            if (HandleInput(index->second.first) == false) {
-                                // fd closed?
-                                close(index->second.first);
-                                index = _devices.erase(index);
-                            } else {
-                                ++index;
+                    } else {
+                        InputDevice& device(*static_cast<InputDevice*>(tag));
+
+                        if (HandleInput(device) == false) {
+                            // fd closed?
+                            std::map<string, InputDevice>::iterator entry(_devices.begin());
+                            while ((entry != _devices.end()) && (&(entry->second) != &device)) {
+                                ++entry;
+                            }
+                            epoll_ctl(_epoll, EPOLL_CTL_DEL, device.descriptor, nullptr);
+                            close(device.descriptor);
+                            if (entry != _devices.end()) {
+                                _devices.erase(entry);
                             }
-                        } else {
-                            ++index;
                         }
                     }
                 }
             }
             return (Core::infinite);
         }
-        bool HandleInput(const int fd)
+        bool HandleInput(InputDevice& device)
         {
-            input_event entry[16];
-            int index = 0;
-            int result = ::read(fd, entry, sizeof(entry));
+            input_event entry[MaxEvents];
+            int result = ::read(device.descriptor, entry, sizeof(entry));
 
             if (result > 0) {
-                while (result >= static_cast<int>(sizeof(input_event))) {
-                    ASSERT(index < static_cast<int>((sizeof(entry) / sizeof(input_event))));
-                    for (auto& device : _inputDevices) {
-                        if (device->HandleInput(entry[index].code,  entry[index].type, entry[index].value) == true) {
-                            break;
+                const uint16_t count = (result / sizeof(input_event));
+
+                for (uint16_t index = 0; index < count; index++) {
+                    const input_event& event(entry[index]);
+
+                    if (event.type == EV_SYN) {
+                        if (event.code == SYN_DROPPED) {
+                            // The kernel buffer overran, whatever was collected for this frame is incomplete.
+                            device.dropped = true;
+                        } else if (event.code == SYN_REPORT) {
+                            if (device.dropped == true) {
+                                device.dropped = false;
+                                for (auto& route : device.routes) {
+                                    route->Reset();
+                                }
+                            } else {
+                                // End of frame, let all producers flush what they accumulated.
+                                for (auto& route : device.routes) {
+                                    route->HandleInput(event.code, event.type, event.value);
+                                }
+                            }
+                        }
+                    } else if (device.dropped == false) {
+                        for (auto& route : device.routes) {
+                            if (route->HandleInput(event.code, event.type, event.value) == true) {
+                                break;
+                            }
                         }
                     }
-                    index++;
-                    result -= sizeof(input_event);
                 }
             }
 
@@ -757,13 +937,14 @@ namespace Plugin {
             return status;
         }
 
-        std::map<string, std::pair<int, IDevInputDevice*>> Devices() { return _devices; }
+        const std::map<string, InputDevice>& Devices() const { return _devices; }
 
     private:
-        std::map<string, std::pair<int, IDevInputDevice*>> _devices;
+        std::map<string, InputDevice> _devices;
         int _pipe[2];
         udev_monitor* _monitor;
         int _update;
+        int _epoll;
         std::vector<IDevInputDevice*> _inputDevices;
         static LinuxDevice* _singleton;
     };
@@ -28,6 +28,7 @@ namespace Plugin {
     static const string DefaultMappingTable(_T("default"));
     static Core::ProxyPoolType<Web::JSONBodyType<RemoteControl::Data>> jsonResponseFactory(4);
     static Core::ProxyPoolType<Web::JSONBodyType<PluginHost::VirtualInput::KeyMap::KeyMapEntry>> jsonCodeFactory(1);
+    static Core::ProxyPoolType<Web::JSONBodyType<RemoteControl::Statistics>> jsonStatisticsFactory(1);
 
     SERVICE_REGISTRATION(RemoteControl, 1, 0);
 
@@ -136,6 +137,9 @@ namespace Plugin {
         , _inputHandler(PluginHost::InputHandler::Handler())
         , _persistentPath()
         , _feedback(*this)
+        , _adminLock()
+        , _devices()
+        , _default(nullptr)
     {
         ASSERT(_inputHandler != nullptr);
 
@@ -168,17 +172,17 @@ namespace Plugin {
             _persistentPath = service->PersistentPath();
 
             // Seems like we have a default mapping file. Load it..
-            PluginHost::VirtualInput::KeyMap& map(_inputHandler->Table(DefaultMappingTable));
+            AddDevice(DefaultMappingTable, config.PassOn.Value());
+            _default = &(_devices.find(DefaultMappingTable)->second);
 
-            if (mappingFile.empty() == true) {
+            if ((mappingFile.empty() == true) || (LoadMap(DefaultMappingTable, mappingFile) != Core::ERROR_NONE)) {
+                std::vector<KeyTable::Entry> entries;
 
-                map.PassThrough(config.PassOn.Value());
-            } else {
-                if (map.Load(mappingFile) == Core::ERROR_NONE) {
+                // Without a table of its own, the default device would fall back on itself.
+                _default->Publish(KeyTable::Compile(entries));
 
-                    map.PassThrough(config.PassOn.Value());
-                } else {
-                    map.PassThrough(false);
+                if (mappingFile.empty() == false) {
+                    _default->PassOn(false);
                 }
             }
 
@@ -204,9 +208,11 @@ namespace Plugin {
                     (*index)->Configure(configList.Current().Settings.Value());
                     // We found an overruling name.
                     loadName = configList.Current().MapFile.Value();
+                    AddDevice(producer, configList.Current().PassOn.Value());
                 } else {
                     (*index)->Configure(EMPTY_STRING);
                     loadName += _T(".json");
+                    AddDevice(producer, false);
                 }
 
                 // See if we need to load a table.
@@ -218,11 +224,7 @@ namespace Plugin {
                     TRACE_L1(_T("Opening map file: %s"), specific.c_str());
 
                     // Get our selves a table..
-                    PluginHost::VirtualInput::KeyMap& map(_inputHandler->Table(producer.c_str()));
-                    map.Load(specific);
-                    if (configList.IsValid() == true) {
-                        map.PassThrough(configList.Current().PassOn.Value());
-                    }
+                    LoadMap(producer, specific);
                 }
             }
 
@@ -236,6 +238,8 @@ namespace Plugin {
                     loadName = configList.Current().Name.Value() + _T(".json");
                 }
 
+                AddDevice(configList.Current().Name.Value(), configList.Current().PassOn.Value());
+
                 // See if we need to load a table.
                 string specific(MappingFile(loadName, service->PersistentPath(), service->DataPath()));
 
@@ -243,10 +247,8 @@ namespace Plugin {
                     TRACE(Trace::Information, (_T("Opening map file: %s"), specific.c_str()));
                     TRACE_L1(_T("Opening map file: %s"), specific.c_str());
 
-                    // Get our selves a table..de
-                    PluginHost::VirtualInput::KeyMap& map(_inputHandler->Table(configList.Current().Name.Value()));
-                    map.Load(specific);
-                    map.PassThrough(configList.Current().PassOn.Value());
+                    // Get our selves a table..
+                    LoadMap(configList.Current().Name.Value(), specific);
                 }
 
                 _virtualDevices.push_back(configList.Current().Name.Value());
@@ -289,23 +291,21 @@ namespace Plugin {
 
         _inputHandler->Unregister(&_feedback);
 
-        Remotes::RemoteAdministrator& admin(Remotes::RemoteAdministrator::Instance());
-        Remotes::RemoteAdministrator::Iterator index(admin.Producers());
-
-        // Clear all injected device key maps
-        while (index.Next() == true) {
+        // Clear all injected device key maps, the default one included.
+        _inputHandler->Default(EMPTY_STRING);
 
-            _inputHandler->ClearTable((*index)->Name().c_str());
+        for (const std::pair<const string, Device>& device : _devices) {
+            _inputHandler->ClearTable(device.first);
         }
 
-        // Clear default key map
-        _inputHandler->Default(EMPTY_STRING);
-        _inputHandler->ClearTable(DefaultMappingTable);
-
         // CLear the virtual devices.
         _virtualDevices.clear();
 
         Remotes::RemoteAdministrator::Instance().RevokeAll();
+
+        // No more key events can come in, so the devices can go.
+        _default = nullptr;
+        _devices.clear();
     }
 
     /* virtual */ string RemoteControl::Information() const
@@ -355,7 +355,19 @@ namespace Plugin {
 
     /* virtual */ uint32_t RemoteControl::KeyEvent(const bool pressed, const uint32_t code, const string& mapName)
     {
-        uint32_t result = _inputHandler->KeyEvent(pressed, code, mapName);
+        uint32_t result = Core::ERROR_UNKNOWN_TABLE;
+        Devices::const_iterator index(_devices.find(mapName));
+        const Device* device(index != _devices.end() ? &(index->second) : _default);
+
+        if (device != nullptr) {
+            uint32_t translated = 0;
+
+            result = device->Translate(code, translated);
+
+            if (result == Core::ERROR_NONE) {
+                result = _inputHandler->KeyEvent(pressed, translated, (index != _devices.end() ? mapName : DefaultMappingTable));
+            }
+        }
 
         if (result == Core::ERROR_NONE) {
             TRACE(KeyActivity, (mapName, code, pressed));
@@ -400,6 +412,175 @@ namespace Plugin {
         return (_inputHandler->TouchEvent(index, ((state == touchstate::TOUCH_MOTION)? 0 : ((state == touchstate::TOUCH_RELEASED)? 1 : 2)), x, y));
     }
 
+    void RemoteControl::AddDevice(const string& name, const bool passOn)
+    {
+        // The keys are translated here, the VirtualInput table of the device only
+        // dispatches the result, so it stays empty and passes everything on.
+        _inputHandler->Table(name).PassThrough(true);
+
+        Device& device(_devices.emplace(std::piecewise_construct, std::forward_as_tuple(name), std::forward_as_tuple(_default)).first->second);
+
+        device.PassOn(passOn);
+    }
+
+    uint32_t RemoteControl::LoadMap(const string& device, const string& fileName)
+    {
+        uint32_t result = Core::ERROR_UNKNOWN_TABLE;
+        Devices::iterator index(_devices.find(device));
+
+        if (index != _devices.end()) {
+            Core::File mapFile(fileName);
+
+            result = Core::ERROR_OPENING_FAILED;
+
+            if (mapFile.Open(true) == true) {
+                // The complete file is parsed and compiled before it replaces the live table, so a
+                // broken file never replaces a working map and a key event never sees half a map.
+                Core::JSON::ArrayType<PluginHost::VirtualInput::KeyMap::KeyMapEntry> entries;
+                Core::OptionalType<Core::JSON::Error> error;
+                entries.IElement::FromFile(mapFile, error);
+                mapFile.Close();
+
+                if (error.IsSet() == true) {
+                    SYSLOG(Logging::ParsingError, (_T("Parsing of %s failed with %s"), fileName.c_str(), ErrorDisplayMessage(error.Value()).c_str()));
+                    result = Core::ERROR_PARSE_FAILURE;
+                } else {
+                    Core::JSON::ArrayType<PluginHost::VirtualInput::KeyMap::KeyMapEntry>::ConstIterator element(entries.Elements());
+                    std::vector<KeyTable::Entry> table;
+
+                    while (element.Next() == true) {
+                        const PluginHost::VirtualInput::KeyMap::KeyMapEntry& entry(element.Current());
+
+                        if ((entry.Code.IsSet() == true) && (entry.Key.IsSet() == true)) {
+                            Core::JSON::ArrayType<Core::JSON::EnumType<PluginHost::VirtualInput::KeyMap::modifier>>::ConstIterator flags(entry.Modifiers.Elements());
+                            uint16_t modifiers = 0;
+
+                            while (flags.Next() == true) {
+                                modifiers |= static_cast<uint16_t>(flags.Current().Value());
+                            }
+
+                            table.push_back(KeyTable::Entry { entry.Code.Value(), static_cast<uint16_t>(entry.Key.Value()), modifiers });
+                        }
+                    }
+
+                    KeyTable* compiled = KeyTable::Compile(table);
+
+                    _adminLock.Lock();
+                    index->second.Publish(compiled);
+                    _adminLock.Unlock();
+
+                    result = Core::ERROR_NONE;
+                }
+            }
+        }
+
+        return (result);
+    }
+
+    uint32_t RemoteControl::SaveMap(const string& device, const string& fileName) const
+    {
+        uint32_t result = Core::ERROR_UNKNOWN_TABLE;
+        Devices::const_iterator index(_devices.find(device));
+
+        if (index != _devices.end()) {
+            Core::JSON::ArrayType<PluginHost::VirtualInput::KeyMap::KeyMapEntry> entries;
+
+            _adminLock.Lock();
+
+            const KeyTable* table = index->second.Table();
+
+            if (table != nullptr) {
+                for (const KeyTable::Entry& entry : table->Entries()) {
+                    PluginHost::VirtualInput::KeyMap::KeyMapEntry& element(entries.Add());
+                    uint16_t modifiers(entry.Modifiers);
+                    uint16_t flag(1);
+
+                    element.Code = entry.Code;
+                    element.Key = entry.Key;
+
+                    while (modifiers != 0) {
+                        if ((modifiers & 0x01) != 0) {
+                            Core::JSON::EnumType<PluginHost::VirtualInput::KeyMap::modifier>& jsonRef = element.Modifiers.Add();
+                            jsonRef = static_cast<PluginHost::VirtualInput::KeyMap::modifier>(flag);
+                        }
+
+                        flag = flag << 1;
+                        modifiers = modifiers >> 1;
+                    }
+                }
+            }
+
+            _adminLock.Unlock();
+
+            Core::File mapFile(fileName);
+
+            if (mapFile.Create() == true) {
+                result = (entries.IElement::ToFile(mapFile) == true ? Core::ERROR_NONE : Core::ERROR_WRITE_ERROR);
+                mapFile.Close();
+            } else {
+                result = Core::ERROR_OPENING_FAILED;
+            }
+        }
+
+        return (result);
+    }
+
+    uint32_t RemoteControl::ChangeMap(const string& device, const change what, const uint32_t code, const uint16_t key, const uint16_t modifiers)
+    {
+        uint32_t result = Core::ERROR_UNKNOWN_TABLE;
+        Devices::iterator index(_devices.find(device));
+
+        if (index != _devices.end()) {
+            std::vector<KeyTable::Entry> entries;
+
+            _adminLock.Lock();
+
+            const KeyTable* current = index->second.Table();
+
+            if (current != nullptr) {
+                entries = current->Entries();
+            }
+
+            std::vector<KeyTable::Entry>::iterator entry(std::lower_bound(entries.begin(), entries.end(), code,
+                [](const KeyTable::Entry& element, const uint32_t value) { return (element.Code < value); }));
+            const bool exists((entry != entries.end()) && (entry->Code == code));
+
+            if (what == change::ADD) {
+                if (exists == true) {
+                    result = Core::ERROR_DUPLICATE_KEY;
+                } else {
+                    entries.insert(entry, KeyTable::Entry { code, key, modifiers });
+                    result = Core::ERROR_NONE;
+                }
+            } else if (exists == false) {
+                result = Core::ERROR_UNKNOWN_KEY;
+            } else if (what == change::MODIFY) {
+                entry->Key = key;
+                entry->Modifiers = modifiers;
+                result = Core::ERROR_NONE;
+            } else {
+                entries.erase(entry);
+                result = Core::ERROR_NONE;
+            }
+
+            if (result == Core::ERROR_NONE) {
+                // The entries are still sorted and unique, no need to compile them again.
+                index->second.Publish(new KeyTable(std::move(entries)));
+            }
+
+            _adminLock.Unlock();
+        }
+
+        return (result);
+    }
+
+    bool RemoteControl::GetKey(const string& device, const uint32_t code, uint16_t& key, uint16_t& modifiers) const
+    {
+        Devices::const_iterator index(_devices.find(device));
+
+        return ((index != _devices.end()) && (index->second.Get(code, key, modifiers) == true));
+    }
+
     bool RemoteControl::ParseRequestBody(const Web::Request& request, uint32_t& code, uint16_t& key, uint32_t& modifiers)
     {
         bool parsed = false;
@@ -490,8 +671,23 @@ namespace Plugin {
             const string deviceName = index.Current().Text();
 
             if ((IsVirtualDevice(deviceName)) || (IsPhysicalDevice(deviceName))) {
+                const bool statistics((index.Next() == true) && (index.Current() == _T("Statistics")));
+
+                // GET .../RemoteControl/<DEVICE_NAME>/Statistics : Return the translation counters of DEVICE_NAME
+                if (statistics == true) {
+                    Devices::const_iterator device(_devices.find(deviceName));
+
+                    Core::ProxyType<Web::JSONBodyType<Statistics>> response(jsonStatisticsFactory.Element());
+                    response->Translated = (device != _devices.end() ? device->second.Translated() : 0);
+                    response->Unknown = (device != _devices.end() ? device->second.Unknown() : 0);
+
+                    result->ErrorCode = Web::STATUS_OK;
+                    result->Message = string(_T("Translation statistics of ") + deviceName);
+                    result->ContentType = Web::MIMETypes::MIME_JSON;
+                    result->Body(Core::proxy_cast<Web::IBody>(response));
+                }
                 // GET .../RemoteControl/<DEVICE_NAME>?Code=XXX : Get code of DEVICE_NAME
-                if (request.Query.IsSet() == true) {
+                else if (request.Query.IsSet() == true) {
                     Core::URL::KeyValue options(request.Query.Value());
 
                     Core::NumberType<uint32_t> code(options.Number<uint32_t>(_T("Code"), static_cast<uint32_t>(~0)));
@@ -500,16 +696,15 @@ namespace Plugin {
                     result->Message = string(_T("Key does not exist in ") + deviceName);
 
                     if (code.Value() != static_cast<uint32_t>(~0)) {
-                        // Load default or specific device mapping
-                        PluginHost::VirtualInput::KeyMap& map(_inputHandler->Table(deviceName));
+                        uint16_t key = 0;
+                        uint16_t modifiers = 0;
 
-                        const PluginHost::VirtualInput::KeyMap::ConversionInfo* codeElements = map[code];
-                        if (codeElements != nullptr) {
+                        if (GetKey(deviceName, code, key, modifiers) == true) {
 
                             result->ErrorCode = Web::STATUS_OK;
                             result->Message = string(_T("Get key info of ") + deviceName);
                             result->ContentType = Web::MIMETypes::MIME_JSON;
-                            result->Body(CreateResponseBody(code, codeElements->Code, codeElements->Modifiers));
+                            result->Body(CreateResponseBody(code, key, modifiers));
                         }
                     } else {
                         result->ErrorCode = Web::STATUS_BAD_REQUEST;
@@ -684,10 +879,7 @@ namespace Plugin {
                         }
 
                         if (fileName.empty() == false) {
-                            // Seems like we have a default mapping file. Load it..
-                            PluginHost::VirtualInput::KeyMap& map(_inputHandler->Table(deviceName));
-
-                            if (map.Save(fileName) == Core::ERROR_NONE) {
+                            if (SaveMap(deviceName, fileName) == Core::ERROR_NONE) {
                                 result->ErrorCode = Web::STATUS_OK;
                                 result->Message = string(_T("File is created: " + fileName));
                             }
@@ -708,9 +900,7 @@ namespace Plugin {
                         }
 
                         if (fileName.empty() == false) {
-                            PluginHost::VirtualInput::KeyMap& map(_inputHandler->Table(deviceName));
-
-                            if (map.Load(fileName) == Core::ERROR_NONE) {
+                            if (LoadMap(deviceName, fileName) == Core::ERROR_NONE) {
                                 result->ErrorCode = Web::STATUS_OK;
                                 result->Message = string(_T("File is reloaded: " + deviceName));
                             }
@@ -726,10 +916,7 @@ namespace Plugin {
                     if (ParseRequestBody(request, code, key, modifiers) == true) {
                         // Valid code-key pair
                         if (code != 0 && key != 0) {
-                            // Load default or specific device mapping
-                            PluginHost::VirtualInput::KeyMap& map(_inputHandler->Table(deviceName));
-
-                            if (map.Add(code, key, modifiers) == true) {
+                            if (ChangeMap(deviceName, change::ADD, code, key, static_cast<uint16_t>(modifiers)) == Core::ERROR_NONE) {
                                 result->ErrorCode = Web::STATUS_CREATED;
                                 result->Message = string(_T("Code is added"));
                             } else {
@@ -773,10 +960,7 @@ namespace Plugin {
 
                         if (code != 0) {
 
-                            // Load default or specific device mapping
-                            PluginHost::VirtualInput::KeyMap& map(_inputHandler->Table(deviceName));
-
-                            map.Delete(code);
+                            ChangeMap(deviceName, change::REMOVE, code, 0, 0);
 
                             result->ErrorCode = Web::STATUS_OK;
                             result->Message = string(_T("Code is deleted"));
@@ -818,10 +1002,7 @@ namespace Plugin {
                     if (ParseRequestBody(request, code, key, modifiers) == true) {
                         // Valid code-key pair
                         if (code != 0 && key != 0) {
-                            // Load default or specific device mapping
-                            PluginHost::VirtualInput::KeyMap& map(_inputHandler->Table(deviceName));
-
-                            if (map.Modify(code, key, modifiers) == true) {
+                            if (ChangeMap(deviceName, change::MODIFY, code, key, static_cast<uint16_t>(modifiers)) == Core::ERROR_NONE) {
                                 result->ErrorCode = Web::STATUS_OK;
                                 result->Message = string(_T("Code is modified"));
                             } else {
@@ -25,6 +25,10 @@
 #include <interfaces/IKeyHandler.h>
 #include <interfaces/IRemoteControl.h>
 
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+
 namespace WPEFramework {
 namespace Plugin {
 
@@ -188,6 +192,270 @@ namespace Plugin {
             Core::JSON::ArrayType<Core::JSON::String> Devices;
         };
 
+        class Statistics : public Core::JSON::Container {
+
+        private:
+            Statistics(const Statistics&) = delete;
+            Statistics& operator=(const Statistics&) = delete;
+
+        public:
+            Statistics()
+                : Core::JSON::Container()
+                , Translated(0)
+                , Unknown(0)
+            {
+                Add(_T("translated"), &Translated);
+                Add(_T("unknown"), &Unknown);
+            }
+
+            virtual ~Statistics()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt32 Translated;
+            Core::JSON::DecUInt32 Unknown;
+        };
+
+    private:
+        // A key map compiled for lookups. Codes that lie close together (the usual case)
+        // index a dense array directly, sparse codes go through an open addressed hash that
+        // is at most half full. A table is never changed once built; edits and reloads build
+        // a new one and swap it in.
+        class KeyTable {
+        public:
+            struct Entry {
+                uint32_t Code;
+                uint16_t Key;
+                uint16_t Modifiers;
+            };
+
+        public:
+            KeyTable() = delete;
+            KeyTable(const KeyTable&) = delete;
+            KeyTable& operator=(const KeyTable&) = delete;
+
+            // The entries must be sorted on code and unique, see Compile().
+            KeyTable(std::vector<Entry>&& entries)
+                : _entries(std::move(entries))
+                , _slots()
+                , _base(0)
+                , _shift(0)
+                , _mask(0)
+            {
+                if (_entries.empty() == false) {
+                    const uint64_t range = static_cast<uint64_t>(_entries.back().Code) - _entries.front().Code + 1;
+
+                    if (range <= std::max(static_cast<uint64_t>(256), static_cast<uint64_t>(_entries.size()) * 4)) {
+                        _base = _entries.front().Code;
+                        _slots.resize(static_cast<size_t>(range), 0);
+
+                        for (uint32_t index = 0; index < _entries.size(); index++) {
+                            _slots[_entries[index].Code - _base] = index + 1;
+                        }
+                    } else {
+                        uint8_t bits = 1;
+                        while ((static_cast<size_t>(1) << bits) < (_entries.size() * 2)) {
+                            bits++;
+                        }
+                        _shift = 32 - bits;
+                        _mask = (1 << bits) - 1;
+                        _slots.resize(static_cast<size_t>(1) << bits, 0);
+
+                        for (uint32_t index = 0; index < _entries.size(); index++) {
+                            uint32_t slot = Hash(_entries[index].Code);
+                            while (_slots[slot] != 0) {
+                                slot = (slot + 1) & _mask;
+                            }
+                            _slots[slot] = index + 1;
+                        }
+                    }
+                }
+            }
+            ~KeyTable()
+            {
+            }
+
+            static KeyTable* Compile(std::vector<Entry>& entries)
+            {
+                // The first definition of a code wins.
+                std::stable_sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) { return (lhs.Code < rhs.Code); });
+                entries.erase(std::unique(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) { return (lhs.Code == rhs.Code); }), entries.end());
+
+                return (new KeyTable(std::move(entries)));
+            }
+
+        public:
+            const std::vector<Entry>& Entries() const
+            {
+                return (_entries);
+            }
+            const Entry* Find(const uint32_t code) const
+            {
+                uint32_t slot;
+
+                if (_mask == 0) {
+                    slot = (((code - _base) < _slots.size()) ? _slots[code - _base] : 0);
+                } else {
+                    uint32_t index = Hash(code);
+                    while ((_slots[index] != 0) && (_entries[_slots[index] - 1].Code != code)) {
+                        index = (index + 1) & _mask;
+                    }
+                    slot = _slots[index];
+                }
+
+                return (slot != 0 ? &(_entries[slot - 1]) : nullptr);
+            }
+
+        private:
+            inline uint32_t Hash(const uint32_t code) const
+            {
+                return ((code * 0x9E3779B1) >> _shift);
+            }
+
+        private:
+            const std::vector<Entry> _entries;
+            std::vector<uint32_t> _slots;
+            uint32_t _base;
+            uint8_t _shift;
+            uint32_t _mask;
+        };
+
+        // Every device known at initialization gets one of these, the set does not change
+        // until deinitialization, so a key event finds its device without taking a lock.
+        // The table is swapped with a single pointer exchange; a reader pins it through the
+        // reader count for the few instructions it needs it, after which the writer can
+        // safely delete the table it replaced.
+        class Device {
+        public:
+            Device() = delete;
+            Device(const Device&) = delete;
+            Device& operator=(const Device&) = delete;
+
+            Device(const Device* fallback)
+                : _fallback(fallback)
+                , _passOn(false)
+                , _table(nullptr)
+                , _readers(0)
+                , _translated(0)
+                , _unknown(0)
+            {
+            }
+            ~Device()
+            {
+                delete _table.load();
+            }
+
+        public:
+            void PassOn(const bool enabled)
+            {
+                _passOn = enabled;
+            }
+            uint32_t Translated() const
+            {
+                return (_translated.load(std::memory_order_relaxed));
+            }
+            uint32_t Unknown() const
+            {
+                return (_unknown.load(std::memory_order_relaxed));
+            }
+
+            // The key goes in the lower and the modifiers in the upper 16 bits of the
+            // translated code, the way the pass-through tables of the VirtualInput take it.
+            uint32_t Translate(const uint32_t code, uint32_t& translated) const
+            {
+                uint32_t result = Resolve(code, translated);
+
+                if ((result == Core::ERROR_UNKNOWN_TABLE) && (_fallback != nullptr)) {
+                    result = _fallback->Resolve(code, translated);
+                }
+
+                if (result == Core::ERROR_NONE) {
+                    _translated.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    _unknown.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                return (result);
+            }
+            bool Get(const uint32_t code, uint16_t& key, uint16_t& modifiers) const
+            {
+                _readers.fetch_add(1);
+
+                const KeyTable* table = _table.load();
+                const KeyTable::Entry* entry = (table != nullptr ? table->Find(code) : nullptr);
+
+                if (entry != nullptr) {
+                    key = entry->Key;
+                    modifiers = entry->Modifiers;
+                }
+
+                _readers.fetch_sub(1);
+
+                return (entry != nullptr);
+            }
+
+            // Writer side, the caller serializes these.
+            const KeyTable* Table() const
+            {
+                return (_table.load());
+            }
+            void Publish(KeyTable* table)
+            {
+                KeyTable* old = _table.exchange(table);
+
+                while (_readers.load() != 0) {
+                    std::this_thread::yield();
+                }
+
+                delete old;
+            }
+
+        private:
+            uint32_t Resolve(const uint32_t code, uint32_t& translated) const
+            {
+                uint32_t result = Core::ERROR_UNKNOWN_TABLE;
+
+                _readers.fetch_add(1);
+
+                const KeyTable* table = _table.load();
+
+                if (table != nullptr) {
+                    const KeyTable::Entry* entry = table->Find(code);
+
+                    if (entry != nullptr) {
+                        translated = (entry->Key | (static_cast<uint32_t>(entry->Modifiers) << 16));
+                        result = Core::ERROR_NONE;
+                    } else if (_passOn == true) {
+                        translated = code;
+                        result = Core::ERROR_NONE;
+                    } else {
+                        result = Core::ERROR_UNKNOWN_KEY;
+                    }
+                }
+
+                _readers.fetch_sub(1);
+
+                return (result);
+            }
+
+        private:
+            const Device* _fallback;
+            bool _passOn;
+            std::atomic<KeyTable*> _table;
+            mutable std::atomic<uint32_t> _readers;
+            mutable std::atomic<uint32_t> _translated;
+            mutable std::atomic<uint32_t> _unknown;
+        };
+
+        using Devices = std::unordered_map<string, Device>;
+
+        enum class change : uint8_t {
+            ADD,
+            MODIFY,
+            REMOVE
+        };
+
     public:
         RemoteControl(const RemoteControl&) = delete;
         RemoteControl& operator=(const RemoteControl&) = delete;
@@ -358,6 +626,11 @@ namespace Plugin {
         bool ParseRequestBody(const Web::Request& request, uint32_t& code, uint16_t& key, uint32_t& modifiers);
         Core::ProxyType<Web::IBody> CreateResponseBody(uint32_t code, uint32_t key, uint16_t modifiers) const;
         void Activity(const IVirtualInput::KeyData::type type, const uint32_t code);
+        void AddDevice(const string& name, const bool passOn);
+        uint32_t LoadMap(const string& device, const string& fileName);
+        uint32_t SaveMap(const string& device, const string& fileName) const;
+        uint32_t ChangeMap(const string& device, const change what, const uint32_t code, const uint16_t key, const uint16_t modifiers);
+        bool GetKey(const string& device, const uint32_t code, uint16_t& key, uint16_t& modifiers) const;
 
         void RegisterAll();
         void UnregisterAll();
@@ -384,6 +657,9 @@ namespace Plugin {
         PluginHost::VirtualInput* _inputHandler;
         string _persistentPath;
         Feedback _feedback;
+        mutable Core::CriticalSection _adminLock;
+        Devices _devices;
+        Device* _default;
         Core::CriticalSection _eventLock;
         std::list<Exchange::IRemoteControl::INotification*> _notificationClients;
     };
@@ -191,15 +191,14 @@ namespace Plugin {
 
         if ((params.Device.IsSet() == true) && (params.Code.IsSet() == true) && (params.Code.Value() != 0)) {
             if ((IsVirtualDevice(params.Device.Value()) == true) || (IsPhysicalDevice(params.Device.Value()) == true)) {
-                // Load default or specific device mapping
-                PluginHost::VirtualInput::KeyMap& map(_inputHandler->Table(params.Device.Value()));
-                const PluginHost::VirtualInput::KeyMap::ConversionInfo* codeElements = map[params.Code.Value()];
+                uint16_t key = 0;
+                uint16_t modifiers = 0;
 
-                if (codeElements != nullptr) {
+                if (GetKey(params.Device.Value(), params.Code.Value(), key, modifiers) == true) {
                     response.Code = params.Code.Value();
-                    response.Key = codeElements->Code;
-                    if (codeElements->Modifiers != 0) {
-                        response.Modifiers = Modifiers(codeElements->Modifiers);
+                    response.Key = key;
+                    if (modifiers != 0) {
+                        response.Modifiers = Modifiers(modifiers);
                     }
                 } else {
                     result = Core::ERROR_UNKNOWN_KEY;
@@ -219,14 +218,7 @@ namespace Plugin {
 
         if ((params.Device.IsSet() == true) && (params.Code.IsSet() == true) && (params.Code.Value() != 0)) {
             if ((IsVirtualDevice(params.Device.Value()) == true) || (IsPhysicalDevice(params.Device.Value()) == true)) {
-                // Load default or specific device mapping
-                PluginHost::VirtualInput::KeyMap& map(_inputHandler->Table(params.Device.Value()));
-                const PluginHost::VirtualInput::KeyMap::ConversionInfo* codeElements = map[params.Code.Value()];
-                if (codeElements != nullptr) {
-                    map.Delete(params.Code.Value());
-                } else {
-                    result = Core::ERROR_UNKNOWN_KEY;
-                }
+                result = ChangeMap(params.Device.Value(), change::REMOVE, params.Code.Value(), 0, 0);
             } else {
                 result = Core::ERROR_UNAVAILABLE;
             }
@@ -242,11 +234,7 @@ namespace Plugin {
 
         if ((params.Device.IsSet() == true) && (params.Code.IsSet() == true) && (params.Code.Value() != 0) && (params.Key.IsSet()) && (params.Modifiers.IsSet())) {
             if ((IsVirtualDevice(params.Device.Value()) == true) || (IsPhysicalDevice(params.Device.Value()) == true)) {
-                // Load default or specific device mapping
-                PluginHost::VirtualInput::KeyMap& map(_inputHandler->Table(params.Device.Value()));
-                if (map.Modify(params.Code.Value(), params.Key.Value(), Modifiers(params.Modifiers)) == false) {
-                    result = Core::ERROR_UNKNOWN_KEY;
-                }
+                result = ChangeMap(params.Device.Value(), change::MODIFY, params.Code.Value(), params.Key.Value(), Modifiers(params.Modifiers));
             } else {
                 result = Core::ERROR_UNAVAILABLE;
             }
@@ -359,9 +347,7 @@ namespace Plugin {
                 }
 
                 if (fileName.empty() == false) {
-                    // Seems like we have a default mapping file. Load it..
-                    PluginHost::VirtualInput::KeyMap& map(_inputHandler->Table(params.Device.Value()));
-                    result = map.Save(fileName);
+                    result = SaveMap(params.Device.Value(), fileName);
                 } else {
                     result = Core::ERROR_GENERAL;
                 }
@@ -382,13 +368,8 @@ namespace Plugin {
             if ((IsVirtualDevice(params.Device.Value()) == true) || (IsPhysicalDevice(params.Device.Value()) == true)) {
                 string fileName = _persistentPath + params.Device.Value() + _T(".json");
 
-                if (Core::File(fileName).Exists() == true) {
-                    // Seems like we have a default mapping file. Load it..
-                    PluginHost::VirtualInput::KeyMap& map(_inputHandler->Table(params.Device.Value()));
-                    result = map.Load(fileName);
-                } else {
-                    result = Core::ERROR_OPENING_FAILED;
-                }
+                // Seems like we have a mapping file. Load it..
+                result = LoadMap(params.Device.Value(), fileName);
             } else {
                 result = Core::ERROR_UNAVAILABLE;
             }
@@ -403,9 +384,7 @@ namespace Plugin {
         uint32_t result = Core::ERROR_NONE;
         if ((params.Device.IsSet() == true) && (params.Code.IsSet() == true) && (params.Code.Value() != 0) && (params.Key.IsSet() == true)) {
             if ((IsVirtualDevice(params.Device.Value()) == true) || (IsPhysicalDevice(params.Device.Value()) == true)) {
-                // Load default or specific device mapping
-                PluginHost::VirtualInput::KeyMap& map(_inputHandler->Table(params.Device.Value()));
-                if (map.Add(params.Code.Value(), params.Key.Value(), Modifiers(params.Modifiers)) == false) {
+                if (ChangeMap(params.Device.Value(), change::ADD, params.Code.Value(), params.Key.Value(), Modifiers(params.Modifiers)) != Core::ERROR_NONE) {
                     result = Core::ERROR_UNKNOWN_KEY;
                 }
             } else {
@@ -49,13 +49,22 @@ namespace Plugin {
         Dispmanx(const Dispmanx&) = delete;
         Dispmanx& operator=(const Dispmanx&) = delete;
 
+        // A full frame is several MB, keep a few around instead of allocating one per capture.
+        static constexpr uint8_t MaxFrames = 2;
+
     public:
         Dispmanx()
+            : _adminLock()
+            , _frames()
+            , _resource(DISPMANX_NO_HANDLE)
+            , _width(0)
+            , _height(0)
         {
         }
 
         virtual ~Dispmanx()
         {
+            Clear();
         }
 
         BEGIN_INTERFACE_MAP(Dispmanx)
@@ -72,44 +81,103 @@ namespace Plugin {
 
             DISPMANX_DISPLAY_HANDLE_T display;
             DISPMANX_MODEINFO_T info;
-            DISPMANX_RESOURCE_HANDLE_T resource;
             VC_IMAGE_TYPE_T type = VC_IMAGE_ARGB8888;
             DISPMANX_TRANSFORM_T transform = static_cast<DISPMANX_TRANSFORM_T>(0);
             VC_RECT_T rect;
             uint32_t vc_image_ptr;
             int VARIABLE_IS_NOT_USED status = 0;
 
+            // Only the grabbing is serialized, encoding runs outside the lock, so a next
+            // capture can start while the previous frame is still being compressed.
+            _adminLock.Lock();
+
             display = vc_dispmanx_display_open(0);
 
             status = vc_dispmanx_display_get_info(display, &info);
             ASSERT(status == 0);
 
-            uint8_t* buffer = new uint8_t[info.width * 4 * info.height];
-            ASSERT(buffer != nullptr);
+            if ((info.width != _width) || (info.height != _height)) {
+                // Resolution changed (or first time), whatever we have cached is of no use.
+                Clear();
 
-            resource = vc_dispmanx_resource_create(type, info.width, info.height, &vc_image_ptr);
+                _width = info.width;
+                _height = info.height;
+                _resource = vc_dispmanx_resource_create(type, _width, _height, &vc_image_ptr);
+            }
 
-            vc_dispmanx_snapshot(display, resource, transform);
+            uint8_t* buffer = Acquire();
+            ASSERT(buffer != nullptr);
 
-            status = vc_dispmanx_rect_set(&rect, 0, 0, info.width, info.height);
-            ASSERT(status == 0);
+            vc_dispmanx_snapshot(display, _resource, transform);
 
-            status = vc_dispmanx_resource_read_data(resource, &rect, buffer, info.width * 4);
+            status = vc_dispmanx_rect_set(&rect, 0, 0, info.width, info.height);
             ASSERT(status == 0);
 
-            status = vc_dispmanx_resource_delete(resource);
+            status = vc_dispmanx_resource_read_data(_resource, &rect, buffer, info.width * 4);
             ASSERT(status == 0);
 
             status = vc_dispmanx_display_close(display);
             ASSERT(status == 0);
 
+            _adminLock.Unlock();
+
             // Save the buffer to file
             bool result = storer.R8_G8_B8_A8(static_cast<const unsigned char*>(buffer), info.width, info.height);
 
-            delete[] buffer;
+            Relinquish(buffer, info.width, info.height);
 
             return result;
         }
+
+    private:
+        uint8_t* Acquire()
+        {
+            uint8_t* result;
+
+            if (_frames.empty() == true) {
+                result = new uint8_t[_width * 4 * _height];
+            } else {
+                result = _frames.back();
+                _frames.pop_back();
+            }
+
+            return (result);
+        }
+        void Relinquish(uint8_t* buffer, const uint32_t width, const uint32_t height)
+        {
+            _adminLock.Lock();
+
+            if ((width == _width) && (height == _height) && (_frames.size() < MaxFrames)) {
+                _frames.push_back(buffer);
+                buffer = nullptr;
+            }
+
+            _adminLock.Unlock();
+
+            if (buffer != nullptr) {
+                delete[] buffer;
+            }
+        }
+        void Clear()
+        {
+            for (uint8_t* frame : _frames) {
+                delete[] frame;
+            }
+            _frames.clear();
+
+            if (_resource != DISPMANX_NO_HANDLE) {
+                int VARIABLE_IS_NOT_USED status = vc_dispmanx_resource_delete(_resource);
+                ASSERT(status == 0);
+                _resource = DISPMANX_NO_HANDLE;
+            }
+        }
+
+    private:
+        Core::CriticalSection _adminLock;
+        std::list<uint8_t*> _frames;
+        DISPMANX_RESOURCE_HANDLE_T _resource;
+        uint32_t _width;
+        uint32_t _height;
     };
 }
 
@@ -52,12 +52,20 @@ namespace Plugin {
         NexusCapture(const NexusCapture&) = delete;
         NexusCapture& operator=(const NexusCapture&) = delete;
 
+        // Surfaces are expensive to create, keep a few around instead of one per capture.
+        static constexpr uint8_t MaxSurfaces = 2;
+
     public:
         NexusCapture()
+            : _adminLock()
+            , _surfaces()
         {
         }
         virtual ~NexusCapture()
         {
+            for (NEXUS_SurfaceHandle surface : _surfaces) {
+                NEXUS_Surface_Destroy(surface);
+            }
         }
 
         BEGIN_INTERFACE_MAP(NexusCapture)
@@ -75,18 +83,29 @@ namespace Plugin {
             unsigned width = 1280, height = 720; // TODO: read from device or make it configurable
             NEXUS_SurfaceMemory mem;
             NEXUS_SurfaceHandle surface;
-            NEXUS_SurfaceCreateSettings createSettings;
             NEXUS_Error rc;
 
-            NEXUS_Surface_GetDefaultCreateSettings(&createSettings);
-            createSettings.pixelFormat = NEXUS_PixelFormat_eA8_R8_G8_B8;
-            createSettings.width = width;
-            createSettings.height = height;
+            // Only the grabbing is serialized, encoding runs outside the lock.
+            _adminLock.Lock();
 
-            surface = NEXUS_Surface_Create(&createSettings);
+            if (_surfaces.empty() == true) {
+                NEXUS_SurfaceCreateSettings createSettings;
+
+                NEXUS_Surface_GetDefaultCreateSettings(&createSettings);
+                createSettings.pixelFormat = NEXUS_PixelFormat_eA8_R8_G8_B8;
+                createSettings.width = width;
+                createSettings.height = height;
+
+                surface = NEXUS_Surface_Create(&createSettings);
+            } else {
+                surface = _surfaces.back();
+                _surfaces.pop_back();
+            }
 
             rc = NxClient_Screenshot(NULL, surface);
 
+            _adminLock.Unlock();
+
             if (rc == 0) {
 
                 NEXUS_Surface_GetMemory(surface, &mem); /* only needed for flush */
@@ -95,11 +114,26 @@ namespace Plugin {
                 storer.R8_G8_B8_A8(static_cast<const unsigned char*>(mem.buffer), width, height);
             }
 
-            // Release all surface related allocations
-            NEXUS_Surface_Destroy(surface);
+            // Hand the surface back, or release it if we have enough of them.
+            _adminLock.Lock();
+
+            if (_surfaces.size() < MaxSurfaces) {
+                _surfaces.push_back(surface);
+                surface = nullptr;
+            }
+
+            _adminLock.Unlock();
+
+            if (surface != nullptr) {
+                NEXUS_Surface_Destroy(surface);
+            }
 
             return (rc ? false : true);
         }
+
+    private:
+        Core::CriticalSection _adminLock;
+        std::list<NEXUS_SurfaceHandle> _surfaces;
     };
 }
 
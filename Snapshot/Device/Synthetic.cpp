@@ -0,0 +1,91 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+ 
+#include "../Module.h"
+
+#include <interfaces/ICapture.h>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Capture device without any graphics hardware behind it. It renders a moving
+    // gradient, so the capture and sampling paths can be exercised on any box.
+    class Synthetic : public Exchange::ICapture {
+    private:
+        Synthetic(const Synthetic&) = delete;
+        Synthetic& operator=(const Synthetic&) = delete;
+
+        static constexpr uint32_t Width = 1280;
+        static constexpr uint32_t Height = 720;
+
+    public:
+        Synthetic()
+            : _adminLock()
+            , _frame(Width * Height * 4)
+            , _count(0)
+        {
+        }
+        virtual ~Synthetic()
+        {
+        }
+
+        BEGIN_INTERFACE_MAP(Synthetic)
+        INTERFACE_ENTRY(Exchange::ICapture)
+        END_INTERFACE_MAP
+
+        virtual const TCHAR* Name() const
+        {
+            return (_T("Synthetic"));
+        }
+
+        virtual bool Capture(IStore& storer)
+        {
+            _adminLock.Lock();
+
+            const uint32_t shift = _count++;
+            uint8_t* pixel = _frame.data();
+
+            for (uint32_t y = 0; y < Height; y++) {
+                for (uint32_t x = 0; x < Width; x++) {
+                    *pixel++ = static_cast<uint8_t>(x + shift); // Blue
+                    *pixel++ = static_cast<uint8_t>(y + shift); // Green
+                    *pixel++ = static_cast<uint8_t>((x + y) >> 3); // Red
+                    *pixel++ = 0xFF; // Alpha
+                }
+            }
+
+            bool result = storer.R8_G8_B8_A8(_frame.data(), Width, Height);
+
+            _adminLock.Unlock();
+
+            return (result);
+        }
+
+    private:
+        Core::CriticalSection _adminLock;
+        std::vector<uint8_t> _frame;
+        uint32_t _count;
+    };
+}
+
+/* static */ Exchange::ICapture* Exchange::ICapture::Instance()
+{
+    return (Core::Service<Plugin::Synthetic>::Create<Exchange::ICapture>());
+}
+}
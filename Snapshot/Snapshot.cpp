@@ -26,6 +26,91 @@ namespace Plugin {
 
     SERVICE_REGISTRATION(Snapshot, 1, 0);
 
+    // Encoded images are kept in memory and handed to the response as is. The pool
+    // recycles the bodies, so their storage is reused for the next capture.
+    static Core::ProxyPoolType<Web::TextBody> imageBodies(2);
+    static Core::ProxyPoolType<Web::JSONBodyType<Core::JSON::ArrayType<Snapshot::FrameInfo>>> jsonFramesFactory(1);
+
+    static void WritePNG(png_structp pngPointer, png_bytep data, png_size_t length)
+    {
+        static_cast<string*>(png_get_io_ptr(pngPointer))->append(reinterpret_cast<const char*>(data), length);
+    }
+
+    static void FlushPNG(png_structp)
+    {
+    }
+
+    // Encodes a B, G, R, A frame as an RGB PNG into output.
+    static bool EncodePNG(string& output, const uint8_t* buffer, const uint32_t width, const uint32_t height, const int8_t compression, const bool filtering)
+    {
+        png_structp pngPointer = nullptr;
+        bool result = false;
+
+        pngPointer = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+        if (pngPointer == nullptr) {
+
+            return result;
+        }
+
+        png_infop infoPointer = nullptr;
+        infoPointer = png_create_info_struct(pngPointer);
+        if (infoPointer == nullptr) {
+
+            png_destroy_write_struct(&pngPointer, &infoPointer);
+            return result;
+        }
+
+        // Set up error handling.
+        if (setjmp(png_jmpbuf(pngPointer))) {
+
+            png_destroy_write_struct(&pngPointer, &infoPointer);
+            return result;
+        }
+
+        output.clear();
+        png_set_write_fn(pngPointer, &output, WritePNG, FlushPNG);
+
+        // Set image attributes.
+        int depth = 8;
+        png_set_IHDR(pngPointer,
+            infoPointer,
+            width,
+            height,
+            depth,
+            PNG_COLOR_TYPE_RGB,
+            PNG_INTERLACE_NONE,
+            PNG_COMPRESSION_TYPE_DEFAULT,
+            PNG_FILTER_TYPE_DEFAULT);
+
+        if (compression >= 0) {
+            png_set_compression_level(pngPointer, compression);
+        }
+        if (filtering == false) {
+            png_set_filter(pngPointer, PNG_FILTER_TYPE_BASE, PNG_FILTER_NONE);
+        }
+
+        png_write_info(pngPointer, infoPointer);
+
+        // The frame is B, G, R, A in memory. Let libpng swap to RGB and drop the alpha
+        // while it consumes the rows, so the frame is used as is, without a converted copy.
+        png_set_filler(pngPointer, 0, PNG_FILLER_AFTER);
+        png_set_bgr(pngPointer);
+
+        const int pixelSize = 4; // RGBA
+        for (unsigned int i = 0; i < height; ++i) {
+            png_write_row(pngPointer, const_cast<png_bytep>(buffer + (sizeof(png_byte) * i * width * pixelSize)));
+        }
+
+        png_write_end(pngPointer, nullptr);
+
+        // All went well.
+        result = true;
+
+        png_destroy_write_struct(&pngPointer, &infoPointer);
+
+        return result;
+    }
+
     class StoreImpl : public Exchange::ICapture::IStore {
     private:
         StoreImpl() = delete;
@@ -33,8 +118,10 @@ namespace Plugin {
         StoreImpl& operator=(const StoreImpl&) = delete;
 
     public:
-        StoreImpl(Core::BinairySemaphore& inProgress, const string& path)
-            : _file(FileBodyExtended::Instance(inProgress, path))
+        StoreImpl(const int8_t compression, const bool filtering)
+            : _body(imageBodies.Element())
+            , _compression(compression)
+            , _filtering(filtering)
         {
         }
 
@@ -44,158 +131,212 @@ namespace Plugin {
 
         virtual bool R8_G8_B8_A8(const unsigned char* buffer, const unsigned int width, const unsigned int height)
         {
+            // Encode straight into the response body.
+            return (EncodePNG(*_body, buffer, width, height, _compression, _filtering));
+        }
 
-            png_structp pngPointer = nullptr;
-            bool result = false;
+        operator Core::ProxyType<Web::TextBody>()
+        {
 
-            pngPointer = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
-            if (pngPointer == nullptr) {
+            return (_body);
+        }
 
-                return result;
-            }
+    private:
+        Core::ProxyType<Web::TextBody> _body;
+        const int8_t _compression;
+        const bool _filtering;
+    };
 
-            png_infop infoPointer = nullptr;
-            infoPointer = png_create_info_struct(pngPointer);
-            if (infoPointer == nullptr) {
+    // Shrinks the frame with a box filter, before it is encoded into a sample.
+    class SampleStore : public Exchange::ICapture::IStore {
+    private:
+        SampleStore() = delete;
+        SampleStore(const SampleStore&) = delete;
+        SampleStore& operator=(const SampleStore&) = delete;
 
-                png_destroy_write_struct(&pngPointer, &infoPointer);
-                return result;
-            }
+    public:
+        SampleStore(std::vector<uint8_t>& scratch, Snapshot::Sampler::Frame& frame, const uint8_t downscale, const int8_t compression, const bool filtering)
+            : _scratch(scratch)
+            , _frame(frame)
+            , _downscale(downscale == 0 ? 1 : downscale)
+            , _compression(compression)
+            , _filtering(filtering)
+        {
+        }
 
-            // Set up error handling.
-            if (setjmp(png_jmpbuf(pngPointer))) {
+        virtual ~SampleStore()
+        {
+        }
 
-                png_destroy_write_struct(&pngPointer, &infoPointer);
-                return result;
-            }
+        virtual bool R8_G8_B8_A8(const unsigned char* buffer, const unsigned int width, const unsigned int height)
+        {
+            const uint32_t scaledWidth = width / _downscale;
+            const uint32_t scaledHeight = height / _downscale;
+            const uint32_t area = _downscale * _downscale;
+
+            _scratch.resize(scaledWidth * scaledHeight * 4);
 
-            // Set image attributes.
-            int depth = 8;
-            png_set_IHDR(pngPointer,
-                infoPointer,
-                width,
-                height,
-                depth,
-                PNG_COLOR_TYPE_RGB,
-                PNG_INTERLACE_NONE,
-                PNG_COMPRESSION_TYPE_DEFAULT,
-                PNG_FILTER_TYPE_DEFAULT);
-
-            // Initialize rows of PNG.
-            png_byte** rowLines = static_cast<png_byte**>(png_malloc(pngPointer, height * sizeof(png_byte*)));
-            const int pixelSize = 4; // RGBA
-            for (unsigned int i = 0; i < height; ++i) {
-
-                png_byte* rowLine = static_cast<png_byte*>(png_malloc(pngPointer, sizeof(png_byte) * width * pixelSize));
-                const uint8_t* rowSource = buffer + (sizeof(png_byte) * i * width * pixelSize);
-                rowLines[i] = rowLine;
-                for (unsigned int j = 0; j < width * pixelSize; j += pixelSize) {
-                    *rowLine++ = rowSource[j + 2]; // Red
-                    *rowLine++ = rowSource[j + 1]; // Green
-                    *rowLine++ = rowSource[j + 0]; // Blue
-                    // ignore alpha
+            uint8_t* target = _scratch.data();
+
+            for (uint32_t y = 0; y < scaledHeight; y++) {
+                const uint8_t* row = buffer + (y * _downscale * width * 4);
+
+                for (uint32_t x = 0; x < scaledWidth; x++) {
+                    uint32_t sum[4] = { 0, 0, 0, 0 };
+                    const uint8_t* block = row + (x * _downscale * 4);
+
+                    for (uint8_t line = 0; line < _downscale; line++) {
+                        const uint8_t* pixel = block + (line * width * 4);
+
+                        for (uint8_t column = 0; column < _downscale; column++, pixel += 4) {
+                            sum[0] += pixel[0];
+                            sum[1] += pixel[1];
+                            sum[2] += pixel[2];
+                            sum[3] += pixel[3];
+                        }
+                    }
+
+                    *target++ = static_cast<uint8_t>(sum[0] / area);
+                    *target++ = static_cast<uint8_t>(sum[1] / area);
+                    *target++ = static_cast<uint8_t>(sum[2] / area);
+                    *target++ = static_cast<uint8_t>(sum[3] / area);
                 }
             }
 
-            // Duplicate file descriptor and create File stream based on it.
-            FILE* filePointer = static_cast<FILE*>(*_file);
-            if (nullptr != filePointer) {
-                // Write the image data to "file".
-                png_init_io(pngPointer, filePointer);
-                png_set_rows(pngPointer, infoPointer, rowLines);
-                png_write_png(pngPointer, infoPointer, PNG_TRANSFORM_IDENTITY, nullptr);
-                // All went well.
-                result = true;
-            }
+            _frame.Width = scaledWidth;
+            _frame.Height = scaledHeight;
 
-            // Close stream to flush and release allocated buffers
-            fclose(filePointer);
+            return (EncodePNG(_frame.Image, _scratch.data(), scaledWidth, scaledHeight, _compression, _filtering));
+        }
 
-            for (unsigned int i = 0; i < height; i++) {
-                png_free(pngPointer, rowLines[i]);
-            }
+    private:
+        std::vector<uint8_t>& _scratch;
+        Snapshot::Sampler::Frame& _frame;
+        const uint8_t _downscale;
+        const int8_t _compression;
+        const bool _filtering;
+    };
 
-            png_free(pngPointer, rowLines);
-            png_destroy_write_struct(&pngPointer, &infoPointer);
+    void Snapshot::Sampler::Start(const uint16_t interval, const uint8_t depth, const uint8_t downscale)
+    {
+        _adminLock.Lock();
 
-            return result;
+        _interval = interval;
+        _depth = (depth == 0 ? 1 : depth);
+        _downscale = downscale;
+
+        _adminLock.Unlock();
+
+        Core::ProxyType<Core::IDispatch> job(*this);
+        Core::IWorkerPool::Instance().Submit(job);
+    }
+
+    void Snapshot::Sampler::Stop()
+    {
+        Core::ProxyType<Core::IDispatch> job(*this);
+
+        // A running sample should not schedule the next one anymore.
+        _adminLock.Lock();
+        _interval = 0;
+        _adminLock.Unlock();
+
+        Core::IWorkerPool::Instance().Revoke(job);
+
+        _adminLock.Lock();
+        _frames.clear();
+        _adminLock.Unlock();
+    }
+
+    void Snapshot::Sampler::Frames(Core::JSON::ArrayType<FrameInfo>& info) const
+    {
+        _adminLock.Lock();
+
+        for (const Frame& frame : _frames) {
+            FrameInfo& entry(info.Add());
+            entry.Sequence = frame.Sequence;
+            entry.Timestamp = frame.Timestamp;
+            entry.Width = frame.Width;
+            entry.Height = frame.Height;
         }
 
-        operator Core::ProxyType<Web::IBody>()
-        {
+        _adminLock.Unlock();
+    }
+
+    bool Snapshot::Sampler::Image(const uint32_t sequence, string& image) const
+    {
+        bool result = false;
+
+        _adminLock.Lock();
 
-            return Core::ProxyType<Web::IBody>(*_file);
+        std::list<Frame>::const_iterator index(_frames.begin());
+
+        // A sequence of 0 means the most recent one.
+        if ((sequence == 0) && (_frames.empty() == false)) {
+            index = std::prev(_frames.end());
+        } else {
+            while ((index != _frames.end()) && (index->Sequence != sequence)) {
+                index++;
+            }
         }
 
-        bool IsValid()
-        {
-            return (_file.IsValid());
+        if (index != _frames.end()) {
+            image = index->Image;
+            result = true;
         }
 
-        class FileBodyExtended : public Web::FileBody {
-        private:
-            FileBodyExtended() = delete;
-            FileBodyExtended(const FileBodyExtended&) = delete;
-            FileBodyExtended& operator=(const FileBodyExtended&) = delete;
-
-        protected:
-            FileBodyExtended(Core::BinairySemaphore* semLock, const string& path)
-                : Web::FileBody(path, false)
-                , _semLock(*semLock)
-            {
-                // Already exist, due to unexpected termination!
-                if (true == Core::File::Exists()) {
-                    // Close and remove file
-                    Core::File::Destroy();
-                }
+        _adminLock.Unlock();
 
-                Core::File::Create();
-            }
+        return (result);
+    }
 
-        public:
-            virtual ~FileBodyExtended()
-            {
-                Core::File::Destroy();
+    /* virtual */ void Snapshot::Sampler::Dispatch()
+    {
+        Frame sample;
 
-                // Signal, It is ready for new capture
-                _semLock.Unlock();
-            }
+        _adminLock.Lock();
 
-        public:
-            static Core::ProxyType<FileBodyExtended> Instance(Core::BinairySemaphore& semLock, const string& fileName)
-            {
-                Core::ProxyType<FileBodyExtended> result;
+        // Recycle the oldest frame, its image storage is reused for the new one.
+        if (_frames.size() >= _depth) {
+            sample.Image.swap(_frames.front().Image);
+            _frames.pop_front();
+        }
 
-                if (semLock.Lock(0) == Core::ERROR_NONE) {
-                    // We got the lock, forward it to the filebody
-                    result = Core::ProxyType<FileBodyExtended>::Create(&semLock, fileName);
-                }
+        const uint8_t downscale = _downscale;
 
-                return (result);
-            }
+        _adminLock.Unlock();
 
-        private:
-            Core::BinairySemaphore& _semLock;
-        };
+        SampleStore store(_scratch, sample, downscale, _parent._compression, _parent._filtering);
 
-    private:
-        Core::ProxyType<FileBodyExtended> _file;
-    };
+        if (_parent._device->Capture(store) == true) {
+            sample.Timestamp = Core::Time::Now().Ticks() / Core::Time::TicksPerMillisecond;
+
+            _adminLock.Lock();
+            sample.Sequence = ++_sequence;
+            _frames.push_back(std::move(sample));
+            _adminLock.Unlock();
+        }
+
+        _adminLock.Lock();
+
+        if (_interval != 0) {
+            Core::ProxyType<Core::IDispatch> job(*this);
+            Core::IWorkerPool::Instance().Schedule(Core::Time::Now().Add(_interval), job);
+        }
+
+        _adminLock.Unlock();
+    }
 
     /* virtual */ const string Snapshot::Initialize(PluginHost::IShell* service)
     {
         string result;
+        Config config;
+        config.FromString(service->ConfigLine());
 
-        // Capture PNG file name
-        ASSERT(service->PersistentPath() != _T(""));
         ASSERT(_device == nullptr);
 
-        Core::Directory directory(service->PersistentPath().c_str());
-        if (directory.CreatePath()) {
-            _fileName = service->PersistentPath() + string("Capture.png");
-        } else {
-            _fileName = string("/tmp/Capture.png");
-        }
+        _compression = config.Compression.Value();
+        _filtering = config.Filtering.Value();
+        _samplingInterval = config.Sampling.Interval.Value();
 
         // Setup skip URL for right offset.
         _skipURL = service->WebPrefix().length();
@@ -205,6 +346,10 @@ namespace Plugin {
 
         if (_device != nullptr) {
             TRACE_L1(_T("Capture device: %s"), _device->Name());
+
+            if (_samplingInterval != 0) {
+                _sampler->Start(_samplingInterval, config.Sampling.Frames.Value(), config.Sampling.Downscale.Value());
+            }
         } else {
             result = string("No capture device is registered");
         }
@@ -217,6 +362,10 @@ namespace Plugin {
 
         ASSERT(_device != nullptr);
 
+        if (_samplingInterval != 0) {
+            _sampler->Stop();
+        }
+
         if (_device != nullptr) {
             _device->Release();
             _device = nullptr;
@@ -259,25 +408,49 @@ namespace Plugin {
                 response->ErrorCode = Web::STATUS_OK;
             } else if ((index.Current() == "Capture")) {
 
-                StoreImpl file(_inProgress, _fileName);
+                StoreImpl image(_compression, _filtering);
+
+                if (_device->Capture(image)) {
 
-                // _inProgress event is signalled, capture screen
-                if (file.IsValid() == true) {
+                    // Attach to response.
+                    response->ContentType = Web::MIMETypes::MIME_IMAGE_PNG;
+                    response->Body<Web::TextBody>(static_cast<Core::ProxyType<Web::TextBody>>(image));
+                    response->Message = string(_device->Name());
+                    response->ErrorCode = Web::STATUS_ACCEPTED;
+                } else {
+                    response->Message = _T("Could not create a capture on ") + string(_device->Name());
+                    response->ErrorCode = Web::STATUS_PRECONDITION_FAILED;
+                }
+            } else if ((index.Current() == "Frames") && (_samplingInterval != 0)) {
+
+                if (index.Next() == false) {
+                    // List what is sampled, clients only need to fetch the frames they do not have yet.
+                    Core::ProxyType<Web::JSONBodyType<Core::JSON::ArrayType<FrameInfo>>> frames(jsonFramesFactory.Element());
 
-                    if (_device->Capture(file)) {
+                    frames->Clear();
+                    _sampler->Frames(*frames);
 
-                        // Attach to response.
+                    response->ContentType = Web::MIMETypes::MIME_JSON;
+                    response->Body(Core::proxy_cast<Web::IBody>(frames));
+                    response->Message = _T("Sampled frames");
+                    response->ErrorCode = Web::STATUS_OK;
+                } else {
+                    // "Latest" or the sequence number of the frame.
+                    const uint32_t sequence = (index.Current() == "Latest" ? 0 : Core::NumberType<uint32_t>(index.Current()).Value());
+                    Core::ProxyType<Web::TextBody> image(imageBodies.Element());
+
+                    if ((sequence == 0) && (index.Current() != "Latest")) {
+                        response->Message = _T("Invalid frame identifier");
+                        response->ErrorCode = Web::STATUS_BAD_REQUEST;
+                    } else if (_sampler->Image(sequence, *image) == true) {
                         response->ContentType = Web::MIMETypes::MIME_IMAGE_PNG;
-                        response->Body(static_cast<Core::ProxyType<Web::IBody>>(file));
+                        response->Body<Web::TextBody>(image);
                         response->Message = string(_device->Name());
-                        response->ErrorCode = Web::STATUS_ACCEPTED;
+                        response->ErrorCode = Web::STATUS_OK;
                     } else {
-                        response->Message = _T("Could not create a capture on ") + string(_device->Name());
-                        response->ErrorCode = Web::STATUS_PRECONDITION_FAILED;
+                        response->Message = _T("Frame not available");
+                        response->ErrorCode = Web::STATUS_NOT_FOUND;
                     }
-                } else {
-                    response->Message = _T("Plugin is already in progress");
-                    response->ErrorCode = Web::STATUS_PRECONDITION_FAILED;
                 }
             }
         }
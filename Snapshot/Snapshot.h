@@ -32,13 +32,187 @@ namespace Plugin {
         Snapshot& operator=(const Snapshot&) = delete;
 
     public:
+        class Config : public Core::JSON::Container {
+        private:
+            Config(const Config&) = delete;
+            Config& operator=(const Config&) = delete;
+
+        public:
+            class SamplingConfig : public Core::JSON::Container {
+            private:
+                SamplingConfig(const SamplingConfig&) = delete;
+                SamplingConfig& operator=(const SamplingConfig&) = delete;
+
+            public:
+                SamplingConfig()
+                    : Core::JSON::Container()
+                    , Interval(0)
+                    , Frames(4)
+                    , Downscale(4)
+                {
+                    Add(_T("interval"), &Interval);
+                    Add(_T("frames"), &Frames);
+                    Add(_T("downscale"), &Downscale);
+                }
+                ~SamplingConfig()
+                {
+                }
+
+            public:
+                // ms between samples, 0 disables sampling.
+                Core::JSON::DecUInt16 Interval;
+                // Number of samples kept.
+                Core::JSON::DecUInt8 Frames;
+                // Divider applied to width and height of the screen.
+                Core::JSON::DecUInt8 Downscale;
+            };
+
+        public:
+            Config()
+                : Core::JSON::Container()
+                , Compression(-1)
+                , Filtering(true)
+                , Sampling()
+            {
+                Add(_T("compression"), &Compression);
+                Add(_T("filtering"), &Filtering);
+                Add(_T("sampling"), &Sampling);
+            }
+            ~Config()
+            {
+            }
+
+        public:
+            // zlib level, 0 (store) - 9 (best), -1 is the zlib default.
+            Core::JSON::DecSInt8 Compression;
+            // Adaptive row filtering, makes the image smaller but is the most expensive step.
+            Core::JSON::Boolean Filtering;
+            SamplingConfig Sampling;
+        };
+
+        class FrameInfo : public Core::JSON::Container {
+        public:
+            FrameInfo()
+                : Core::JSON::Container()
+            {
+                Init();
+            }
+            FrameInfo(const FrameInfo& copy)
+                : Core::JSON::Container()
+                , Sequence(copy.Sequence)
+                , Timestamp(copy.Timestamp)
+                , Width(copy.Width)
+                , Height(copy.Height)
+            {
+                Init();
+            }
+            FrameInfo& operator=(const FrameInfo& rhs)
+            {
+                Sequence = rhs.Sequence;
+                Timestamp = rhs.Timestamp;
+                Width = rhs.Width;
+                Height = rhs.Height;
+
+                return (*this);
+            }
+            ~FrameInfo()
+            {
+            }
+
+        private:
+            void Init()
+            {
+                Add(_T("sequence"), &Sequence);
+                Add(_T("timestamp"), &Timestamp);
+                Add(_T("width"), &Width);
+                Add(_T("height"), &Height);
+            }
+
+        public:
+            Core::JSON::DecUInt32 Sequence;
+            Core::JSON::DecUInt64 Timestamp; // ms since epoch
+            Core::JSON::DecUInt32 Width;
+            Core::JSON::DecUInt32 Height;
+        };
+
+        // Periodically grabs a small version of the screen and keeps the last few of them,
+        // so the screen can be followed without full resolution captures for every look.
+        class Sampler : public Core::IDispatch {
+        private:
+            Sampler() = delete;
+            Sampler(const Sampler&) = delete;
+            Sampler& operator=(const Sampler&) = delete;
+
+        public:
+            struct Frame {
+                Frame()
+                    : Sequence(0)
+                    , Timestamp(0)
+                    , Width(0)
+                    , Height(0)
+                    , Image()
+                {
+                }
+
+                uint32_t Sequence;
+                uint64_t Timestamp;
+                uint32_t Width;
+                uint32_t Height;
+                string Image;
+            };
+
+        public:
+            Sampler(Snapshot* parent)
+                : _parent(*parent)
+                , _adminLock()
+                , _interval(0)
+                , _depth(1)
+                , _downscale(1)
+                , _sequence(0)
+                , _frames()
+                , _scratch()
+            {
+            }
+            virtual ~Sampler()
+            {
+            }
+
+        public:
+            void Start(const uint16_t interval, const uint8_t depth, const uint8_t downscale);
+            void Stop();
+
+            void Frames(Core::JSON::ArrayType<FrameInfo>& info) const;
+            bool Image(const uint32_t sequence, string& image) const;
+
+            virtual void Dispatch() override;
+
+        private:
+            Snapshot& _parent;
+            mutable Core::CriticalSection _adminLock;
+            uint16_t _interval;
+            uint8_t _depth;
+            uint8_t _downscale;
+            uint32_t _sequence;
+            std::list<Frame> _frames;
+            std::vector<uint8_t> _scratch;
+        };
+
+    public:
+#ifdef __WINDOWS__
+#pragma warning(disable : 4355)
+#endif
         Snapshot()
             : _skipURL(0)
             , _device(nullptr)
-            , _fileName()
-            , _inProgress(false)
+            , _compression(-1)
+            , _filtering(true)
+            , _samplingInterval(0)
+            , _sampler(Core::ProxyType<Sampler>::Create(this))
         {
         }
+#ifdef __WINDOWS__
+#pragma warning(default : 4355)
+#endif
 
         virtual ~Snapshot()
         {
@@ -65,8 +239,10 @@ namespace Plugin {
     private:
         uint8_t _skipURL;
         Exchange::ICapture* _device;
-        string _fileName;
-        Core::BinairySemaphore _inProgress;
+        int8_t _compression;
+        bool _filtering;
+        uint16_t _samplingInterval;
+        Core::ProxyType<Sampler> _sampler;
     };
 
 } // Namespace Plugin.
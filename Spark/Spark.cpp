@@ -18,6 +18,7 @@
  */
  
 #include "Spark.h"
+#include "MemoryPressure.h"
 
 namespace WPEFramework {
 
@@ -55,6 +56,7 @@ namespace Plugin {
         // instantiation.
         _service->Register(&_notification);
 
+        MemoryPressureObserver::Host();
         _spark = _service->Root<Exchange::IBrowser>(_connectionId, 3000, _T("SparkImplementation"));
 
         if (_spark != nullptr) {
@@ -137,8 +139,7 @@ namespace Plugin {
 
     /* virtual */ string Spark::Information() const
     {
-        // No additional info to report.
-        return (string());
+        return (MemoryPressureObserver::Report(_service));
     }
 
     /* virtual */ void Spark::Inbound(Web::Request& request)
@@ -20,6 +20,8 @@
 #include "Module.h"
 #include <interfaces/IMemory.h>
 #include <interfaces/IBrowser.h>
+#include "MemoryObserver.h"
+#include "MemoryPressure.h"
 
 #include <fstream>
 #include <pxFont.h>
@@ -44,7 +46,7 @@ extern bool topSparkView;
 namespace WPEFramework {
 namespace Plugin {
 
-    class SparkImplementation : public Exchange::IBrowser, public PluginHost::IStateControl {
+    class SparkImplementation : public Exchange::IBrowser, public PluginHost::IStateControl, public MemoryPressureObserver::ITrimmer {
     private:
         class Config : public Core::JSON::Container {
         private:
@@ -67,6 +69,7 @@ namespace Plugin {
                 Add(_T("animationfps"), &AnimationFPS);
                 Add(_T("egl"), &EGLProvider);
                 Add(_T("clientidentifier"), &ClientIdentifier);
+                Add(_T("memorytrim"), &MemoryTrim);
             }
             ~Config() {}
 
@@ -77,6 +80,7 @@ namespace Plugin {
             Core::JSON::DecUInt8 AnimationFPS;
             Core::JSON::String ClientIdentifier;
             Core::JSON::String EGLProvider;
+            MemoryPressureObserver::Config MemoryTrim;
         };
 
        class NotificationSink : public Core::Thread {
@@ -229,6 +233,36 @@ namespace Plugin {
                 bool _hide;
             };
 
+            class TrimImplementation : public ICommand {
+            public:
+                TrimImplementation() = delete;
+                TrimImplementation(const TrimImplementation&) = delete;
+                TrimImplementation& operator= (const TrimImplementation&) = delete;
+
+                TrimImplementation(const MemoryPressureObserver::level level)
+                    : _level(level) {
+                }
+                virtual ~TrimImplementation() {
+                }
+
+            public:
+                virtual void Execute() override {
+                    ENTERSCENELOCK();
+
+                    // Fonts are loaded again when they are used, the rest is for the garbage
+                    // collector, which also releases the images of the scene objects that are gone.
+                    if (_level >= MemoryPressureObserver::CRITICAL) {
+                        pxFontManager::clearAllFonts();
+                    }
+                    script.collectGarbage();
+
+                    EXITSCENELOCK();
+                }
+
+            private:
+                const MemoryPressureObserver::level _level;
+            };
+
         public:
             SceneWindow()
                 : Core::Thread(Core::Thread::DefaultStackSize(), _T("Spark"))
@@ -431,6 +465,17 @@ namespace Plugin {
                 return (result);
             }
 
+            void Trim(const MemoryPressureObserver::level level)
+            {
+                if (gUIThreadQueue)
+                {
+                    gUIThreadQueue->addTask(
+                        windowThread,
+                        nullptr,
+                        static_cast<ICommand*>(new TrimImplementation(level)));
+                }
+            }
+
             uint8_t AnimationFPS() const
             {
                 return (_animationFPS);
@@ -682,11 +727,13 @@ namespace Plugin {
             , _sparkClients()
             , _stateControlClients()
             , _sink(*this)
+            , _pressure(*this)
         {
         }
 
         virtual ~SparkImplementation()
         {
+            _pressure.Close();
         }
 
         virtual uint32_t Configure(PluginHost::IShell* service)
@@ -695,6 +742,13 @@ namespace Plugin {
 
             _state = PluginHost::IStateControl::RESUMED;
 
+            Config config;
+            config.FromString(service->ConfigLine());
+
+            if ((config.MemoryTrim.Enabled.Value() == true) && (_pressure.Open(config.MemoryTrim, MemoryPressureObserver::FileName(service)) != Core::ERROR_NONE)) {
+                SYSLOG(Logging::Notification, (_T("Could not observe the memory pressure through %s"), config.MemoryTrim.Source.Value().c_str()));
+            }
+
             return (result);
         }
         virtual void SetURL(const string& URL) override {
@@ -850,6 +904,11 @@ namespace Plugin {
         END_INTERFACE_MAP
 
     private:
+        // MemoryPressureObserver::ITrimmer
+        void Trim(const MemoryPressureObserver::level which) override
+        {
+            _window.Trim(which);
+        }
 
         inline bool RequestForStateChange(const PluginHost::IStateControl::command command)
         {
@@ -897,6 +956,7 @@ namespace Plugin {
         std::list<Exchange::IBrowser::INotification*> _sparkClients;
         std::list<PluginHost::IStateControl::INotification*> _stateControlClients;
         NotificationSink _sink;
+        MemoryPressureObserver _pressure;
     };
 
     SERVICE_REGISTRATION(SparkImplementation, 1, 0);
@@ -905,50 +965,9 @@ namespace Plugin {
 
 namespace Spark {
 
-    class MemoryObserverImpl : public Exchange::IMemory {
-    private:
-        MemoryObserverImpl();
-        MemoryObserverImpl(const MemoryObserverImpl&);
-        MemoryObserverImpl& operator=(const MemoryObserverImpl&);
-
-    public:
-        MemoryObserverImpl(const uint32_t id)
-            : _main(id == 0 ? Core::ProcessInfo().Id() : id)
-        {
-        }
-        ~MemoryObserverImpl() {}
-
-    public:
-        virtual uint64_t Resident() const
-        {
-            return _main.Resident();
-        }
-        virtual uint64_t Allocated() const
-        {
-            return _main.Allocated();
-        }
-        virtual uint64_t Shared() const
-        {
-            return _main.Shared();
-        }
-        virtual uint8_t Processes() const { return (IsOperational() ? 1 : 0); }
-
-        virtual const bool IsOperational() const
-        {
-            return _main.IsActive();
-        }
-
-        BEGIN_INTERFACE_MAP(MemoryObserverImpl)
-        INTERFACE_ENTRY(Exchange::IMemory)
-        END_INTERFACE_MAP
-
-    private:
-        Core::ProcessInfo _main;
-    };
-
     Exchange::IMemory* MemoryObserver(const uint32_t PID)
     {
-        return (Core::Service<MemoryObserverImpl>::Create<Exchange::IMemory>(PID));
+        return (Core::Service<Plugin::MemoryObserverImpl>::Create<Exchange::IMemory>(PID));
     }
 }
 } // namespace
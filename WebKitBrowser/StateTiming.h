@@ -0,0 +1,173 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+#include <atomic>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // The WebKitImplementation typically runs out of process. It publishes how long the phases
+    // of its last suspend and resume took in a small file backed memory block, from which the
+    // plugin reports them. The implementation is the only writer (from its main loop), so a
+    // sequence count is all it takes for the plugin to read a consistent record.
+    class StateTiming {
+    public:
+        enum phase : uint8_t {
+            DISPATCH, // From the request until the main loop picks it up.
+            VISIBILITY, // Hiding or showing the page, drops or restores its graphics.
+            TRANSITION, // WebKit suspend or resume, pauses or restarts the JS timers and animations.
+            COLLECT, // Garbage collecting the JS heap (pre-warm only).
+            NOTIFY, // Notifying the state change.
+            PHASES
+        };
+
+        struct Record {
+            uint32_t Phases[PHASES]; // In us
+            uint32_t Total; // In us
+            uint32_t Count; // Transitions so far
+        };
+
+    private:
+        struct Block {
+            std::atomic<uint32_t> Sequence; // Odd while being written
+            Record Suspend;
+            Record Resume;
+            uint32_t Target; // Resume target, in ms, 0 if there is none
+            uint32_t Missed; // Resumes that took longer than the target
+        };
+
+    public:
+        StateTiming() = delete;
+        StateTiming(const StateTiming&) = delete;
+        StateTiming& operator=(const StateTiming&) = delete;
+
+        StateTiming(const string& fileName, const bool writer)
+            : _file(fileName, Core::File::USER_READ | Core::File::USER_WRITE | Core::File::SHAREABLE, (writer == true ? sizeof(Block) : 0))
+            , _block(nullptr)
+            , _start(0)
+            , _mark(0)
+            , _current()
+        {
+            if ((_file.IsValid() == true) && (_file.Size() >= sizeof(Block))) {
+                _block = reinterpret_cast<Block*>(_file.Buffer());
+
+                if (writer == true) {
+                    ::memset(static_cast<void*>(_block), 0, sizeof(Block));
+                }
+            }
+        }
+        ~StateTiming()
+        {
+        }
+
+        static string FileName(const PluginHost::IShell* service)
+        {
+            return (service->VolatilePath() + service->Callsign() + _T(".timing"));
+        }
+
+    public:
+        bool IsValid() const
+        {
+            return (_block != nullptr);
+        }
+
+        // Writer side, all from the main loop of the browser.
+        void Target(const uint32_t target)
+        {
+            if (_block != nullptr) {
+                _block->Target = target;
+            }
+        }
+        void Begin(const uint64_t requested)
+        {
+            _start = requested;
+            _mark = requested;
+            ::memset(&_current, 0, sizeof(_current));
+        }
+        void Mark(const phase which)
+        {
+            const uint64_t now = Core::Time::Now().Ticks();
+
+            _current.Phases[which] += static_cast<uint32_t>(now - _mark);
+            _mark = now;
+        }
+        // Returns the total time of the transition, in us.
+        uint32_t End(const bool suspend)
+        {
+            _current.Total = static_cast<uint32_t>(_mark - _start);
+
+            if (_block != nullptr) {
+                Record& record(suspend == true ? _block->Suspend : _block->Resume);
+
+                _block->Sequence.fetch_add(1, std::memory_order_acq_rel);
+
+                _current.Count = record.Count + 1;
+                record = _current;
+
+                if ((suspend == false) && (_block->Target != 0) && (_current.Total > (_block->Target * 1000))) {
+                    _block->Missed++;
+                }
+
+                _block->Sequence.fetch_add(1, std::memory_order_acq_rel);
+            }
+
+            return (_current.Total);
+        }
+
+        // Reader side.
+        bool Get(Record& suspend, Record& resume, uint32_t& target, uint32_t& missed) const
+        {
+            bool result = false;
+
+            if (_block != nullptr) {
+                uint8_t attempts = 8;
+                uint32_t sequence;
+
+                do {
+                    sequence = _block->Sequence.load(std::memory_order_acquire);
+
+                    suspend = _block->Suspend;
+                    resume = _block->Resume;
+                    target = _block->Target;
+                    missed = _block->Missed;
+
+                    std::atomic_thread_fence(std::memory_order_acquire);
+
+                    result = (((sequence & 1) == 0) && (sequence == _block->Sequence.load(std::memory_order_relaxed)));
+
+                } while ((result == false) && (--attempts != 0));
+            }
+
+            return (result);
+        }
+
+    private:
+        Core::DataElementFile _file;
+        Block* _block;
+        uint64_t _start;
+        uint64_t _mark;
+        Record _current;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
@@ -18,6 +18,7 @@
  */
 
 #include "WebKitBrowser.h"
+#include "MemoryPressure.h"
 
 namespace WPEFramework {
 
@@ -39,6 +40,7 @@ namespace Plugin {
         ASSERT(_service == nullptr);
         ASSERT(_browser == nullptr);
         ASSERT(_memory == nullptr);
+        ASSERT(_timing == nullptr);
 
         _connectionId = 0;
         _service = service;
@@ -51,6 +53,7 @@ namespace Plugin {
         // change to "register" the sink for these events !!! So do it ahead of instantiation.
         _service->Register(&_notification);
 
+        MemoryPressureObserver::Host();
         _browser = service->Root<Exchange::IBrowser>(_connectionId, 2000, _T("WebKitImplementation"));
 
         if ((_browser != nullptr) && (_service != nullptr)) {
@@ -81,6 +84,9 @@ namespace Plugin {
                 stateControl->Configure(_service);
                 stateControl->Register(&_notification);
                 stateControl->Release();
+
+                // Created by the implementation during the Configure.
+                _timing = new StateTiming(StateTiming::FileName(_service), false);
             }
         }
 
@@ -112,6 +118,10 @@ namespace Plugin {
             stateControl->Release();
         }
 
+        if (_timing != nullptr) {
+            delete _timing;
+        }
+
         // Stop processing of the browser:
         _browser->Release();
         // FIXME: Destruction is not always properly reported, which leaves hanging processes (Bartjes Law)
@@ -131,12 +141,12 @@ namespace Plugin {
         _service = nullptr;
         _browser = nullptr;
         _memory = nullptr;
+        _timing = nullptr;
     }
 
     /* virtual */ string WebKitBrowser::Information() const
     {
-        // No additional info to report.
-        return (nullptr);
+        return (MemoryPressureObserver::Report(_service));
     }
 
     /* virtual */ void WebKitBrowser::Inbound(Web::Request& request)
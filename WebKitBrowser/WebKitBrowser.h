@@ -21,6 +21,7 @@
 #define __BROWSER_H
 
 #include "Module.h"
+#include "StateTiming.h"
 #include <interfaces/IBrowser.h>
 #include <interfaces/IComposition.h>
 #include <interfaces/IMemory.h>
@@ -149,6 +150,98 @@ namespace Plugin {
             Core::JSON::String Path;
         };
 
+        class TransitionData : public Core::JSON::Container {
+        public:
+            TransitionData()
+                : Core::JSON::Container()
+                , Dispatch()
+                , Visibility()
+                , Transition()
+                , Collect()
+                , Notify()
+                , Total()
+                , Count()
+            {
+                Init();
+            }
+            TransitionData(const TransitionData& copy)
+                : Core::JSON::Container()
+                , Dispatch(copy.Dispatch)
+                , Visibility(copy.Visibility)
+                , Transition(copy.Transition)
+                , Collect(copy.Collect)
+                , Notify(copy.Notify)
+                , Total(copy.Total)
+                , Count(copy.Count)
+            {
+                Init();
+            }
+            TransitionData& operator=(const TransitionData& rhs)
+            {
+                Dispatch = rhs.Dispatch;
+                Visibility = rhs.Visibility;
+                Transition = rhs.Transition;
+                Collect = rhs.Collect;
+                Notify = rhs.Notify;
+                Total = rhs.Total;
+                Count = rhs.Count;
+                return (*this);
+            }
+            ~TransitionData()
+            {
+            }
+
+        private:
+            void Init()
+            {
+                Add(_T("dispatch"), &Dispatch);
+                Add(_T("visibility"), &Visibility);
+                Add(_T("transition"), &Transition);
+                Add(_T("collect"), &Collect);
+                Add(_T("notify"), &Notify);
+                Add(_T("total"), &Total);
+                Add(_T("count"), &Count);
+            }
+
+        public:
+            Core::JSON::DecUInt32 Dispatch; // Time until the browser main loop handled the request
+            Core::JSON::DecUInt32 Visibility; // Time spent hiding or showing the page
+            Core::JSON::DecUInt32 Transition; // Time spent in the WebKit suspend or resume
+            Core::JSON::DecUInt32 Collect; // Time spent collecting the JavaScript heap
+            Core::JSON::DecUInt32 Notify; // Time spent notifying the state change
+            Core::JSON::DecUInt32 Total; // Duration of the whole transition
+            Core::JSON::DecUInt32 Count; // Number of transitions so far
+        };
+
+        class TimingData : public Core::JSON::Container {
+        private:
+            TimingData(const TimingData&) = delete;
+            TimingData& operator=(const TimingData&) = delete;
+
+        public:
+            TimingData()
+                : Core::JSON::Container()
+                , Suspend()
+                , Resume()
+                , Target()
+                , Missed()
+            {
+                Add(_T("suspend"), &Suspend);
+                Add(_T("resume"), &Resume);
+                Add(_T("target"), &Target);
+                Add(_T("missed"), &Missed);
+            }
+            ~TimingData()
+            {
+            }
+
+        public:
+            TransitionData Suspend;
+            TransitionData Resume;
+            Core::JSON::DecUInt32 Target; // Pre-warm resume target in ms (0 if there is none)
+            Core::JSON::DecUInt32 Missed; // Number of resumes that took longer than the target
+        };
+
     public:
         WebKitBrowser()
             : _skipURL(0)
@@ -156,6 +249,7 @@ namespace Plugin {
             , _service(nullptr)
             , _browser(nullptr)
             , _memory(nullptr)
+            , _timing(nullptr)
             , _notification(this)
             , _jsonBodyDataFactory(2)
         {
@@ -235,6 +329,7 @@ namespace Plugin {
         uint32_t get_fps(Core::JSON::DecUInt32& response) const; // Browser
         uint32_t get_state(Core::JSON::EnumType<JsonData::StateControl::StateType>& response) const; // StateControl
         uint32_t set_state(const Core::JSON::EnumType<JsonData::StateControl::StateType>& param); // StateControl
+        uint32_t get_statetiming(TimingData& response) const; // WebKitBrowser
         uint32_t endpoint_delete(const JsonData::Browser::DeleteParamsData& params);
         uint32_t delete_dir(const string& path);
         void event_urlchange(const string& url, const bool& loaded); // Browser
@@ -249,6 +344,7 @@ namespace Plugin {
         PluginHost::IShell* _service;
         Exchange::IBrowser* _browser;
         Exchange::IMemory* _memory;
+        StateTiming* _timing;
         Core::Sink<Notification> _notification;
         Core::ProxyPoolType<Web::JSONBodyType<WebKitBrowser::Data>> _jsonBodyDataFactory;
         string _persistentStoragePath;
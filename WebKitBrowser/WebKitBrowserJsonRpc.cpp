@@ -39,11 +39,13 @@ namespace Plugin {
         Property<Core::JSON::EnumType<VisibilityType>>(_T("visibility"), &WebKitBrowser::get_visibility, &WebKitBrowser::set_visibility, this); /* Browser */
         Property<Core::JSON::DecUInt32>(_T("fps"), &WebKitBrowser::get_fps, nullptr, this); /* Browser */
         Property<Core::JSON::EnumType<StateType>>(_T("state"), &WebKitBrowser::get_state, &WebKitBrowser::set_state, this); /* StateControl */
+        Property<TimingData>(_T("statetiming"), &WebKitBrowser::get_statetiming, nullptr, this); /* WebKitBrowser */
         Register<DeleteParamsData,void>(_T("delete"), &WebKitBrowser::endpoint_delete, this);
     }
 
     void WebKitBrowser::UnregisterAll()
     {
+        Unregister(_T("statetiming"));
         Unregister(_T("state"));
         Unregister(_T("fps"));
         Unregister(_T("visibility"));
@@ -176,6 +178,42 @@ namespace Plugin {
         return result;
     }
 
+    static void Transition(const StateTiming::Record& record, WebKitBrowser::TransitionData& response)
+    {
+        response.Dispatch = record.Phases[StateTiming::DISPATCH];
+        response.Visibility = record.Phases[StateTiming::VISIBILITY];
+        response.Transition = record.Phases[StateTiming::TRANSITION];
+        response.Collect = record.Phases[StateTiming::COLLECT];
+        response.Notify = record.Phases[StateTiming::NOTIFY];
+        response.Total = record.Total;
+        response.Count = record.Count;
+    }
+
+    // Property: statetiming - Duration of the phases of the last suspend and resume
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNAVAILABLE: The browser does not publish its timing
+    uint32_t WebKitBrowser::get_statetiming(TimingData& response) const
+    {
+        uint32_t result = Core::ERROR_UNAVAILABLE;
+
+        StateTiming::Record suspend;
+        StateTiming::Record resume;
+        uint32_t target;
+        uint32_t missed;
+
+        if ((_timing != nullptr) && (_timing->Get(suspend, resume, target, missed) == true)) {
+            Transition(suspend, response.Suspend);
+            Transition(resume, response.Resume);
+            response.Target = target;
+            response.Missed = missed;
+
+            result = Core::ERROR_NONE;
+        }
+
+        return result;
+    }
+
     // Method: endpoint_delete - delete dir
     // Return codes:
     //  - ERROR_NONE: Success
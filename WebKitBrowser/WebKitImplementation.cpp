@@ -37,6 +37,8 @@
 #include <WPE/WebKit/WKUserMediaPermissionRequest.h>
 
 #include "BrowserConsoleLog.h"
+#include "MemoryObserver.h"
+#include "MemoryPressure.h"
 #include "InjectedBundle/Tags.h"
 
 #endif
@@ -314,7 +316,7 @@ static GSourceFuncs _handlerIntervention =
         }
     }
 
-    class WebKitImplementation : public Core::Thread, public Exchange::IBrowser, public PluginHost::IStateControl {
+    class WebKitImplementation : public Core::Thread, public Exchange::IBrowser, public PluginHost::IStateControl, public MemoryPressureObserver::ITrimmer {
     public:
         class BundleConfig : public Core::JSON::Container {
         private:
@@ -400,6 +402,27 @@ static GSourceFuncs _handlerIntervention =
                 Core::JSON::Boolean UseDOM;
                 Core::JSON::String DumpOptions;
             };
+            class PreWarmSettings : public Core::JSON::Container {
+            public:
+                PreWarmSettings(const PreWarmSettings&) = delete;
+                PreWarmSettings& operator=(const PreWarmSettings&) = delete;
+
+                PreWarmSettings()
+                    : Core::JSON::Container()
+                    , Enabled(false)
+                    , Target(0)
+                {
+                    Add(_T("enabled"), &Enabled);
+                    Add(_T("target"), &Target);
+                }
+                ~PreWarmSettings()
+                {
+                }
+
+            public:
+                Core::JSON::Boolean Enabled; // Release the graphics and collect the JS heap on suspend
+                Core::JSON::DecUInt16 Target; // Resume time to meet, in ms
+            };
 
         public:
             Config()
@@ -442,6 +465,8 @@ static GSourceFuncs _handlerIntervention =
                 , ExecPath()
                 , HTTPProxy()
                 , HTTPProxyExclusion()
+                , PreWarm()
+                , MemoryTrim()
             {
                 Add(_T("useragent"), &UserAgent);
                 Add(_T("url"), &URL);
@@ -483,6 +508,8 @@ static GSourceFuncs _handlerIntervention =
                 Add(_T("execpath"), &ExecPath);
                 Add(_T("proxy"), &HTTPProxy);
                 Add(_T("proxyexclusion"), &HTTPProxyExclusion);
+                Add(_T("prewarm"), &PreWarm);
+                Add(_T("memorytrim"), &MemoryTrim);
             }
             ~Config()
             {
@@ -529,6 +556,8 @@ static GSourceFuncs _handlerIntervention =
             Core::JSON::String ExecPath;
             Core::JSON::String HTTPProxy;
             Core::JSON::String HTTPProxyExclusion;
+            PreWarmSettings PreWarm;
+            MemoryPressureObserver::Config MemoryTrim;
         };
 
     private:
@@ -555,6 +584,10 @@ static GSourceFuncs _handlerIntervention =
             , _state(PluginHost::IStateControl::UNINITIALIZED)
             , _hidden(false)
             , _time(0)
+            , _timing(nullptr)
+            , _prewarmHidden(false)
+            , _pressure(*this)
+            , _trimLevel(MemoryPressureObserver::NONE)
             , _compliant(false)
         {
             // Register an @Exit, in case we are killed, with an incorrect ref count !!
@@ -570,6 +603,8 @@ static GSourceFuncs _handlerIntervention =
         }
         virtual ~WebKitImplementation()
         {
+            _pressure.Close();
+
             Block();
 
             if (_loop != nullptr)
@@ -578,6 +613,11 @@ static GSourceFuncs _handlerIntervention =
             if (Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, 6000) == false)
                 TRACE_L1("Bailed out before the end of the WPE main app was reached. %d", 6000);
 
+            if (_timing != nullptr) {
+                delete _timing;
+                _timing = nullptr;
+            }
+
             implementation = nullptr;
         }
 
@@ -805,6 +845,17 @@ static GSourceFuncs _handlerIntervention =
             _dataPath = service->DataPath();
             _config.FromString(service->ConfigLine());
 
+            ASSERT(_timing == nullptr);
+            _timing = new StateTiming(StateTiming::FileName(service), true);
+            if (_timing->IsValid() == false) {
+                SYSLOG(Logging::Notification, (_T("Could not publish the suspend/resume timing of %s"), service->Callsign().c_str()));
+            }
+            _timing->Target(_config.PreWarm.Enabled.Value() == true ? _config.PreWarm.Target.Value() : 0);
+
+            if ((_config.MemoryTrim.Enabled.Value() == true) && (_pressure.Open(_config.MemoryTrim, MemoryPressureObserver::FileName(service)) != Core::ERROR_NONE)) {
+                SYSLOG(Logging::Notification, (_T("Could not observe the memory pressure through %s"), _config.MemoryTrim.Source.Value().c_str()));
+            }
+
             bool environmentOverride(WebKitBrowser::EnvironmentOverride(_config.EnvironmentOverride.Value()));
 
             if ((environmentOverride == false) || (Core::SystemInfo::GetEnvironment(_T("WPE_WEBKIT_URL"), _URL) == false)) {
@@ -1000,6 +1051,39 @@ static GSourceFuncs _handlerIntervention =
         END_INTERFACE_MAP
 
     private:
+        // MemoryPressureObserver::ITrimmer, called from the observer thread.
+        void Trim(const MemoryPressureObserver::level which) override
+        {
+            if (_context != nullptr) {
+                _trimLevel = which;
+                g_main_context_invoke(
+                    _context,
+                    [](gpointer customdata) -> gboolean {
+                        WebKitImplementation* object = static_cast<WebKitImplementation*>(customdata);
+                        const MemoryPressureObserver::level level = object->_trimLevel;
+#ifdef WEBKIT_GLIB_API
+                        WebKitWebContext* context = webkit_web_view_get_context(object->_view);
+
+                        if (level >= MemoryPressureObserver::HIGH) {
+                            // Drops the decoded images and the other cached resources.
+                            webkit_web_context_clear_cache(context);
+                        }
+                        webkit_web_context_garbage_collect_javascript_objects(context);
+#else
+                        WKContextRef context = WKPageGetContext(object->_page);
+
+                        if (level >= MemoryPressureObserver::HIGH) {
+                            WKResourceCacheManagerClearCacheForAllOrigins(WKContextGetResourceCacheManager(context), WKResourceCachesToClearInMemoryOnly);
+                        }
+                        WKContextGarbageCollectJavaScriptObjects(context);
+#endif
+                        TRACE_L1("Trimmed the caches at memory pressure %s", MemoryPressureObserver::Name(level));
+
+                        return FALSE;
+                    },
+                    this);
+            }
+        }
         void Hide()
         {
             if (_context != nullptr) {
@@ -1010,6 +1094,7 @@ static GSourceFuncs _handlerIntervention =
                         WebKitImplementation* object = static_cast<WebKitImplementation*>(customdata);
 #ifdef WEBKIT_GLIB_API
                         webkit_web_view_hide(object->_view);
+                        object->_prewarmHidden = false;
 #else
                         WKViewSetViewState(object->_view, (object->_state == PluginHost::IStateControl::RESUMED ? kWKViewStateIsInWindow : 0));
 #endif
@@ -1031,6 +1116,7 @@ static GSourceFuncs _handlerIntervention =
                         WebKitImplementation* object = static_cast<WebKitImplementation*>(customdata);
 #ifdef WEBKIT_GLIB_API
                         webkit_web_view_show(object->_view);
+                        object->_prewarmHidden = false;
 #else
                         WKViewSetViewState(object->_view, (object->_state == PluginHost::IStateControl::RESUMED ? kWKViewStateIsInWindow : 0) | kWKViewStateIsVisible);
 #endif
@@ -1053,14 +1139,41 @@ static GSourceFuncs _handlerIntervention =
                     _context,
                     [](gpointer customdata) -> gboolean {
                         WebKitImplementation* object = static_cast<WebKitImplementation*>(customdata);
+
+                        // Created in Configure, before the main loop that runs this exists.
+                        ASSERT(object->_timing != nullptr);
+                        StateTiming& timing(*(object->_timing));
+                        const bool prewarm(object->_config.PreWarm.Enabled.Value());
+
+                        timing.Begin(object->_time);
+                        timing.Mark(StateTiming::DISPATCH);
 #ifdef WEBKIT_GLIB_API
+                        // Dropping the visibility releases the graphics (and detaches from the compositor),
+                        // without telling the clients, it is restored on resume.
+                        if ((prewarm == true) && (object->_hidden == false)) {
+                            webkit_web_view_hide(object->_view);
+                            object->_prewarmHidden = true;
+                            timing.Mark(StateTiming::VISIBILITY);
+                        }
                         webkit_web_view_suspend(object->_view);
+                        timing.Mark(StateTiming::TRANSITION);
+                        if (prewarm == true) {
+                            webkit_web_context_garbage_collect_javascript_objects(webkit_web_view_get_context(object->_view));
+                            timing.Mark(StateTiming::COLLECT);
+                        }
 #else
-                        WKViewSetViewState(object->_view, (object->_hidden ? 0 : kWKViewStateIsVisible));
+                        // Out of the window and invisible, the page releases its graphics as well.
+                        WKViewSetViewState(object->_view, ((object->_hidden == true) || (prewarm == true) ? 0 : kWKViewStateIsVisible));
+                        timing.Mark(StateTiming::TRANSITION);
+                        if (prewarm == true) {
+                            WKContextGarbageCollectJavaScriptObjects(WKPageGetContext(object->_page));
+                            timing.Mark(StateTiming::COLLECT);
+                        }
 #endif
                         object->OnStateChange(PluginHost::IStateControl::SUSPENDED);
+                        timing.Mark(StateTiming::NOTIFY);
 
-                        TRACE_L1("Internal Suspend Notification took %d mS.", static_cast<uint32_t>(Core::Time::Now().Ticks() - object->_time));
+                        TRACE_L1("Internal Suspend Notification took %d uS.", timing.End(true));
 
                         return FALSE;
                     },
@@ -1078,14 +1191,36 @@ static GSourceFuncs _handlerIntervention =
                     _context,
                     [](gpointer customdata) -> gboolean {
                         WebKitImplementation* object = static_cast<WebKitImplementation*>(customdata);
+
+                        // Created in Configure, before the main loop that runs this exists.
+                        ASSERT(object->_timing != nullptr);
+                        StateTiming& timing(*(object->_timing));
+
+                        timing.Begin(object->_time);
+                        timing.Mark(StateTiming::DISPATCH);
 #ifdef WEBKIT_GLIB_API
                         webkit_web_view_resume(object->_view);
+                        timing.Mark(StateTiming::TRANSITION);
+                        if (object->_prewarmHidden == true) {
+                            webkit_web_view_show(object->_view);
+                            object->_prewarmHidden = false;
+                            timing.Mark(StateTiming::VISIBILITY);
+                        }
 #else
                         WKViewSetViewState(object->_view, (object->_hidden ? 0 : kWKViewStateIsVisible) | kWKViewStateIsInWindow);
+                        timing.Mark(StateTiming::TRANSITION);
 #endif
                         object->OnStateChange(PluginHost::IStateControl::RESUMED);
+                        timing.Mark(StateTiming::NOTIFY);
+
+                        const uint32_t total = timing.End(false);
+                        const uint32_t target = object->_config.PreWarm.Target.Value();
+
+                        if ((object->_config.PreWarm.Enabled.Value() == true) && (target != 0) && (total > (target * 1000))) {
+                            SYSLOG(Logging::Notification, (_T("Resume took %d mS, the pre-warm target is %d mS"), total / 1000, target));
+                        }
 
-                        TRACE_L1("Internal Resume Notification took %d mS.", static_cast<uint32_t>(Core::Time::Now().Ticks() - object->_time));
+                        TRACE_L1("Internal Resume Notification took %d uS.", total);
 
                         return FALSE;
                     },
@@ -1534,6 +1669,10 @@ static GSourceFuncs _handlerIntervention =
         PluginHost::IStateControl::state _state;
         bool _hidden;
         uint64_t _time;
+        StateTiming* _timing;
+        bool _prewarmHidden;
+        MemoryPressureObserver _pressure;
+        std::atomic<MemoryPressureObserver::level> _trimLevel;
         bool _compliant;
     };
 
@@ -1688,145 +1827,71 @@ namespace WebKitBrowser {
     };
 
     static constexpr uint16_t RequiredChildren = (sizeof(mandatoryProcesses) / sizeof(mandatoryProcesses[0]));
-    class MemoryObserverImpl : public Exchange::IMemory {
+    // The browser is a process tree, its size is that of all processes together. On top it is only
+    // operational if the mandatory children are running.
+    class MemoryObserverImpl : public Plugin::MemoryObserverImpl {
     private:
-        MemoryObserverImpl();
-        MemoryObserverImpl(const MemoryObserverImpl&);
-        MemoryObserverImpl& operator=(const MemoryObserverImpl&);
-
         enum { TYPICAL_STARTUP_TIME = 10 }; /* in Seconds */
+
     public:
+        MemoryObserverImpl() = delete;
+        MemoryObserverImpl(const MemoryObserverImpl&) = delete;
+        MemoryObserverImpl& operator=(const MemoryObserverImpl&) = delete;
+
         MemoryObserverImpl(const RPC::IRemoteConnection* connection)
-            : _main(connection == nullptr ? Core::ProcessInfo().Id() : connection->RemoteId())
-            , _children(_main.Id())
-            , _startTime(connection == nullptr ? 0 : Core::Time::Now().Add(TYPICAL_STARTUP_TIME * 1000).Ticks())
+            : Plugin::MemoryObserverImpl(connection->RemoteId(), true)
+            , _children(Id())
+            , _startTime(Core::Time::Now().Add(TYPICAL_STARTUP_TIME * 1000).Ticks())
         { // IsOperation true till calculated time (microseconds)
         }
-        ~MemoryObserverImpl()
+        ~MemoryObserverImpl() override
         {
         }
 
     public:
-        virtual uint64_t Resident() const
+        const bool IsOperational() const override
         {
-            uint32_t result(0);
-
-            if (_startTime != 0) {
-                if (_children.Count() < RequiredChildren) {
-                    _children = Core::ProcessInfo::Iterator(_main.Id());
-                }
-
-                result = _main.Resident();
+            //!< We can monitor a max of 32 processes, every mandatory process represents a bit in the requiredProcesses.
+            // In the end we check if all bits are 0, what means all mandatory processes are still running.
+            uint32_t requiredProcesses = (0xFFFFFFFF >> (32 - RequiredChildren));
 
-                _children.Reset();
-
-                while (_children.Next() == true) {
-                    result += _children.Current().Resident();
-                }
+            if (_children.Count() < RequiredChildren) {
+                // Refresh the children list !!!
+                _children = Core::ProcessInfo::Iterator(Id());
             }
-
-            return (result);
-        }
-        virtual uint64_t Allocated() const
-        {
-            uint32_t result(0);
-
-            if (_startTime != 0) {
-                if (_children.Count() < RequiredChildren) {
-                    _children = Core::ProcessInfo::Iterator(_main.Id());
-                }
-
-                result = _main.Allocated();
+            //!< If there are less children than in the the mandatoryProcesses struct, we are done and return false.
+            if (_children.Count() >= RequiredChildren) {
 
                 _children.Reset();
 
-                while (_children.Next() == true) {
-                    result += _children.Current().Allocated();
-                }
-            }
-
-            return (result);
-        }
-        virtual uint64_t Shared() const
-        {
-            uint32_t result(0);
-
-            if (_startTime != 0) {
-                if (_children.Count() < RequiredChildren) {
-                    _children = Core::ProcessInfo::Iterator(_main.Id());
-                }
+                //!< loop over all child processes as long as we are operational.
+                while ((requiredProcesses != 0) && (true == _children.Next())) {
 
-                result = _main.Shared();
+                    uint8_t count(0);
+                    string name(_children.Current().Name());
 
-                _children.Reset();
-
-                while (_children.Next() == true) {
-                    result += _children.Current().Shared();
-                }
-            }
-
-            return (result);
-        }
-        virtual uint8_t Processes() const
-        {
-            // Refresh the children list !!!
-            _children = Core::ProcessInfo::Iterator(_main.Id());
-            return ((_startTime == 0) || (_main.IsActive() == true) ? 1 : 0) + _children.Count();
-        }
-        virtual const bool IsOperational() const
-        {
-            uint32_t requiredProcesses = 0;
-
-            if (_startTime != 0) {
-
-                //!< We can monitor a max of 32 processes, every mandatory process represents a bit in the requiredProcesses.
-                // In the end we check if all bits are 0, what means all mandatory processes are still running.
-                requiredProcesses = (0xFFFFFFFF >> (32 - RequiredChildren));
-
-                if (_children.Count() < RequiredChildren) {
-                    // Refresh the children list !!!
-                    _children = Core::ProcessInfo::Iterator(_main.Id());
-                }
-                //!< If there are less children than in the the mandatoryProcesses struct, we are done and return false.
-                if (_children.Count() >= RequiredChildren) {
-
-                    _children.Reset();
-
-                    //!< loop over all child processes as long as we are operational.
-                    while ((requiredProcesses != 0) && (true == _children.Next())) {
-
-                        uint8_t count(0);
-                        string name(_children.Current().Name());
-
-                        while ((count < RequiredChildren) && (name != mandatoryProcesses[count])) {
-                            ++count;
-                        }
+                    while ((count < RequiredChildren) && (name != mandatoryProcesses[count])) {
+                        ++count;
+                    }
 
-                        //<! this is a mandatory process and if its still active reset its bit in requiredProcesses.
-                        //   If not we are not completely operational.
-                        if ((count < RequiredChildren) && (_children.Current().IsActive() == true)) {
-                            requiredProcesses &= (~(1 << count));
-                        }
+                    //<! this is a mandatory process and if its still active reset its bit in requiredProcesses.
+                    //   If not we are not completely operational.
+                    if ((count < RequiredChildren) && (_children.Current().IsActive() == true)) {
+                        requiredProcesses &= (~(1 << count));
                     }
                 }
             }
 
-            // TRACE_L1("requiredProcess = %X, IsStarting = %s, main.IsActive = %s", requiredProcesses, IsStarting() ? _T("true") : _T("false"), _main.IsActive() ? _T("true") : _T("false"));
-            return (((requiredProcesses == 0) || (true == IsStarting())) && (true == _main.IsActive()));
+            return (((requiredProcesses == 0) || (true == IsStarting())) && (true == Plugin::MemoryObserverImpl::IsOperational()));
         }
 
-        BEGIN_INTERFACE_MAP(MemoryObserverImpl)
-        INTERFACE_ENTRY(Exchange::IMemory)
-        END_INTERFACE_MAP
-
     private:
         inline const bool IsStarting() const
         {
-            return (_startTime == 0) || (Core::Time::Now().Ticks() < _startTime);
+            return (Core::Time::Now().Ticks() < _startTime);
         }
 
     private:
-        Core::ProcessInfo _main;
         mutable Core::ProcessInfo::Iterator _children;
         uint64_t _startTime; // !< Reference for monitor
     };
@@ -288,19 +288,26 @@ namespace WPASupplicant {
 
                     _adminLock.Lock();
 
-                    // Let see what we need to do with this BSSID, add or remove :-)
-                    if ((event == CTRL_EVENT_BSS_ADDED) && (_detailRequest.Set(bssid) == true)) {
-                        // send out a request for detail.
-                        _adminLock.Unlock();
-                        Submit(&_detailRequest);
-                        _adminLock.Lock();
-                    } else if (event == CTRL_EVENT_BSS_REMOVED) {
-
-                        NetworkInfoContainer::iterator network(_networks.find(bssid));
+                    NetworkInfoContainer::iterator network(_networks.find(bssid));
 
-                        if (network != _networks.end()) {
-                            _networks.erase(network);
+                    // Let see what we need to do with this BSSID, add or remove :-)
+                    if (event == CTRL_EVENT_BSS_ADDED) {
+                        if (network == _networks.end()) {
+                            // Keep a place for it, the details follow with a "BSS" query. If that
+                            // request is busy, the running detail chain will pick this one up.
+                            _networks.emplace(bssid, NetworkInfo());
+
+                            if (_detailRequest.Set(bssid) == true) {
+                                _adminLock.Unlock();
+                                Submit(&_detailRequest);
+                                _adminLock.Lock();
+                            }
+                        }
+                    } else if (network != _networks.end()) {
+                        if (network->second.IsValid() == true) {
+                            _generation++;
                         }
+                        _networks.erase(network);
                     }
 
                     if (_callback != nullptr) {
@@ -340,9 +347,49 @@ namespace WPASupplicant {
     // Completion of requests are running in a locked context, so oke to update maps/lists
     void Controller::Add(const uint64_t& bssid, const NetworkInfo& entry)
     {
-        TRACE(Communication, (_T("Added SSID: %llX - %s"), bssid, entry.SSID().c_str()));
-        _networks[bssid] = entry;
-        Reevaluate();
+        NetworkInfoContainer::iterator index(_networks.find(bssid));
+
+        if (index == _networks.end()) {
+            TRACE(Communication, (_T("Added SSID: %llX - %s"), bssid, entry.SSID().c_str()));
+            _networks.emplace(bssid, entry);
+            _generation++;
+        } else if (index->second.IsValid() == false) {
+            // Announced by an event, but the scan was faster than the details.
+            index->second.Refresh(entry, SignalHysteresis);
+            _generation++;
+        } else if (index->second.Refresh(entry, SignalHysteresis) == true) {
+            TRACE(Communication, (_T("Changed SSID: %llX - %s"), bssid, entry.SSID().c_str()));
+            _generation++;
+        }
+    }
+    void Controller::Synchronize(std::vector<uint64_t>& reported)
+    {
+        const uint32_t generation = _generation;
+
+        std::sort(reported.begin(), reported.end());
+
+        // Whatever the supplicant did not report, it has dropped from its own table. A
+        // single channel scan says nothing about the BSSes on the other channels, so
+        // those are left alone.
+        NetworkInfoContainer::iterator index(_networks.begin());
+
+        while (index != _networks.end()) {
+            if ((std::binary_search(reported.begin(), reported.end(), index->first) == true) || ((_scanFrequency != 0) && (index->second.Frequency() != _scanFrequency))) {
+                index++;
+            } else {
+                TRACE(Communication, (_T("Removed SSID: %llX - %s"), index->first, index->second.SSID().c_str()));
+                index = _networks.erase(index);
+                _generation++;
+            }
+        }
+
+        _scanFrequency = 0;
+
+        if (generation != _generation) {
+            Reevaluate();
+        } else {
+            Detail();
+        }
     }
     void Controller::Add(const string& ssid, const bool current, const uint64_t& bssid)
     {
@@ -365,26 +412,33 @@ namespace WPASupplicant {
     }
     void Controller::Update(const uint64_t& bssid, const string& ssid, const uint32_t id, uint32_t frequency, const int32_t signal, const uint16_t pairs, const uint32_t keys, const uint32_t throughput)
     {
-
-        bool scanInProgress = false;
+        bool changed = false;
 
         NetworkInfoContainer::iterator index(_networks.find(bssid));
 
-        if (index != _networks.end()) {
-
-            scanInProgress = (index->second.Id() == static_cast<uint32_t>(~0));
+        if (frequency == 0) {
+            // The supplicant does not know this BSS (anymore).
+            if (index != _networks.end()) {
+                changed = index->second.IsValid();
+                _networks.erase(index);
+            }
+        } else if (index != _networks.end()) {
 
             TRACE(Communication, (_T("Updated BSSID: %llX, %d"), bssid, id));
 
-            index->second.Set(id, ssid, frequency, signal, pairs, keys, throughput);
+            changed = (index->second.IsValid() == false);
+            changed = index->second.Refresh(NetworkInfo(id, ssid, frequency, signal, pairs, keys, throughput), SignalHysteresis) || changed;
         } else {
-            _networks[bssid] = NetworkInfo(id, ssid, frequency, signal, pairs, keys, throughput);
+            _networks.emplace(bssid, NetworkInfo(id, ssid, frequency, signal, pairs, keys, throughput));
+            changed = true;
         }
 
-        if (scanInProgress == true) {
+        if (changed == true) {
+            _generation++;
             Reevaluate();
-        } else if (_callback != nullptr) {
-            _callback->Dispatch(CTRL_EVENT_NETWORK_CHANGED);
+        } else {
+            // Nothing new on this one, continue with the ones still lacking details.
+            Detail();
         }
     }
 
@@ -408,26 +462,31 @@ namespace WPASupplicant {
 
         Reevaluate();
     }
-    void Controller::Reevaluate()
+    bool Controller::Detail()
     {
-
         NetworkInfoContainer::iterator index(_networks.begin());
 
         while ((index != _networks.end()) && (index->second.HasDetail() == true)) {
             index++;
         }
-        if (index != _networks.end()) {
-            if (_detailRequest.Set(index->first) == true) {
-                // send out a request for detail.
-                Submit(&_detailRequest);
-            }
+        if ((index != _networks.end()) && (_detailRequest.Set(index->first) == true)) {
+            // send out a request for detail.
+            Submit(&_detailRequest);
+        }
+
+        return (index != _networks.end());
+    }
+    void Controller::Reevaluate()
+    {
+        if (Detail() == true) {
+            // Wait for the details to complete, before reporting.
         } else if (_enabled.size() == 0) {
             // send out a request for the network list
             if (_networkRequest.Set() == true) {
                 // send out a request for detail.
                 Submit(&_networkRequest);
             }
-        } else {
+        } else if (_callback != nullptr) {
             _callback->Dispatch(CTRL_EVENT_NETWORK_CHANGED);
         }
     }
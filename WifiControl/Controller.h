@@ -123,6 +123,8 @@ namespace WPASupplicant {
 
     private:
         static constexpr uint32_t MaxConnectionTime = 3000;
+        // Signal changes (in dBm) below this are not reported as a change of the BSS.
+        static constexpr int32_t SignalHysteresis = 6;
 
         Controller() = delete;
         Controller(const Controller&) = delete;
@@ -267,6 +269,30 @@ namespace WPASupplicant {
             uint32_t Key() const { return _key; }
             uint32_t Throughput() const { return _throughput; }
             bool IsHidden() const { return _hidden; }
+            bool IsValid() const { return (_frequency != 0); }
+
+            // Take over what the supplicant reported on this BSS. Returns true if this is
+            // news for the observers, a signal that just fluctuates a bit is not.
+            bool Refresh(const NetworkInfo& reported, const int32_t hysteresis)
+            {
+                const int32_t delta = (_signal > reported._signal ? _signal - reported._signal : reported._signal - _signal);
+                const bool changed = ((_frequency != reported._frequency) || (_pair != reported._pair) || (_key != reported._key) || (_hidden != reported._hidden) || (_ssid != reported._ssid) || (delta >= hysteresis));
+
+                _frequency = reported._frequency;
+                _signal = reported._signal;
+                _pair = reported._pair;
+                _key = reported._key;
+                _ssid = reported._ssid;
+                _hidden = reported._hidden;
+
+                // A scan line does not carry the details, keep the ones we already have.
+                if (reported.HasDetail() == true) {
+                    _id = reported._id;
+                    _throughput = reported._throughput;
+                }
+
+                return (changed);
+            }
 
             void Set(const string& ssid, const uint32_t frequency, const int32_t signal, const uint16_t pairs, const uint32_t keys)
             {
@@ -425,6 +451,7 @@ namespace WPASupplicant {
                     Core::TextFragment data(response.c_str(), response.length());
                     uint32_t marker = data.ForwardFind('\n');
                     uint32_t markerEnd = data.ForwardFind('\n', marker + 1);
+                    std::vector<uint64_t> reported;
 
                     while (marker != markerEnd) {
 
@@ -432,8 +459,12 @@ namespace WPASupplicant {
                         marker = markerEnd;
                         markerEnd = data.ForwardFind('\n', marker + 1);
                         NetworkInfo newEntry;
-                        _parent.Add(Transform(element, newEntry), newEntry);
+                        const uint64_t bssid = Transform(element, newEntry);
+                        _parent.Add(bssid, newEntry);
+                        reported.push_back(bssid);
                     }
+
+                    _parent.Synchronize(reported);
                 }
                 if (_eventReporting != static_cast<uint32_t>(~0)) {
                     _parent.Notify(static_cast<events>(_eventReporting));
@@ -970,6 +1001,8 @@ namespace WPASupplicant {
             , _enabled()
             , _error(Core::ERROR_UNAVAILABLE)
             , _callback(nullptr)
+            , _generation(0)
+            , _scanFrequency(0)
             , _scanRequest(*this)
             , _detailRequest(*this)
             , _networkRequest(*this)
@@ -1077,18 +1110,32 @@ namespace WPASupplicant {
         {
             return (_error);
         }
-        inline uint32_t Scan()
+        // Bumped on every real change of the scanned BSS table, so observers can tell
+        // a scan that brought news from one that did not.
+        inline uint32_t Generation() const
+        {
+            _adminLock.Lock();
+            const uint32_t result = _generation;
+            _adminLock.Unlock();
+            return (result);
+        }
+        // A frequency (in MHz) limits the scan to that single channel, which takes a
+        // fraction of the time of a full scan.
+        inline uint32_t Scan(const uint32_t frequency = 0)
         {
 
             uint32_t result = Core::ERROR_INPROGRESS;
             _adminLock.Lock();
             const bool activated = _scanRequest.Activated();
+            if (activated == true) {
+                _scanFrequency = frequency;
+            }
             _adminLock.Unlock();
 
             if (activated == true) {
                 result = Core::ERROR_NONE;
 
-                CustomRequest exchange(string(_TXT("SCAN")));
+                CustomRequest exchange(frequency == 0 ? string(_TXT("SCAN")) : string(_TXT("SCAN freq=")) + Core::NumberType<uint32_t>(frequency).Text());
 
                 Submit(&exchange);
 
@@ -1156,7 +1203,7 @@ namespace WPASupplicant {
 
             NetworkInfoContainer::iterator index(_networks.find(id));
 
-            if (index != _networks.end()) {
+            if ((index != _networks.end()) && (index->second.IsValid() == true)) {
                 result = Network(Core::ProxyType<Controller>(*this),
                     (index->second.HasId() ? index->second.Id() : static_cast<uint32_t>(~0)),
                     index->first,
@@ -1222,16 +1269,19 @@ namespace WPASupplicant {
             NetworkInfoContainer::const_iterator index(_networks.begin());
 
             while (index != _networks.end()) {
-                result.Insert(Network(channel,
-                    (index->second.HasId() ? index->second.Id() : static_cast<uint32_t>(~0)),
-                    index->first,
-                    index->second.Frequency(),
-                    index->second.Signal(),
-                    index->second.Pair(),
-                    index->second.Key(),
-                    index->second.SSID(),
-                    index->second.Throughput(),
-                    index->second.IsHidden()));
+                // Announced BSSes, of which the details did not arrive yet, are not reported.
+                if (index->second.IsValid() == true) {
+                    result.Insert(Network(channel,
+                        (index->second.HasId() ? index->second.Id() : static_cast<uint32_t>(~0)),
+                        index->first,
+                        index->second.Frequency(),
+                        index->second.Signal(),
+                        index->second.Pair(),
+                        index->second.Key(),
+                        index->second.SSID(),
+                        index->second.Throughput(),
+                        index->second.IsHidden()));
+                }
                 index++;
             }
 
@@ -1846,6 +1896,8 @@ namespace WPASupplicant {
         // These methods (add/add/update) are assumed to be running in a locked context.
         // Completion of requests are running in a locked context, so oke to update maps/lists
         void Add(const uint64_t& bssid, const NetworkInfo& entry);
+        void Synchronize(std::vector<uint64_t>& reported);
+        bool Detail();
         void Add(const string& ssid, const bool current, const uint64_t& bssid);
         void Update(const string& status);
         void Update(const uint64_t& bssid, const string& ssid, const uint32_t id, uint32_t frequency, const int32_t signal, const uint16_t pairs, const uint32_t keys, const uint32_t throughput);
@@ -1920,6 +1972,8 @@ namespace WPASupplicant {
         EnabledContainer _enabled;
         uint32_t _error;
         Core::IDispatchType<const events>* _callback;
+        uint32_t _generation;
+        uint32_t _scanFrequency;
         ScanRequest _scanRequest;
         DetailRequest _detailRequest;
         NetworkRequest _networkRequest;
@@ -48,6 +48,8 @@ namespace Plugin
         , _wpaSupplicant()
         , _controller()
         , _autoConnect(_controller)
+        , _generation(~0)
+        , _scanRequested(false)
     {
         RegisterAll();
     }
@@ -283,6 +285,7 @@ namespace Plugin
 
                     result->ErrorCode = Web::STATUS_OK;
                     result->Message = _T("Scan started.");
+                    _scanRequested = true;
                     _controller->Scan();
 
                 } else if (index.Current().Text() == _T("Connect")) {
@@ -386,20 +389,28 @@ namespace Plugin
 
         switch (event) {
         case WPASupplicant::Controller::CTRL_EVENT_SCAN_RESULTS: {
-            WifiControl::NetworkList networks;
-            WPASupplicant::Network::Iterator list(_controller->Networks());
-
-            networks.Set(list);
+            const uint32_t generation = _controller->Generation();
 
             _autoConnect.Scanned();
 
-            event_scanresults(networks.Networks);
+            // Periodic scans mostly find the same BSSes, only report the ones that changed
+            // something, or that were explicitly asked for.
+            if ((generation != _generation) || (_scanRequested.exchange(false) == true)) {
+                WifiControl::NetworkList networks;
+                WPASupplicant::Network::Iterator list(_controller->Networks());
 
-            string message;
+                _generation = generation;
 
-            networks.ToString(message);
+                networks.Set(list);
 
-            _service->Notify(message);
+                event_scanresults(networks.Networks);
+
+                string message;
+
+                networks.ToString(message);
+
+                _service->Notify(message);
+            }
             break;
         }
         case WPASupplicant::Controller::CTRL_EVENT_CONNECTED: {
@@ -132,17 +132,18 @@ namespace Plugin {
         class AutoConnect : public WPASupplicant::Controller::IConnectCallback
         {
         private:
-            class AccessPoint 
+            class AccessPoint
             {
             public:
                 AccessPoint() = delete;
                 AccessPoint(const AccessPoint&) = delete;
                 AccessPoint& operator= (const AccessPoint&) = delete;
 
-                AccessPoint(const int32_t strength, const uint64_t& bssid, const string& SSID) 
-                    : _strength(strength)
+                AccessPoint(const int32_t score, const uint64_t& bssid, const string& SSID, const uint32_t frequency)
+                    : _score(score)
                     , _bssid(bssid)
-                    , _ssid(SSID) {
+                    , _ssid(SSID)
+                    , _frequency(frequency) {
                 }
                 ~AccessPoint() {
                 }
@@ -154,15 +155,134 @@ namespace Plugin {
                 const uint64_t& BSSID() const {
                     return(_bssid);
                 }
-                int32_t Signal() const {
-                    return (_strength);
+                int32_t Score() const {
+                    return (_score);
+                }
+                uint32_t Frequency() const {
+                    return (_frequency);
                 }
 
             private:
-                int32_t _strength;
+                int32_t _score;
                 uint64_t _bssid;
                 string _ssid;
+                uint32_t _frequency;
+            };
+            // Remembers how connecting to the BSSes worked out, and with which BSS each SSID
+            // was connected the last time, to put the most promising candidate first.
+            class Ranking
+            {
+            private:
+                // The score starts from the signal (in dBm), these are added on top of it.
+                enum {
+                    PREFERRED_BONUS = 1000, // The preferred SSID always goes first.
+                    BAND_BONUS = 10, // 5 GHz is faster and less crowded, ...
+                    BAND_THRESHOLD = -70, // ... as long as the signal is decent.
+                    THROUGHPUT_BONUS = 20, // 1 point per 10 Mbps estimated throughput, at most.
+                    HISTORY_BONUS = 15, // Always connected: +15, never connected: -15.
+                    LAST_GOOD_BONUS = 10, // Where this SSID was connected the last time.
+                    HISTORY_SPAN = 16, // Halve the history at this many attempts, so it ages.
+                    MAX_HISTORY = 64
+                };
+
+                struct History {
+                    uint16_t Attempts;
+                    uint16_t Successes;
+                };
+                struct LastGood {
+                    uint64_t BSSID;
+                    uint32_t Frequency;
+                };
+
+                using HistoryMap = std::map<uint64_t, History>;
+                using LastGoodMap = std::map<string, LastGood>;
+
+            public:
+                Ranking(const Ranking&) = delete;
+                Ranking& operator=(const Ranking&) = delete;
+
+                Ranking()
+                    : _history()
+                    , _lastGood()
+                    , _last()
+                {
+                }
+                ~Ranking()
+                {
+                }
+
+            public:
+                int32_t Score(const WPASupplicant::Network& net, const string& preferred) const
+                {
+                    int32_t score = net.Signal();
+
+                    if (net.SSID() == preferred) {
+                        score += PREFERRED_BONUS;
+                    }
+                    if ((net.Frequency() >= 5000) && (net.Signal() >= BAND_THRESHOLD)) {
+                        score += BAND_BONUS;
+                    }
+
+                    // The supplicant estimates the throughput in kbps.
+                    score += static_cast<int32_t>(std::min(net.Throughput() / 10000, static_cast<uint32_t>(THROUGHPUT_BONUS)));
+
+                    HistoryMap::const_iterator history(_history.find(net.BSSID()));
+                    if ((history != _history.end()) && (history->second.Attempts > 0)) {
+                        score += ((2 * HISTORY_BONUS * history->second.Successes) / history->second.Attempts) - HISTORY_BONUS;
+                    }
+
+                    LastGoodMap::const_iterator lastGood(_lastGood.find(net.SSID()));
+                    if ((lastGood != _lastGood.end()) && (lastGood->second.BSSID == net.BSSID())) {
+                        score += LAST_GOOD_BONUS;
+                    }
+
+                    return (score);
+                }
+                // The channel to look at first: where the preferred SSID, or else the last
+                // SSID, was connected. 0 if there is no such history.
+                uint32_t Frequency(const string& preferred) const
+                {
+                    LastGoodMap::const_iterator index(_lastGood.find(preferred.empty() == false ? preferred : _last));
+
+                    if ((index == _lastGood.end()) && (preferred.empty() == false)) {
+                        index = _lastGood.find(_last);
+                    }
+
+                    return (index != _lastGood.end() ? index->second.Frequency : 0);
+                }
+                void Outcome(const AccessPoint& accessPoint, const bool success)
+                {
+                    HistoryMap::iterator index(_history.find(accessPoint.BSSID()));
+
+                    if (index == _history.end()) {
+                        if (_history.size() >= MAX_HISTORY) {
+                            _history.erase(_history.begin());
+                        }
+                        index = _history.emplace(accessPoint.BSSID(), History { 0, 0 }).first;
+                    }
+
+                    index->second.Attempts++;
+                    index->second.Successes += (success == true ? 1 : 0);
+
+                    if (index->second.Attempts >= HISTORY_SPAN) {
+                        index->second.Attempts /= 2;
+                        index->second.Successes /= 2;
+                    }
+
+                    if (success == true) {
+                        LastGood& entry(_lastGood[accessPoint.SSID()]);
+                        entry.BSSID = accessPoint.BSSID();
+                        entry.Frequency = accessPoint.Frequency();
+                        _last = accessPoint.SSID();
+                    }
+                }
+
+            private:
+                HistoryMap _history;
+                LastGoodMap _lastGood;
+                string _last;
             };
+
             using Job = Core::WorkerPool::JobType<AutoConnect&>;
             using SSIDList = std::list<AccessPoint>;
 
@@ -175,6 +295,9 @@ namespace Plugin {
                 RETRY
             };
 
+            // A single channel scan is done well within this time (in ms).
+            enum { TARGETED_SCAN_TIME = 1000 };
+
         public:
             AutoConnect() = delete;
             AutoConnect(const AutoConnect&) = delete;
@@ -189,6 +312,9 @@ namespace Plugin {
                 , _interval(0)
                 , _attempts(0)
                 , _preferred()
+                , _ranking()
+                , _targeted(false)
+                , _frequency(0)
             {
             }
             ~AutoConnect() override
@@ -196,7 +322,7 @@ namespace Plugin {
             }
 
         public:
-            uint32_t Connect(const string& SSID, const uint8_t scheduleInterval, const uint32_t attempts) 
+            uint32_t Connect(const string& SSID, const uint8_t scheduleInterval, const uint32_t attempts)
             {
                 uint32_t result = Core::ERROR_INPROGRESS;
 
@@ -212,11 +338,9 @@ namespace Plugin {
 
                     MoveState (states::SCANNING);
 
-                    _controller->Scan();
+                    Scan(true);
 
                     result = Core::ERROR_NONE;
-
-                    _job.Schedule(Core::Time::Now().Add(_interval));
                 }
 
                 _adminLock.Unlock();
@@ -268,9 +392,7 @@ namespace Plugin {
 
                     MoveState(states::SCANNING);
 
-                    _controller->Scan();
-
-                    _job.Schedule(Core::Time::Now().Add(_interval));
+                    Scan(true);
                 }
 
                 _adminLock.Unlock();
@@ -282,46 +404,57 @@ namespace Plugin {
 
                 // Oke, the Job timed out, or we need a new CONNECTION request....
                 if (_state == states::SCANNING) {
-                    // Seems that the Scan did not complete in time. Lets reschedule for later...
-                    _state = states::RETRY;
-                    _job.Schedule(Core::Time::Now().Add(_interval));
+                    if (_targeted == true) {
+                        // The single channel scan did not make it in time, look at all channels.
+                        Scan(false);
+                    }
+                    else {
+                        // Seems that the Scan did not complete in time. Lets reschedule for later...
+                        _state = states::RETRY;
+                        _job.Schedule(Core::Time::Now().Add(_interval));
+                    }
                 }
                 else if (_state == states::SCANNED) {
 
                     // This is a transitional state due to the fact that the  call to
-                    // _controller->Get(net.SSID()) takes a long time, it should not 
+                    // _controller->Get(net.SSID()) takes a long time, it should not
                     // be executed on an independend worker thread.
 
                     _ssidList.clear();
 
-                    /* Arrange SSIDs in sorted order as per signal strength */
+                    /* Arrange SSIDs in sorted order as per their score */
                     WPASupplicant::Network::Iterator list(_controller->Networks());
                     while (list.Next() == true) {
                         const WPASupplicant::Network& net = list.Current();
-                        if (_controller->Get(net.SSID()).IsValid()) {
 
-                            int32_t strength(net.Signal());
-                            if (net.SSID().compare(_preferred) == 0) {
-                                strength = Core::NumberType<int32_t>::Max();
-                            }
+                        // The supplicant still reports what it found on other channels before, only
+                        // rank what the targeted scan actually saw.
+                        if (((_targeted == false) || (net.Frequency() == _frequency)) && (_controller->Get(net.SSID()).IsValid())) {
+
+                            int32_t score(_ranking.Score(net, _preferred));
 
                             SSIDList::iterator index(_ssidList.begin());
-                            while ((index != _ssidList.end()) && (index->Signal() > strength)) {
+                            while ((index != _ssidList.end()) && (index->Score() > score)) {
                                 index++;
                             }
-                            _ssidList.emplace(index, strength, net.BSSID(), net.SSID());
+                            _ssidList.emplace(index, score, net.BSSID(), net.SSID(), net.Frequency());
                         }
                     }
 
-                    if (_ssidList.size() == 0) {
-                        _state = states::RETRY;
-                    }
-                    else {
+                    if (_ssidList.size() > 0) {
                         _state = states::CONNECTING;
                         _controller->Connect(this, _ssidList.front().SSID(), _ssidList.front().BSSID());
+                        _job.Schedule(Core::Time::Now().Add(_interval));
+                    }
+                    else if (_targeted == true) {
+                        // Nothing to connect to on the known channel, look at all channels.
+                        _state = states::SCANNING;
+                        Scan(false);
+                    }
+                    else {
+                        _state = states::RETRY;
+                        _job.Schedule(Core::Time::Now().Add(_interval));
                     }
-
-                    _job.Schedule(Core::Time::Now().Add(_interval));
                 }
                 else if (_state == states::CONNECTING) {
                     // If we sre still in the CONNECTING mode, it must mean that previous CONNECT Failed
@@ -346,9 +479,7 @@ namespace Plugin {
                             --_attempts;
                         }
                         _state = states::SCANNING;
-                        _controller->Scan();
-
-                        _job.Schedule(Core::Time::Now().Add(_interval));
+                        Scan(false);
                     }
                 }
 
@@ -367,12 +498,32 @@ namespace Plugin {
 
                 _state = newState;
             }
+            // Expects the _adminLock to be taken.
+            void Scan(const bool targeted)
+            {
+                const uint32_t frequency = (targeted == true ? _ranking.Frequency(_preferred) : 0);
+
+                // After a resume we typically reconnect to where we were, so first only
+                // look at that channel. The full scan is the fallback.
+                _targeted = ((frequency != 0) && (_controller->Scan(frequency) == Core::ERROR_NONE));
+                _frequency = (_targeted == true ? frequency : 0);
+
+                if (_targeted == false) {
+                    _controller->Scan();
+                }
+
+                _job.Schedule(Core::Time::Now().Add(_targeted == true ? static_cast<uint32_t>(TARGETED_SCAN_TIME) : _interval));
+            }
             void Completed(const uint32_t result) override {
 
                 _controller->Revoke(this);
 
                 _adminLock.Lock();
 
+                if ((_state == states::CONNECTING) && (_ssidList.size() > 0)) {
+                    _ranking.Outcome(_ssidList.front(), (result == Core::ERROR_NONE));
+                }
+
                 if (result == Core::ERROR_NONE) {
 
                     MoveState(states::IDLE);
@@ -396,6 +547,9 @@ namespace Plugin {
             uint32_t _interval;
             uint32_t _attempts;
             string _preferred;
+            Ranking _ranking;
+            bool _targeted;
+            uint32_t _frequency;
         };
 
     public:
@@ -642,6 +796,8 @@ namespace Plugin {
         WifiDriver _wpaSupplicant;
         Core::ProxyType<WPASupplicant::Controller> _controller;
         AutoConnect _autoConnect;
+        uint32_t _generation;
+        std::atomic<bool> _scanRequested;
     };
 
 } // namespace Plugin
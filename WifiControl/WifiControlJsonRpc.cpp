@@ -121,6 +121,7 @@ namespace Plugin {
     //  - ERROR_UNAVAILABLE: Returned when scanning is not available for some reason
     uint32_t WifiControl::endpoint_scan()
     {
+        _scanRequested = true;
         return _controller->Scan();
     }
 
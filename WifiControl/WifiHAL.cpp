@@ -31,6 +31,7 @@ namespace WPASupplicant {
         , _adminLock()
         , _networks()
         , _enabled()
+        , _generation(0)
     {
         Init();
     }
@@ -55,6 +56,12 @@ namespace WPASupplicant {
         _isOperational = false;
     }
 
+    uint32_t Controller::Scan(const uint32_t /* frequency */)
+    {
+        // The HAL can only look at all channels, so let the caller fall back to a full scan.
+        return (Core::ERROR_UNAVAILABLE);
+    }
+
     uint32_t Controller::Scan()
     {
         uint32_t result = Core::ERROR_NONE;
@@ -101,6 +108,7 @@ namespace WPASupplicant {
                 _networks[info._ssid] = info;
             }
             TRACE_L1("_networks.size=%d", _networks.size());
+            _generation++;
 
             wifi_pairedSSIDInfo_t pairedSSIDInfo;
             memset(&pairedSSIDInfo, 0, sizeof(wifi_pairedSSIDInfo_t));
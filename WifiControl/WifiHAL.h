@@ -74,6 +74,7 @@ namespace WPASupplicant { // XXX: Change ???
         void Init();
         void Uninit();
         uint32_t Scan();
+        uint32_t Scan(const uint32_t frequency);
         uint32_t Connect(const string& SSID);
         uint32_t Disconnect(const string& SSID);
 
@@ -310,6 +311,11 @@ namespace WPASupplicant { // XXX: Change ???
         {
             return (false);
         }
+        // The HAL hands out complete tables, so every scan counts as a change.
+        inline uint32_t Generation() const
+        {
+            return (_generation);
+        }
 
         inline uint32_t Debug(const uint32_t level)
         {
@@ -329,6 +335,7 @@ namespace WPASupplicant { // XXX: Change ???
         NetworkInfoContainer _networks;
         EnabledContainer _enabled;
         bool _isOperational;
+        uint32_t _generation;
         string ssidCurrent;
     };
 }
@@ -0,0 +1,670 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Non interactive version of the performance measurements of the JSONRPCClient. It runs
+// Exchange::IPerformance of the JSONRPCPlugin over COMRPC, JSONRPC and MessagePack for a
+// sweep of payload sizes, with a number of parallel clients, and reports the latency
+// distribution per run as JSON, so results can be compared between framework releases:
+//
+//   JSONRPCBenchmark [-remote <comrpc address>] [-access <jsonrpc address>]
+//                    [-transports comrpc,jsonrpc,msgpack] [-methods send,receive,exchange]
+//                    [-sizes 0,16,128,1024] [-warmup 10] [-loops 100] [-clients 1]
+//                    [-output <file>]
+
+#define MODULE_NAME JSONRPC_Benchmark
+
+#include <core/core.h>
+#include <websocket/websocket.h>
+#include <securityagent/securityagent.h>
+#include <interfaces/IPerformance.h>
+
+#include "../JSONRPCPlugin/Data.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace WPEFramework;
+
+namespace {
+
+    typedef Core::ProxyType<RPC::InvokeServerType<1, 0, 4>> Engine;
+
+    enum method : uint8_t {
+        SEND,
+        RECEIVE,
+        EXCHANGE
+    };
+
+    static constexpr uint32_t MaxPayload = 0xFFFF;
+    static constexpr uint32_t CallTimeout = 10000;
+
+    // One connection to the JSONRPCPlugin, owned by a single client thread.
+    class Transport {
+    public:
+        virtual ~Transport()
+        {
+        }
+
+        // All methods return Core::ERROR_NONE if the call made it to the plugin and back.
+        virtual bool IsValid() const = 0;
+        virtual uint32_t Send(const uint16_t length, const uint8_t buffer[], uint32_t& received) = 0;
+        virtual uint32_t Receive(uint16_t& length, uint8_t buffer[]) = 0;
+        virtual uint32_t Exchange(uint16_t& length, uint8_t buffer[], const uint16_t maxLength) = 0;
+    };
+
+    class COMRPCTransport : public Transport {
+    public:
+        COMRPCTransport() = delete;
+        COMRPCTransport(const COMRPCTransport&) = delete;
+        COMRPCTransport& operator=(const COMRPCTransport&) = delete;
+
+        COMRPCTransport(const Core::NodeId& remote, Engine& engine)
+            : _client(Core::ProxyType<RPC::CommunicatorClient>::Create(remote, Core::ProxyType<Core::IIPCServer>(engine)))
+            , _performance(nullptr)
+        {
+            engine->Announcements(_client->Announcement());
+
+            if (_client->Open(2000) == Core::ERROR_NONE) {
+                _performance = _client->Aquire<Exchange::IPerformance>(2000, _T("JSONRPCPlugin"), ~0);
+            }
+        }
+        ~COMRPCTransport() override
+        {
+            if (_performance != nullptr) {
+                _performance->Release();
+            }
+            _client->Close(Core::infinite);
+            _client.Release();
+        }
+
+    public:
+        bool IsValid() const override
+        {
+            return (_performance != nullptr);
+        }
+        uint32_t Send(const uint16_t length, const uint8_t buffer[], uint32_t& received) override
+        {
+            // The interface returns the number of bytes received by the plugin.
+            received = _performance->Send(length, buffer);
+            return (Core::ERROR_NONE);
+        }
+        uint32_t Receive(uint16_t& length, uint8_t buffer[]) override
+        {
+            return (_performance->Receive(length, buffer));
+        }
+        uint32_t Exchange(uint16_t& length, uint8_t buffer[], const uint16_t maxLength) override
+        {
+            return (_performance->Exchange(length, buffer, maxLength));
+        }
+
+    private:
+        Core::ProxyType<RPC::CommunicatorClient> _client;
+        Exchange::IPerformance* _performance;
+    };
+
+    // INTERFACE selects the encoding: Core::JSON::IElement (JSON) or Core::JSON::IMessagePack.
+    template <typename INTERFACE>
+    class JSONRPCTransport : public Transport {
+    public:
+        JSONRPCTransport() = delete;
+        JSONRPCTransport(const JSONRPCTransport&) = delete;
+        JSONRPCTransport& operator=(const JSONRPCTransport&) = delete;
+
+        JSONRPCTransport(const string& localCallsign, const string& token)
+            : _remote(_T("JSONRPCPlugin.2"), localCallsign.c_str(), false, (token.empty() == true ? EMPTY_STRING : _T("token=") + token))
+        {
+        }
+        ~JSONRPCTransport() override
+        {
+        }
+
+    public:
+        bool IsValid() const override
+        {
+            return (true);
+        }
+        uint32_t Send(const uint16_t length, const uint8_t buffer[], uint32_t& received) override
+        {
+            Data::JSONDataBuffer message;
+            Core::JSON::DecUInt32 response;
+            string data;
+
+            Core::ToString(buffer, length, false, data);
+            message.Data = data;
+            message.Length = length;
+
+            const uint32_t result = _remote.template Invoke<Data::JSONDataBuffer, Core::JSON::DecUInt32>(CallTimeout, _T("send"), message, response);
+
+            if (result == Core::ERROR_NONE) {
+                received = response.Value();
+            }
+            return (result);
+        }
+        uint32_t Receive(uint16_t& length, uint8_t buffer[]) override
+        {
+            Core::JSON::DecUInt16 maxSize(length);
+            Data::JSONDataBuffer response;
+
+            const uint32_t result = _remote.template Invoke<Core::JSON::DecUInt16, Data::JSONDataBuffer>(CallTimeout, _T("receive"), maxSize, response);
+
+            if (result == Core::ERROR_NONE) {
+                Core::FromString(response.Data.Value(), buffer, length);
+            }
+            return (result);
+        }
+        uint32_t Exchange(uint16_t& length, uint8_t buffer[], const uint16_t maxLength) override
+        {
+            Data::JSONDataBuffer message;
+            Data::JSONDataBuffer response;
+            string data;
+
+            Core::ToString(buffer, length, false, data);
+            message.Data = data;
+            message.Length = length;
+
+            const uint32_t result = _remote.template Invoke<Data::JSONDataBuffer, Data::JSONDataBuffer>(CallTimeout, _T("exchange"), message, response);
+
+            if (result == Core::ERROR_NONE) {
+                length = maxLength;
+                Core::FromString(response.Data.Value(), buffer, length);
+            }
+            return (result);
+        }
+
+    private:
+        JSONRPC::LinkType<INTERFACE> _remote;
+    };
+
+    class Options {
+    public:
+        Options(const Options&) = delete;
+        Options& operator=(const Options&) = delete;
+
+        Options()
+            : Remote(_T("127.0.0.1:8899"))
+            , Access(_T("127.0.0.1:80"))
+            , Transports({ _T("comrpc"), _T("jsonrpc"), _T("msgpack") })
+            , Methods({ SEND, RECEIVE, EXCHANGE })
+            , Sizes({ 0, 16, 128, 256, 512, 1024, 2048, 32 * 1024 })
+            , Warmup(10)
+            , Loops(100)
+            , Clients(1)
+            , Output()
+            , Token()
+        {
+        }
+
+    public:
+        bool Parse(int argc, char** argv)
+        {
+            bool result = true;
+
+            for (int index = 1; (index < argc) && (result == true); index += 2) {
+                const string option(argv[index]);
+                const string value(index + 1 < argc ? argv[index + 1] : _T(""));
+
+                if ((value.empty() == true) || (option == _T("-h"))) {
+                    result = false;
+                } else if (option == _T("-remote")) {
+                    Remote = value;
+                } else if (option == _T("-access")) {
+                    Access = value;
+                } else if (option == _T("-transports")) {
+                    Transports = Split(value);
+                } else if (option == _T("-methods")) {
+                    Methods.clear();
+                    for (const string& entry : Split(value)) {
+                        if (entry == _T("send")) {
+                            Methods.push_back(SEND);
+                        } else if (entry == _T("receive")) {
+                            Methods.push_back(RECEIVE);
+                        } else if (entry == _T("exchange")) {
+                            Methods.push_back(EXCHANGE);
+                        } else {
+                            result = false;
+                        }
+                    }
+                } else if (option == _T("-sizes")) {
+                    Sizes.clear();
+                    for (const string& entry : Split(value)) {
+                        const uint32_t size = atoi(entry.c_str());
+                        result = result && (size <= MaxPayload);
+                        Sizes.push_back(size);
+                    }
+                } else if (option == _T("-warmup")) {
+                    Warmup = atoi(value.c_str());
+                } else if (option == _T("-loops")) {
+                    Loops = atoi(value.c_str());
+                } else if (option == _T("-clients")) {
+                    Clients = atoi(value.c_str());
+                } else if (option == _T("-output")) {
+                    Output = value;
+                } else {
+                    result = false;
+                }
+            }
+
+            return ((result == true) && (Loops > 0) && (Clients > 0));
+        }
+
+    private:
+        static std::vector<string> Split(const string& value)
+        {
+            std::vector<string> result;
+            Core::TextSegmentIterator index(Core::TextFragment(value), false, ',');
+
+            while (index.Next() == true) {
+                result.push_back(index.Current().Text());
+            }
+            return (result);
+        }
+
+    public:
+        string Remote;
+        string Access;
+        std::vector<string> Transports;
+        std::vector<method> Methods;
+        std::vector<uint32_t> Sizes;
+        uint32_t Warmup;
+        uint32_t Loops;
+        uint32_t Clients;
+        string Output;
+        string Token;
+    };
+
+    class Result : public Core::JSON::Container {
+    public:
+        class Distribution : public Core::JSON::Container {
+        public:
+            Distribution(const Distribution&) = delete;
+            Distribution& operator=(const Distribution&) = delete;
+
+            Distribution()
+                : Core::JSON::Container()
+            {
+                Add(_T("min"), &Min);
+                Add(_T("average"), &Average);
+                Add(_T("p50"), &P50);
+                Add(_T("p90"), &P90);
+                Add(_T("p99"), &P99);
+                Add(_T("max"), &Max);
+            }
+            ~Distribution()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt64 Min;
+            Core::JSON::DecUInt64 Average;
+            Core::JSON::DecUInt64 P50;
+            Core::JSON::DecUInt64 P90;
+            Core::JSON::DecUInt64 P99;
+            Core::JSON::DecUInt64 Max;
+        };
+
+    public:
+        Result()
+            : Core::JSON::Container()
+        {
+            Init();
+        }
+        Result(const Result& copy)
+            : Core::JSON::Container()
+            , Transport(copy.Transport)
+            , Method(copy.Method)
+            , Size(copy.Size)
+            , Clients(copy.Clients)
+            , Calls(copy.Calls)
+            , Errors(copy.Errors)
+            , Duration(copy.Duration)
+            , Rate(copy.Rate)
+        {
+            Init();
+            Latency.Min = copy.Latency.Min;
+            Latency.Average = copy.Latency.Average;
+            Latency.P50 = copy.Latency.P50;
+            Latency.P90 = copy.Latency.P90;
+            Latency.P99 = copy.Latency.P99;
+            Latency.Max = copy.Latency.Max;
+        }
+        ~Result()
+        {
+        }
+
+    private:
+        void Init()
+        {
+            Add(_T("transport"), &Transport);
+            Add(_T("method"), &Method);
+            Add(_T("size"), &Size);
+            Add(_T("clients"), &Clients);
+            Add(_T("calls"), &Calls);
+            Add(_T("errors"), &Errors);
+            Add(_T("duration"), &Duration);
+            Add(_T("rate"), &Rate);
+            Add(_T("latency"), &Latency);
+        }
+
+    public:
+        Core::JSON::String Transport;
+        Core::JSON::String Method;
+        Core::JSON::DecUInt32 Size; // Payload in bytes
+        Core::JSON::DecUInt32 Clients;
+        Core::JSON::DecUInt32 Calls;
+        Core::JSON::DecUInt32 Errors;
+        Core::JSON::DecUInt64 Duration; // Wall clock of the run, in us
+        Core::JSON::DecUInt32 Rate; // Calls per second, all clients together
+        Distribution Latency; // Per call, in us
+    };
+
+    class Report : public Core::JSON::Container {
+    public:
+        Report(const Report&) = delete;
+        Report& operator=(const Report&) = delete;
+
+        Report()
+            : Core::JSON::Container()
+        {
+            Add(_T("warmup"), &Warmup);
+            Add(_T("loops"), &Loops);
+            Add(_T("results"), &Results);
+        }
+        ~Report()
+        {
+        }
+
+    public:
+        Core::JSON::DecUInt32 Warmup;
+        Core::JSON::DecUInt32 Loops;
+        Core::JSON::ArrayType<Result> Results;
+    };
+
+    // A client runs the calls of one run on its own thread and connection.
+    class Client : public Core::Thread {
+    public:
+        Client() = delete;
+        Client(const Client&) = delete;
+        Client& operator=(const Client&) = delete;
+
+        Client(Transport* transport, const method call, const uint16_t size, const uint32_t warmup, const uint32_t loops)
+            : Core::Thread(Core::Thread::DefaultStackSize(), _T("BenchmarkClient"))
+            , _transport(transport)
+            , _method(call)
+            , _size(size)
+            , _warmup(warmup)
+            , _loops(loops)
+            , _samples()
+            , _errors(0)
+            , _buffer(new uint8_t[MaxPayload])
+        {
+            static const uint8_t pattern[] = { 0x00, 0x55, 0xAA, 0xFF };
+
+            for (uint32_t index = 0; index < MaxPayload; index++) {
+                _buffer[index] = pattern[index % sizeof(pattern)];
+            }
+            _samples.reserve(loops);
+        }
+        ~Client() override
+        {
+            Stop();
+            Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+
+            delete[] _buffer;
+        }
+
+    public:
+        const std::vector<uint32_t>& Samples() const
+        {
+            return (_samples);
+        }
+        uint32_t Errors() const
+        {
+            return (_errors);
+        }
+
+    private:
+        uint32_t Worker() override
+        {
+            for (uint32_t run = 0; run < _warmup; run++) {
+                Call();
+            }
+
+            _errors = 0;
+
+            for (uint32_t run = 0; run < _loops; run++) {
+                const uint64_t start = Core::Time::Now().Ticks();
+                const bool succeeded = Call();
+                _samples.push_back(static_cast<uint32_t>(Core::Time::Now().Ticks() - start));
+
+                if (succeeded == false) {
+                    _errors++;
+                }
+            }
+
+            Block();
+
+            return (Core::infinite);
+        }
+        bool Call()
+        {
+            uint16_t length = _size;
+            uint32_t result = Core::ERROR_NONE;
+
+            switch (_method) {
+            case SEND: {
+                uint32_t received = 0;
+
+                result = _transport->Send(length, _buffer, received);
+
+                if ((result == Core::ERROR_NONE) && (received != length)) {
+                    result = Core::ERROR_GENERAL;
+                }
+                break;
+            }
+            case RECEIVE:
+                result = _transport->Receive(length, _buffer);
+                break;
+            case EXCHANGE:
+                result = _transport->Exchange(length, _buffer, MaxPayload);
+                break;
+            }
+            return (result == Core::ERROR_NONE);
+        }
+
+    private:
+        Transport* _transport;
+        const method _method;
+        const uint16_t _size;
+        const uint32_t _warmup;
+        const uint32_t _loops;
+        std::vector<uint32_t> _samples;
+        uint32_t _errors;
+        uint8_t* _buffer;
+    };
+
+    Transport* Create(const string& transport, const uint32_t index, const Options& options, Engine& engine)
+    {
+        Transport* result = nullptr;
+        const string callsign(_T("client.benchmark.") + Core::NumberType<uint32_t>(index).Text());
+
+        if (transport == _T("comrpc")) {
+            result = new COMRPCTransport(Core::NodeId(options.Remote.c_str()), engine);
+        } else if (transport == _T("jsonrpc")) {
+            result = new JSONRPCTransport<Core::JSON::IElement>(callsign, options.Token);
+        } else if (transport == _T("msgpack")) {
+            result = new JSONRPCTransport<Core::JSON::IMessagePack>(callsign, options.Token);
+        }
+
+        if ((result != nullptr) && (result->IsValid() == false)) {
+            delete result;
+            result = nullptr;
+        }
+
+        return (result);
+    }
+
+    uint32_t Percentile(const std::vector<uint32_t>& sorted, const uint32_t percentile)
+    {
+        return (sorted[((sorted.size() - 1) * percentile) / 100]);
+    }
+
+    void Run(const Options& options, const std::vector<Transport*>& transports, const string& transport, const method call, const uint32_t size, Result& result)
+    {
+        static const TCHAR* methodNames[] = { _T("send"), _T("receive"), _T("exchange") };
+
+        std::vector<Client*> clients;
+
+        for (Transport* entry : transports) {
+            clients.push_back(new Client(entry, call, static_cast<uint16_t>(size), options.Warmup, options.Loops));
+        }
+
+        const uint64_t start = Core::Time::Now().Ticks();
+
+        for (Client* client : clients) {
+            client->Run();
+        }
+
+        std::vector<uint32_t> samples;
+        uint32_t errors = 0;
+
+        for (Client* client : clients) {
+            client->Wait(Core::Thread::BLOCKED | Core::Thread::STOPPED, Core::infinite);
+            samples.insert(samples.end(), client->Samples().begin(), client->Samples().end());
+            errors += client->Errors();
+        }
+
+        const uint64_t duration = std::max(Core::Time::Now().Ticks() - start, static_cast<uint64_t>(1));
+
+        for (Client* client : clients) {
+            delete client;
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        uint64_t total = 0;
+        for (const uint32_t sample : samples) {
+            total += sample;
+        }
+
+        result.Transport = transport;
+        result.Method = methodNames[call];
+        result.Size = size;
+        result.Clients = static_cast<uint32_t>(transports.size());
+        result.Calls = static_cast<uint32_t>(samples.size());
+        result.Errors = errors;
+        result.Duration = duration;
+        result.Rate = static_cast<uint32_t>((samples.size() * Core::Time::TicksPerMillisecond * 1000) / duration);
+        result.Latency.Min = samples.front();
+        result.Latency.Average = total / samples.size();
+        result.Latency.P50 = Percentile(samples, 50);
+        result.Latency.P90 = Percentile(samples, 90);
+        result.Latency.P99 = Percentile(samples, 99);
+        result.Latency.Max = samples.back();
+
+        fprintf(stderr, "%-8s %-8s %6u bytes: p50 %6u us, p99 %6u us, max %6u us, %u errors\n",
+            transport.c_str(), methodNames[call], size,
+            Percentile(samples, 50), Percentile(samples, 99), samples.back(), errors);
+    }
+
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    int status = 0;
+
+    if (options.Parse(argc, argv) == false) {
+        fprintf(stderr, "Usage: %s [-remote <comrpc address>] [-access <jsonrpc address>]\n"
+                        "       [-transports comrpc,jsonrpc,msgpack] [-methods send,receive,exchange]\n"
+                        "       [-sizes 0,16,128,1024] [-warmup 10] [-loops 100] [-clients 1] [-output <file>]\n", argv[0]);
+        return (1);
+    }
+
+    Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), options.Access.c_str());
+
+    {
+        // With the SecurityAgent active the JSONRPC channels need a token, get one the
+        // same way the JSONRPCClient does. Without it, the token is simply not passed.
+        uint8_t payload[] = "http://localhost/JSONRPCBenchmark";
+        uint8_t buffer[2 * 1024];
+        int length;
+
+        ::memcpy(buffer, payload, sizeof(payload));
+
+        if ((length = ::GetToken(sizeof(buffer), sizeof(payload), buffer)) > 0) {
+            options.Token = string(reinterpret_cast<const char*>(buffer), length);
+        }
+    }
+
+    {
+        Engine engine(Engine::Create());
+        Report report;
+
+        report.Warmup = options.Warmup;
+        report.Loops = options.Loops;
+
+        for (const string& transport : options.Transports) {
+            std::vector<Transport*> transports;
+
+            for (uint32_t index = 0; index < options.Clients; index++) {
+                Transport* entry = Create(transport, index, options, engine);
+
+                if (entry == nullptr) {
+                    fprintf(stderr, "Could not set up %s client %u, skipping %s.\n", transport.c_str(), index, transport.c_str());
+                    status = 1;
+                    break;
+                }
+                transports.push_back(entry);
+            }
+
+            if (transports.size() == options.Clients) {
+                for (const method call : options.Methods) {
+                    for (const uint32_t size : options.Sizes) {
+                        Run(options, transports, transport, call, size, report.Results.Add());
+                    }
+                }
+            }
+
+            for (Transport* entry : transports) {
+                delete entry;
+            }
+        }
+
+        string output;
+        report.ToString(output);
+
+        if (options.Output.empty() == true) {
+            printf("%s\n", output.c_str());
+        } else {
+            Core::File file(options.Output);
+
+            if (file.Create() == true) {
+                file.Write(reinterpret_cast<const uint8_t*>(output.c_str()), static_cast<uint32_t>(output.length()));
+                file.Close();
+            } else {
+                fprintf(stderr, "Could not write the report to: %s\n", options.Output.c_str());
+                status = 1;
+            }
+        }
+    }
+
+    Core::Singleton::Dispose();
+
+    return (status);
+}
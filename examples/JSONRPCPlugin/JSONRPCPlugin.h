@@ -178,6 +178,11 @@ namespace Plugin {
                 : BaseClass(5, JSONObjectFactory<INTERFACE>::Instance(), false, false, false, connector, remoteNode.AnyInterface(), 8096, 8096)
                 , _id(0)
                 , _parent(static_cast<JSONRPCChannel<INTERFACE>&>(*parent))
+                , _buffer()
+                , _data()
+                , _response()
+                , _length()
+                , _result()
             {
             }
             virtual ~JSONRPCServer()
@@ -230,82 +235,87 @@ namespace Plugin {
             {
                 _id = id;
             }
+            static bool Tracing()
+            {
+                return (Trace::TraceType<Trace::Information, &Core::System::MODULE_NAME>::IsEnabled());
+            }
+            // Only for tracing the outgoing frames, so do not serialize them if nobody looks.
             void ToMessage(const Core::ProxyType<Core::JSON::IElement>& jsonObject) const
             {
-                string jsonMessage;
-                jsonObject->ToString(jsonMessage);
-
-                TRACE(Trace::Information, (_T("   Bytes: %d\n"), static_cast<uint32_t>(jsonMessage.size())));
-                TRACE(Trace::Information, (_T("Received: %s\n"), jsonMessage.c_str()));
+                if (Tracing() == true) {
+                    string jsonMessage;
+                    jsonObject->ToString(jsonMessage);
 
+                    TRACE(Trace::Information, (_T("   Bytes: %d\n"), static_cast<uint32_t>(jsonMessage.size())));
+                    TRACE(Trace::Information, (_T("Received: %s\n"), jsonMessage.c_str()));
+                }
             }
             void ToMessage(const Core::ProxyType<Core::JSON::IMessagePack>& jsonObject) const
             {
-                std::vector<uint8_t> message;
-                jsonObject->ToBuffer(message);
-                string jsonMessage(message.begin(), message.end());
+                if (Tracing() == true) {
+                    std::vector<uint8_t> message;
+                    jsonObject->ToBuffer(message);
 
-                TRACE(Trace::Information, (_T("   Bytes: %d\n"), static_cast<uint32_t>(jsonMessage.size())));
-                TRACE(Trace::Information, (_T("Received: %s\n"), jsonMessage.c_str()));
+                    // The frame is binary, printing it as text tells nothing.
+                    TRACE(Trace::Information, (_T("   Bytes: %d\n"), static_cast<uint32_t>(message.size())));
+                }
             }
-            void ToMessage(const Core::JSON::IElement* jsonObject, string& jsonMessage) const
+            void ToMessage(const Core::JSON::IElement* jsonObject, string& jsonMessage)
             {
                 jsonObject->ToString(jsonMessage);
 
                 TRACE(Trace::Information, (_T("   Bytes: %d\n"), static_cast<uint32_t>(jsonMessage.size())));
-                TRACE(Trace::Information, (_T("Received: %s\n"), jsonMessage.c_str()));
             }
-            void ToMessage(const Core::JSON::IMessagePack* jsonObject, string& jsonMessage) const
+            // The opaque Result of the message carries the MessagePack encoding as is, so
+            // it is embedded in the response frame without a textual step in between.
+            void ToMessage(const Core::JSON::IMessagePack* jsonObject, string& jsonMessage)
             {
-                std::vector<uint8_t> message;
-                jsonObject->ToBuffer(message);
-                string strMessage(message.begin(), message.end());
-                jsonMessage = strMessage;
+                _buffer.clear();
+                jsonObject->ToBuffer(_buffer);
+                jsonMessage.assign(_buffer.begin(), _buffer.end());
 
                 TRACE(Trace::Information, (_T("   Bytes: %d\n"), static_cast<uint32_t>(jsonMessage.size())));
-                TRACE(Trace::Information, (_T("Received: %s\n"), jsonMessage.c_str()));
             }
+            // The parameter and result objects are reused for all messages on this connection,
+            // the messages themselves come from the pool of the JSONObjectFactory.
             void ProcessMessage(Core::ProxyType<Core::JSONRPC::Message>& message)
             {
                 ASSERT(message->Designator.IsSet() == true);
 
-                string designator = message->Designator.Value();
+                const string& designator = message->Designator.Value();
                 std::size_t found = designator.find_last_of(".");
                 string method(designator, found + 1, string::npos);
+                string result;
 
                 if (method == "send") {
                     if (message->Parameters.IsSet() == true) {
-                        Data::JSONDataBuffer data;
-                        FromMessage((INTERFACE*)&data, message);
-                        Core::JSON::DecUInt32 result = 0;
-                        _parent.Interface().send(data, result);
-                        message->Result = Core::NumberType<uint32_t>(result.Value()).Text();
+                        _data.Clear();
+                        FromMessage((INTERFACE*)&_data, message);
+                        _result = 0;
+                        _parent.Interface().send(_data, _result);
+                        ToMessage((INTERFACE*)&_result, result);
                     }
                 } else if (method == "receive") {
-                    string result;
                     if (message->Parameters.IsSet() == true) {
-                        Data::JSONDataBuffer response;
-                        Core::JSON::DecUInt16 length;
-                        FromMessage((INTERFACE*)&length, message);
-                        _parent.Interface().receive(length, response);
-                        response.ToString(result);
+                        _length.Clear();
+                        _response.Clear();
+                        FromMessage((INTERFACE*)&_length, message);
+                        _parent.Interface().receive(_length, _response);
+                        ToMessage((INTERFACE*)&_response, result);
                      }
-                     message->Result = result;
                 } else if (method == "exchange") {
-                    string result;
                     if (message->Parameters.IsSet() == true) {
-                        Data::JSONDataBuffer data;
-                        FromMessage((INTERFACE*)&data, message);
-
-                        Data::JSONDataBuffer response;
-                        _parent.Interface().exchange(data, response);
-                        ToMessage((INTERFACE*)&response, result);
+                        _data.Clear();
+                        _response.Clear();
+                        FromMessage((INTERFACE*)&_data, message);
+                        _parent.Interface().exchange(_data, _response);
+                        ToMessage((INTERFACE*)&_response, result);
                     }
-                    message->Result = result;
                 } else {
                     TRACE_L1("Unknown method");
                 }
 
+                message->Result = result;
                 message->Parameters.Clear();
                 message->Designator.Clear();
                 message->JSONRPC = Core::JSONRPC::Message::DefaultVersion;
@@ -316,14 +326,19 @@ namespace Plugin {
             }
             void FromMessage(Core::JSON::IMessagePack* jsonObject, const Core::ProxyType<Core::JSONRPC::Message>& message)
             {
-                string value = message->Parameters.Value();
-                std::vector<uint8_t> parameter(value.begin(), value.end());
+                const string& value = message->Parameters.Value();
 
-                jsonObject->FromBuffer(parameter);
+                _buffer.assign(value.begin(), value.end());
+                jsonObject->FromBuffer(_buffer);
             }
         private:
             uint32_t _id;
             JSONRPCChannel<INTERFACE>& _parent;
+            std::vector<uint8_t> _buffer;
+            Data::JSONDataBuffer _data;
+            Data::JSONDataBuffer _response;
+            Core::JSON::DecUInt16 _length;
+            Core::JSON::DecUInt32 _result;
         };
 
         template <typename INTERFACE>
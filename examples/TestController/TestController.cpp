@@ -18,49 +18,89 @@
  */
  
 #include "TestController.h"
+#include "MemoryObserver.h"
+
+#include <cmath>
 
 namespace WPEFramework {
 namespace TestController {
 
     Exchange::IMemory* MemoryObserver(const RPC::IRemoteConnection* connection)
     {
-        class MemoryObserverImpl : public Exchange::IMemory {
-        public:
-            MemoryObserverImpl() = delete;
-            MemoryObserverImpl(const MemoryObserverImpl&) = delete;
-            MemoryObserverImpl& operator=(const MemoryObserverImpl&) = delete;
-
-            MemoryObserverImpl(const RPC::IRemoteConnection* connection)
-                : _main(connection  == nullptr ? Core::ProcessInfo().Id() : connection->RemoteId())
-            {
-            }
-            ~MemoryObserverImpl() {}
+        return (Core::Service<Plugin::MemoryObserverImpl>::Create<Exchange::IMemory>(connection == nullptr ? 0 : connection->RemoteId()));
+    }
+
+    // Not cached, the measurements compare the figures right before and after a test run.
+    Exchange::IMemory* MemoryProbe(const RPC::IRemoteConnection* connection)
+    {
+        return (Core::Service<Plugin::MemoryObserverImpl>::Create<Exchange::IMemory>(connection == nullptr ? 0 : connection->RemoteId(), false, 0));
+    }
+} // namespace TestController
+
+namespace Plugin {
+    SERVICE_REGISTRATION(TestController, 1, 0);
 
-        public:
-            virtual uint64_t Resident() const { return _main.Resident(); }
+    // User and system time spent by the process, in us.
+    static uint64_t ProcessorTime(const uint32_t pid)
+    {
+        uint64_t result = 0;
 
-            virtual uint64_t Allocated() const { return _main.Allocated(); } 
+#ifdef __LINUX__
+        static const uint64_t ticksPerSecond = ::sysconf(_SC_CLK_TCK);
 
-            virtual uint64_t Shared() const { return _main.Shared(); }
+        char path[64];
+        char buffer[512];
 
-            virtual uint8_t Processes() const { return (IsOperational() ? 1 : 0); }
+        ::snprintf(path, sizeof(path), "/proc/%u/stat", pid);
 
-            virtual const bool IsOperational() const { return _main.IsActive(); }
+        int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd >= 0) {
+            ssize_t size = ::read(fd, buffer, sizeof(buffer) - 1);
+            ::close(fd);
 
-            BEGIN_INTERFACE_MAP(MemoryObserverImpl)
-            INTERFACE_ENTRY(Exchange::IMemory)
-            END_INTERFACE_MAP
+            if (size > 0) {
+                buffer[size] = '\0';
 
-        private:
-            Core::ProcessInfo _main;
-        };
+                // The process name can hold spaces, the fields are counted from its closing bracket.
+                const char* fields = ::strrchr(buffer, ')');
+                unsigned long long user = 0, system = 0;
 
-        return (Core::Service<MemoryObserverImpl>::Create<Exchange::IMemory>(connection));
+                if ((fields != nullptr) && (::sscanf(fields + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu", &user, &system) == 2)) {
+                    result = ((user + system) * 1000000) / ticksPerSecond;
+                }
+            }
+        }
+#else
+        DEBUG_VARIABLE(pid);
+#endif
+
+        return (result);
     }
-} // namespace TestController
 
-namespace Plugin {
-    SERVICE_REGISTRATION(TestController, 1, 0);
+    // Sorts the samples.
+    /* static */ void TestController::Measurement::Statistics(std::vector<int64_t>& samples, MeasureStatistics& statistics)
+    {
+        if (samples.empty() == false) {
+            std::sort(samples.begin(), samples.end());
+
+            double sum = 0;
+            for (const int64_t sample : samples) {
+                sum += static_cast<double>(sample);
+            }
+            const double average = sum / samples.size();
+
+            double variance = 0;
+            for (const int64_t sample : samples) {
+                variance += (sample - average) * (sample - average);
+            }
+
+            statistics.Min = samples.front();
+            statistics.Max = samples.back();
+            statistics.Average = static_cast<int64_t>(average);
+            statistics.Median = samples[samples.size() / 2];
+            statistics.Deviation = static_cast<int64_t>(std::sqrt(variance / samples.size()));
+        }
+    }
 
     /* virtual */ const string TestController::Initialize(PluginHost::IShell* service)
     {
@@ -87,6 +127,8 @@ namespace Plugin {
 
                 ASSERT(_memory != nullptr);
 
+                _measurement.Attach(WPEFramework::TestController::MemoryProbe(connection), connection->RemoteId());
+
                 connection->Release();
                 _testControllerImp->Setup();
             } else {
@@ -112,6 +154,8 @@ namespace Plugin {
         ASSERT(_testControllerImp != nullptr);
         ASSERT(_memory != nullptr);
 
+        _measurement.Detach();
+
         _testControllerImp->TearDown();
 
         if (_testControllerImp->Release() != Core::ERROR_DESTRUCTION_SUCCEEDED) {
@@ -231,6 +275,8 @@ namespace Plugin {
         string result = EMPTY_STRING;
         OverallTestResults jsonResults;
 
+        _adminLock.Lock();
+
         if (categoryName == EMPTY_STRING) {
             Exchange::ITestController::ICategory::IIterator* categories = _testControllerImp->Categories();
 
@@ -267,6 +313,8 @@ namespace Plugin {
             }
         }
 
+        _adminLock.Unlock();
+
         result = EMPTY_STRING;
         jsonResults.ToString(result);
         return result;
@@ -277,6 +325,8 @@ namespace Plugin {
         string response = EMPTY_STRING;
         OverallTestResults jsonResults;
 
+        _adminLock.Lock();
+
         Exchange::ITestController::ICategory* category = _testControllerImp->Category(categoryName);
 
         if (category != nullptr) {
@@ -293,11 +343,168 @@ namespace Plugin {
             }
         }
 
+        _adminLock.Unlock();
+
         response = EMPTY_STRING;
         jsonResults.ToString(response);
         return response;
     }
 
+    uint32_t TestController::Measurement::Run(Exchange::ITestController* controller, const MeasureParameters& params, MeasureResults& report)
+    {
+        uint32_t result = Core::ERROR_NONE;
+
+        if (params.Category.IsSet() == true) {
+            Exchange::ITestController::ICategory* category = controller->Category(params.Category.Value());
+
+            if (category != nullptr) {
+                _categories.push_back(category);
+            }
+        } else {
+            Exchange::ITestController::ICategory::IIterator* categories = controller->Categories();
+
+            if (categories != nullptr) {
+                while (categories->Next() == true) {
+                    _categories.push_back(categories->Category());
+                }
+                categories->Release();
+            }
+        }
+
+        if (_categories.empty() == true) {
+            result = Core::ERROR_UNAVAILABLE;
+        } else {
+            const uint32_t parallel = std::min(std::max(static_cast<uint32_t>(params.Parallel.Value()), 1u), static_cast<uint32_t>(_categories.size()));
+
+            _test = params.Test.Value();
+            _args = params.Args.Value();
+            _repeat = std::max(params.Repeat.Value(), static_cast<uint16_t>(1));
+            _next = 0;
+            _results.resize(_categories.size());
+
+            const uint64_t start = Core::Time::Now().Ticks();
+
+            std::list<Lane> lanes;
+            for (uint32_t index = 0; index < parallel; index++) {
+                lanes.emplace_back(*this);
+            }
+            for (Lane& lane : lanes) {
+                lane.Run();
+            }
+            for (Lane& lane : lanes) {
+                lane.Wait(Core::Thread::BLOCKED | Core::Thread::STOPPED, Core::infinite);
+            }
+            lanes.clear();
+
+            report.Repeat = _repeat;
+            report.Parallel = static_cast<uint8_t>(parallel);
+            report.Duration = Core::Time::Now().Ticks() - start;
+
+            // Report in the order of the categories, not in the order they finished.
+            for (const std::list<MeasureResults::Entry>& category : _results) {
+                for (const MeasureResults::Entry& entry : category) {
+                    report.Tests.Add(entry);
+                }
+            }
+
+            if (report.Tests.Length() == 0) {
+                result = Core::ERROR_UNAVAILABLE;
+            }
+        }
+
+        _categories.clear();
+        _results.clear();
+
+        return (result);
+    }
+
+    void TestController::Measurement::Process()
+    {
+        _adminLock.Lock();
+
+        while (_next < _categories.size()) {
+            const uint32_t index = _next++;
+
+            _adminLock.Unlock();
+
+            Exchange::ITestController::ICategory* category = _categories[index];
+
+            category->Setup();
+
+            if (_test.empty() == false) {
+                Exchange::ITestController::ITest* test = category->Test(_test);
+
+                if (test != nullptr) {
+                    Measure(category, test, _results[index]);
+                }
+            } else {
+                Exchange::ITestController::ITest::IIterator* tests = category->Tests();
+
+                if (tests != nullptr) {
+                    while (tests->Next() == true) {
+                        Measure(category, tests->Test(), _results[index]);
+                    }
+                    tests->Release();
+                }
+            }
+
+            category->TearDown();
+
+            _adminLock.Lock();
+        }
+
+        _adminLock.Unlock();
+    }
+
+    void TestController::Measurement::Measure(Exchange::ITestController::ICategory* category, Exchange::ITestController::ITest* test, std::list<MeasureResults::Entry>& results)
+    {
+        std::vector<int64_t> wall;
+        std::vector<int64_t> processor;
+        std::vector<int64_t> memory;
+        uint32_t passed = 0;
+
+        wall.reserve(_repeat);
+        processor.reserve(_repeat);
+        memory.reserve(_repeat);
+
+        for (uint16_t run = 0; run < _repeat; run++) {
+            Sample before, after;
+
+            // Take the wall clock closest to the test, reading the process figures takes time too.
+            Take(before);
+            before.Wall = Core::Time::Now().Ticks();
+            const string outcome(test->Execute(_args));
+            after.Wall = Core::Time::Now().Ticks();
+            Take(after);
+
+            wall.push_back(static_cast<int64_t>(after.Wall - before.Wall));
+            processor.push_back(static_cast<int64_t>(after.Processor - before.Processor));
+            memory.push_back(static_cast<int64_t>(after.Resident) - static_cast<int64_t>(before.Resident));
+
+            TestCore::TestResult result;
+            if ((result.FromString(outcome) == true) && (result.OverallStatus.Value() == _T("Success"))) {
+                passed++;
+            }
+        }
+
+        results.emplace_back();
+
+        MeasureResults::Entry& entry(results.back());
+        entry.Category = category->Name();
+        entry.Test = test->Name();
+        entry.Runs = _repeat;
+        entry.Passed = passed;
+        Statistics(wall, entry.Wall);
+        Statistics(processor, entry.Cpu);
+        Statistics(memory, entry.Memory);
+    }
+
+    void TestController::Measurement::Take(Sample& sample) const
+    {
+        sample.Resident = (_probe != nullptr ? _probe->Resident() : 0);
+        sample.Processor = ProcessorTime(_pid);
+    }
+
     void TestController::TestPreparation(Exchange::ITestController::ICategory* const category, const string& categoryName)
     {
         if (_prevCategory != categoryName) {
@@ -97,15 +97,289 @@ namespace Plugin {
             Core::JSON::ArrayType<TestCore::TestResult> Results;
         };
 
+        class MeasureStatistics : public Core::JSON::Container {
+        public:
+            MeasureStatistics()
+                : Core::JSON::Container()
+                , Min()
+                , Max()
+                , Average()
+                , Median()
+                , Deviation()
+            {
+                Init();
+            }
+            MeasureStatistics(const MeasureStatistics& copy)
+                : Core::JSON::Container()
+                , Min(copy.Min)
+                , Max(copy.Max)
+                , Average(copy.Average)
+                , Median(copy.Median)
+                , Deviation(copy.Deviation)
+            {
+                Init();
+            }
+            MeasureStatistics& operator=(const MeasureStatistics& rhs)
+            {
+                Min = rhs.Min;
+                Max = rhs.Max;
+                Average = rhs.Average;
+                Median = rhs.Median;
+                Deviation = rhs.Deviation;
+                return (*this);
+            }
+
+            ~MeasureStatistics() = default;
+
+        private:
+            void Init()
+            {
+                Add(_T("min"), &Min);
+                Add(_T("max"), &Max);
+                Add(_T("average"), &Average);
+                Add(_T("median"), &Median);
+                Add(_T("deviation"), &Deviation);
+            }
+
+        public:
+            Core::JSON::DecSInt64 Min;
+            Core::JSON::DecSInt64 Max;
+            Core::JSON::DecSInt64 Average;
+            Core::JSON::DecSInt64 Median;
+            Core::JSON::DecSInt64 Deviation;
+        };
+
+        class MeasureParameters : public Core::JSON::Container {
+        private:
+            MeasureParameters(const MeasureParameters&) = delete;
+            MeasureParameters& operator=(const MeasureParameters&) = delete;
+
+        public:
+            MeasureParameters()
+                : Core::JSON::Container()
+                , Category()
+                , Test()
+                , Args()
+                , Repeat(1)
+                , Parallel(1)
+            {
+                Add(_T("category"), &Category);
+                Add(_T("test"), &Test);
+                Add(_T("args"), &Args);
+                Add(_T("repeat"), &Repeat);
+                Add(_T("parallel"), &Parallel);
+            }
+
+            ~MeasureParameters() = default;
+
+        public:
+            Core::JSON::String Category; // All categories if not set
+            Core::JSON::String Test; // All tests of the category if not set
+            Core::JSON::String Args;
+            Core::JSON::DecUInt16 Repeat; // Runs of every test
+            Core::JSON::DecUInt8 Parallel; // Categories that are run at the same time, at most
+        };
+
+        class MeasureResults : public Core::JSON::Container {
+        public:
+            class Entry : public Core::JSON::Container {
+            public:
+                Entry()
+                    : Core::JSON::Container()
+                    , Category()
+                    , Test()
+                    , Runs()
+                    , Passed()
+                    , Wall()
+                    , Cpu()
+                    , Memory()
+                {
+                    Init();
+                }
+                Entry(const Entry& copy)
+                    : Core::JSON::Container()
+                    , Category(copy.Category)
+                    , Test(copy.Test)
+                    , Runs(copy.Runs)
+                    , Passed(copy.Passed)
+                    , Wall(copy.Wall)
+                    , Cpu(copy.Cpu)
+                    , Memory(copy.Memory)
+                {
+                    Init();
+                }
+                Entry& operator=(const Entry& rhs)
+                {
+                    Category = rhs.Category;
+                    Test = rhs.Test;
+                    Runs = rhs.Runs;
+                    Passed = rhs.Passed;
+                    Wall = rhs.Wall;
+                    Cpu = rhs.Cpu;
+                    Memory = rhs.Memory;
+                    return (*this);
+                }
+
+                ~Entry() = default;
+
+            private:
+                void Init()
+                {
+                    Add(_T("category"), &Category);
+                    Add(_T("test"), &Test);
+                    Add(_T("runs"), &Runs);
+                    Add(_T("passed"), &Passed);
+                    Add(_T("wall"), &Wall);
+                    Add(_T("cpu"), &Cpu);
+                    Add(_T("memory"), &Memory);
+                }
+
+            public:
+                Core::JSON::String Category;
+                Core::JSON::String Test;
+                Core::JSON::DecUInt32 Runs;
+                Core::JSON::DecUInt32 Passed;
+                MeasureStatistics Wall; // In us
+                MeasureStatistics Cpu; // In us
+                MeasureStatistics Memory; // Change of the resident memory, in bytes
+            };
+
+        private:
+            MeasureResults(const MeasureResults&) = delete;
+            MeasureResults& operator=(const MeasureResults&) = delete;
+
+        public:
+            MeasureResults()
+                : Core::JSON::Container()
+                , Repeat()
+                , Parallel()
+                , Duration()
+                , Tests()
+            {
+                Add(_T("repeat"), &Repeat);
+                Add(_T("parallel"), &Parallel);
+                Add(_T("duration"), &Duration);
+                Add(_T("tests"), &Tests);
+            }
+
+            ~MeasureResults() = default;
+
+        public:
+            Core::JSON::DecUInt16 Repeat;
+            Core::JSON::DecUInt8 Parallel;
+            Core::JSON::DecUInt64 Duration; // In us
+            Core::JSON::ArrayType<Entry> Tests;
+        };
+
+        // Runs the selected tests the requested number of times and collects the elapsed time,
+        // the CPU time and the change in resident memory of the test process for every run.
+        // The tests of a category share its Setup/TearDown, so a category is run on a single
+        // lane, but different categories can run in parallel.
+        class Measurement {
+        private:
+            class Lane : public Core::Thread {
+            public:
+                Lane() = delete;
+                Lane(const Lane&) = delete;
+                Lane& operator=(const Lane&) = delete;
+
+                explicit Lane(Measurement& parent)
+                    : Core::Thread(Core::Thread::DefaultStackSize(), _T("TestLane"))
+                    , _parent(parent)
+                {
+                }
+                ~Lane() override
+                {
+                    Stop();
+                    Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+                }
+
+            private:
+                uint32_t Worker() override
+                {
+                    _parent.Process();
+
+                    Block();
+
+                    return (Core::infinite);
+                }
+
+            private:
+                Measurement& _parent;
+            };
+
+            struct Sample {
+                uint64_t Wall;
+                uint64_t Processor;
+                uint64_t Resident;
+            };
+
+        public:
+            Measurement(const Measurement&) = delete;
+            Measurement& operator=(const Measurement&) = delete;
+
+            Measurement()
+                : _adminLock()
+                , _probe(nullptr)
+                , _pid(0)
+                , _categories()
+                , _results()
+                , _next(0)
+                , _test()
+                , _args()
+                , _repeat(0)
+            {
+            }
+            ~Measurement()
+            {
+                ASSERT(_probe == nullptr);
+            }
+
+        public:
+            void Attach(Exchange::IMemory* probe, const uint32_t pid)
+            {
+                _probe = probe;
+                _pid = pid;
+            }
+            void Detach()
+            {
+                if (_probe != nullptr) {
+                    _probe->Release();
+                    _probe = nullptr;
+                }
+            }
+            uint32_t Run(Exchange::ITestController* controller, const MeasureParameters& params, MeasureResults& report);
+
+        private:
+            void Process();
+            void Measure(Exchange::ITestController::ICategory* category, Exchange::ITestController::ITest* test, std::list<MeasureResults::Entry>& results);
+            // Fills in all but the wall clock.
+            void Take(Sample& sample) const;
+            static void Statistics(std::vector<int64_t>& samples, MeasureStatistics& statistics);
+
+        private:
+            Core::CriticalSection _adminLock;
+            Exchange::IMemory* _probe;
+            uint32_t _pid;
+            std::vector<Exchange::ITestController::ICategory*> _categories;
+            std::vector<std::list<MeasureResults::Entry>> _results;
+            uint32_t _next;
+            string _test;
+            string _args;
+            uint16_t _repeat;
+        };
+
     public:
         TestController()
-            : _service(nullptr)
+            : _adminLock()
+            , _service(nullptr)
             , _notification(this)
             , _memory(nullptr)
             , _testControllerImp(nullptr)
             , _skipURL(0)
             , _connection(0)
             , _prevCategory(EMPTY_STRING)
+            , _measurement()
         {
             RegisterAll();
         }
@@ -154,10 +428,13 @@ namespace Plugin {
         void UnregisterAll();
         Core::JSON::ArrayType<JsonData::TestController::RunResultData> TestResults(const string& results);
         uint32_t endpoint_run(const JsonData::TestController::RunParamsData& params, Core::JSON::ArrayType<JsonData::TestController::RunResultData>& response);
+        uint32_t endpoint_measure(const MeasureParameters& params, MeasureResults& response);
         uint32_t get_categories(Core::JSON::ArrayType<Core::JSON::String>& response) const;
         uint32_t get_tests(const string& index, Core::JSON::ArrayType<Core::JSON::String>& response) const;
         uint32_t get_description(const string& index, JsonData::TestController::DescriptionData& response) const;
 
+        // Serializes the test runs and the measurements, they share the category Setup/TearDown.
+        Core::CriticalSection _adminLock;
         PluginHost::IShell* _service;
         Core::Sink<Notification> _notification;
         Exchange::IMemory* _memory;
@@ -165,6 +442,7 @@ namespace Plugin {
         uint8_t _skipURL;
         uint32_t _connection;
         string _prevCategory;
+        Measurement _measurement;
     };
 
 } // namespace Plugin
@@ -33,6 +33,7 @@ namespace Plugin {
     void TestController::RegisterAll()
     {
         Register<RunParamsData,Core::JSON::ArrayType<RunResultData>>(_T("run"), &TestController::endpoint_run, this);
+        Register<MeasureParameters,MeasureResults>(_T("measure"), &TestController::endpoint_measure, this);
         Property<Core::JSON::ArrayType<Core::JSON::String>>(_T("categories"), &TestController::get_categories, nullptr, this);
         Property<Core::JSON::ArrayType<Core::JSON::String>>(_T("tests"), &TestController::get_tests, nullptr, this);
         Property<DescriptionData>(_T("description"), &TestController::get_description, nullptr, this);
@@ -41,6 +42,7 @@ namespace Plugin {
     void TestController::UnregisterAll()
     {
         Unregister(_T("run"));
+        Unregister(_T("measure"));
         Unregister(_T("description"));
         Unregister(_T("tests"));
         Unregister(_T("categories"));
@@ -107,6 +109,40 @@ namespace Plugin {
         return result;
     }
 
+    // Method: measure - Run all tests, the tests of a category or a single test repeatedly
+    // and report the timing and memory statistics of the runs;
+    // Categories can be run in parallel - specify parallel;
+    // A measurement waits for a running test and the other way around;
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNAVAILABLE: Unknown category/test
+    //  - ERROR_BAD_REQUEST: Bad json param data format
+    uint32_t TestController::endpoint_measure(const MeasureParameters& params, MeasureResults& response)
+    {
+        uint32_t result = Core::ERROR_NONE;
+
+        if ((params.Test.IsSet() == true) && (params.Category.IsSet() != true)) {
+            result = Core::ERROR_BAD_REQUEST;
+        } else {
+            _adminLock.Lock();
+
+            // The measurement does the Setup/TearDown of the categories itself.
+            if (_prevCategory != EMPTY_STRING) {
+                Exchange::ITestController::ICategory* prevCategory = _testControllerImp->Category(_prevCategory);
+                if (prevCategory != nullptr) {
+                    prevCategory->TearDown();
+                }
+                _prevCategory = EMPTY_STRING;
+            }
+
+            result = _measurement.Run(_testControllerImp, params, response);
+
+            _adminLock.Unlock();
+        }
+
+        return result;
+    }
+
     // Property: categories - List of test categories
     // Return codes:
     //  - ERROR_NONE: Success
@@ -0,0 +1,114 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../CommandCore/TestCommandBase.h"
+#include "../CommandCore/TestCommandController.h"
+#include "PressureEngine.h"
+
+namespace WPEFramework {
+
+ENUM_CONVERSION_BEGIN(PressureEngine::pattern)
+
+    { PressureEngine::RAMP, _TXT("ramp") },
+    { PressureEngine::SAWTOOTH, _TXT("sawtooth") },
+    { PressureEngine::FRAGMENT, _TXT("fragment") },
+    { PressureEngine::CURVE, _TXT("curve") },
+
+ENUM_CONVERSION_END(PressureEngine::pattern)
+
+class MemoryPressure : public TestCommandBase {
+public:
+    MemoryPressure(const MemoryPressure&) = delete;
+    MemoryPressure& operator=(const MemoryPressure&) = delete;
+
+public:
+    MemoryPressure()
+        : TestCommandBase(TestCommandBase::DescriptionBuilder("Runs a scripted memory pressure scenario and samples the memory use at every step"),
+              TestCommandBase::SignatureBuilder("status", JsonData::TestUtility::TypeType::OBJECT, "scenario status and the samples taken since the previous call")
+                  .InputParameter("action", JsonData::TestUtility::TypeType::STRING, "start (default), stop or status")
+                  .InputParameter("pattern", JsonData::TestUtility::TypeType::STRING, "ramp, sawtooth, fragment or curve")
+                  .InputParameter("touch", JsonData::TestUtility::TypeType::BOOLEAN, "write the allocated pages, so they become resident")
+                  .InputParameter("step", JsonData::TestUtility::TypeType::NUMBER, "memory in kB per step")
+                  .InputParameter("interval", JsonData::TestUtility::TypeType::NUMBER, "time in ms between the steps")
+                  .InputParameter("limit", JsonData::TestUtility::TypeType::NUMBER, "peak memory in kB")
+                  .InputParameter("blocksize", JsonData::TestUtility::TypeType::NUMBER, "block size in bytes of the fragment pattern, at most a step")
+                  .InputParameter("curve", JsonData::TestUtility::TypeType::OBJECT, "resident memory in kB (size) over time in ms (time) to follow")
+                  .InputParameter("oomadjust", JsonData::TestUtility::TypeType::NUMBER, "oom_adj of the process during the scenario, restored on stop"))
+        , _engine(PressureEngine::Instance())
+    {
+        TestCore::TestCommandController::Instance().Announce(this);
+    }
+
+    virtual ~MemoryPressure()
+    {
+        _engine.Stop();
+
+        TestCore::TestCommandController::Instance().Revoke(this);
+    }
+
+public:
+    // ICommand methods
+    string Execute(const string& params) final
+    {
+        PressureEngine::Scenario input;
+        PressureEngine::Status status;
+        string response;
+
+        if (params.empty() == true) {
+            // Nothing to change, just report.
+        } else if (input.FromString(params) == false) {
+            status.Error = _T("Bad JSON param data format");
+        } else if (input.Action.Value() == _T("stop")) {
+            _engine.Stop();
+        } else if ((input.Action.IsSet() == false) || (input.Action.Value() == _T("start"))) {
+            const uint32_t result = _engine.Start(input);
+
+            if (result == Core::ERROR_INPROGRESS) {
+                status.Error = _T("A scenario is already running");
+            } else if (result != Core::ERROR_NONE) {
+                status.Error = _T("Invalid scenario");
+            }
+        } else if (input.Action.Value() != _T("status")) {
+            status.Error = _T("Unknown action");
+        }
+
+        _engine.Report(status);
+        status.ToString(response);
+
+        return response;
+    }
+
+    string Name() const final
+    {
+        return _name;
+    }
+
+private:
+    BEGIN_INTERFACE_MAP(MemoryPressure)
+    INTERFACE_ENTRY(Exchange::ITestUtility::ICommand)
+    END_INTERFACE_MAP
+
+private:
+    PressureEngine& _engine;
+    const string _name = _T("MemoryPressure");
+};
+
+static MemoryPressure* _singleton(Core::Service<MemoryPressure>::Create<MemoryPressure>());
+
+} // namespace WPEFramework
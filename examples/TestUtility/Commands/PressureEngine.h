@@ -0,0 +1,564 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../Module.h"
+
+#ifdef __LINUX__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace WPEFramework {
+
+// Drives the memory use of this process along a scripted pattern, one step per interval,
+// and samples the memory figures at every step. As the steps are taken at fixed points in
+// time, the reaction of the OOM killer and of the Monitor (restart limits) on a scenario
+// can be reproduced run after run.
+class PressureEngine {
+public:
+    enum pattern {
+        RAMP, // Grow by a step, up to the limit, and hold.
+        SAWTOOTH, // Grow by a step, up to the limit, release all and start over.
+        FRAGMENT, // Grow in small blocks up to the limit, release every other block and hold.
+        CURVE // Follow the resident memory given by the curve.
+    };
+
+    class Point : public Core::JSON::Container {
+    public:
+        Point()
+            : Core::JSON::Container()
+            , Time(0)
+            , Size(0)
+        {
+            Init();
+        }
+        Point(const Point& copy)
+            : Core::JSON::Container()
+            , Time(copy.Time)
+            , Size(copy.Size)
+        {
+            Init();
+        }
+        Point& operator=(const Point& rhs)
+        {
+            Time = rhs.Time;
+            Size = rhs.Size;
+
+            return (*this);
+        }
+        ~Point() = default;
+
+    private:
+        void Init()
+        {
+            Add(_T("time"), &Time);
+            Add(_T("size"), &Size);
+        }
+
+    public:
+        Core::JSON::DecUInt32 Time; // Since the start, in ms
+        Core::JSON::DecUInt32 Size; // Resident memory, in kB
+    };
+
+    class Scenario : public Core::JSON::Container {
+    public:
+        Scenario(const Scenario&) = delete;
+        Scenario& operator=(const Scenario&) = delete;
+
+        Scenario()
+            : Core::JSON::Container()
+            , Action()
+            , Pattern(RAMP)
+            , Touch(true)
+            , Step(1024)
+            , Interval(100)
+            , Limit(64 * 1024)
+            , BlockSize(256)
+            , Curve()
+            , OOMAdjust(0)
+        {
+            Add(_T("action"), &Action);
+            Add(_T("pattern"), &Pattern);
+            Add(_T("touch"), &Touch);
+            Add(_T("step"), &Step);
+            Add(_T("interval"), &Interval);
+            Add(_T("limit"), &Limit);
+            Add(_T("blocksize"), &BlockSize);
+            Add(_T("curve"), &Curve);
+            Add(_T("oomadjust"), &OOMAdjust);
+        }
+        ~Scenario() = default;
+
+    public:
+        Core::JSON::String Action; // start (default), stop or status
+        Core::JSON::EnumType<pattern> Pattern;
+        Core::JSON::Boolean Touch; // Write the pages, so they become resident
+        Core::JSON::DecUInt32 Step; // Memory per step, in kB
+        Core::JSON::DecUInt32 Interval; // Time between the steps, in ms
+        Core::JSON::DecUInt32 Limit; // Peak memory, in kB
+        Core::JSON::DecUInt32 BlockSize; // Size of the small blocks of the fragment pattern, in bytes
+        Core::JSON::ArrayType<Point> Curve;
+        Core::JSON::DecSInt8 OOMAdjust; // oom_adj for the run, if set
+    };
+
+    class Sample : public Core::JSON::Container {
+    public:
+        Sample()
+            : Core::JSON::Container()
+            , Time(0)
+            , Step(0)
+            , Allocated(0)
+            , Size(0)
+            , Resident(0)
+            , Free(0)
+            , OOMScore(0)
+        {
+            Init();
+        }
+        Sample(const Sample& copy)
+            : Core::JSON::Container()
+            , Time(copy.Time)
+            , Step(copy.Step)
+            , Allocated(copy.Allocated)
+            , Size(copy.Size)
+            , Resident(copy.Resident)
+            , Free(copy.Free)
+            , OOMScore(copy.OOMScore)
+        {
+            Init();
+        }
+        ~Sample() = default;
+
+    private:
+        void Init()
+        {
+            Add(_T("time"), &Time);
+            Add(_T("step"), &Step);
+            Add(_T("allocated"), &Allocated);
+            Add(_T("size"), &Size);
+            Add(_T("resident"), &Resident);
+            Add(_T("free"), &Free);
+            Add(_T("oomscore"), &OOMScore);
+        }
+
+    public:
+        Core::JSON::DecUInt64 Time; // Wall clock, in ms since the epoch, to line up with the Monitor
+        Core::JSON::DecUInt32 Step;
+        Core::JSON::DecUInt32 Allocated; // By the scenario, in kB
+        Core::JSON::DecUInt32 Size; // Of the process, in kB
+        Core::JSON::DecUInt32 Resident; // Of the process, in kB
+        Core::JSON::DecUInt32 Free; // In the system, in kB
+        Core::JSON::DecUInt16 OOMScore;
+    };
+
+    class Status : public Core::JSON::Container {
+    public:
+        Status(const Status&) = delete;
+        Status& operator=(const Status&) = delete;
+
+        Status()
+            : Core::JSON::Container()
+            , Running(false)
+            , Steps(0)
+            , Allocated(0)
+            , Failures(0)
+            , Samples()
+            , Error()
+        {
+            Add(_T("running"), &Running);
+            Add(_T("steps"), &Steps);
+            Add(_T("allocated"), &Allocated);
+            Add(_T("failures"), &Failures);
+            Add(_T("samples"), &Samples);
+            Add(_T("error"), &Error);
+        }
+        ~Status() = default;
+
+    public:
+        Core::JSON::Boolean Running;
+        Core::JSON::DecUInt32 Steps;
+        Core::JSON::DecUInt32 Allocated; // In kB
+        Core::JSON::DecUInt32 Failures; // Allocations that failed
+        Core::JSON::ArrayType<Sample> Samples; // Taken since the previous status
+        Core::JSON::String Error;
+    };
+
+private:
+    using Job = Core::WorkerPool::JobType<PressureEngine&>;
+
+    struct Block {
+        uint8_t* Address;
+        uint32_t Size; // In bytes
+    };
+
+    struct Measurement {
+        uint64_t Time;
+        uint32_t Step;
+        uint32_t Allocated;
+        uint32_t Size;
+        uint32_t Resident;
+        uint32_t Free;
+        uint16_t OOMScore;
+    };
+
+    // Oldest samples are dropped if nobody asks for them.
+    enum { MAX_SAMPLES = 1024 };
+
+    PressureEngine()
+        : _lock()
+        , _job(*this)
+        , _process()
+        , _running(false)
+        , _pattern(RAMP)
+        , _touch(true)
+        , _step(0)
+        , _interval(0)
+        , _limit(0)
+        , _blockSize(0)
+        , _oomAdjust(0)
+        , _oomAdjusted(false)
+        , _curve()
+        , _start(0)
+        , _steps(0)
+        , _allocated(0)
+        , _failures(0)
+        , _holding(false)
+        , _blocks()
+        , _samples()
+    {
+    }
+
+public:
+    PressureEngine(const PressureEngine&) = delete;
+    PressureEngine& operator=(const PressureEngine&) = delete;
+
+    static PressureEngine& Instance()
+    {
+        static PressureEngine _singleton;
+        return (_singleton);
+    }
+
+    ~PressureEngine()
+    {
+        ASSERT(_running == false);
+
+        Release(~0);
+    }
+
+public:
+    uint32_t Start(const Scenario& scenario)
+    {
+        uint32_t result = Core::ERROR_NONE;
+
+        // The blocks a step is allocated in (the step itself, except for the fragment pattern)
+        // must fit in a step, and for the patterns that grow up to the limit, in the limit.
+        // Otherwise the scenario would run without ever allocating anything.
+        const uint64_t step = static_cast<uint64_t>(scenario.Step.Value()) << 10;
+        const uint64_t block = (scenario.Pattern.Value() == FRAGMENT ? scenario.BlockSize.Value() : step);
+
+        if ((scenario.Step.Value() == 0) || (scenario.Interval.Value() == 0) || (scenario.BlockSize.Value() == 0)
+            || ((scenario.Pattern.Value() == CURVE) && (scenario.Curve.Length() == 0))
+            || (block > step) || (block > static_cast<uint32_t>(~0))
+            || ((scenario.Pattern.Value() != CURVE) && (block > (static_cast<uint64_t>(scenario.Limit.Value()) << 10)))) {
+            result = Core::ERROR_BAD_REQUEST;
+        } else {
+            _lock.Lock();
+
+            if (_running == true) {
+                result = Core::ERROR_INPROGRESS;
+            } else {
+                Release(~0);
+
+                _pattern = scenario.Pattern.Value();
+                _touch = ((scenario.Touch.Value() == true) || (_pattern == CURVE));
+                _step = scenario.Step.Value();
+                _interval = scenario.Interval.Value();
+                _limit = scenario.Limit.Value();
+                _blockSize = scenario.BlockSize.Value();
+                _curve.clear();
+
+                Core::JSON::ArrayType<Point>::ConstIterator index(scenario.Curve.Elements());
+                while (index.Next() == true) {
+                    _curve.emplace_back(index.Current().Time.Value(), index.Current().Size.Value());
+                }
+                std::sort(_curve.begin(), _curve.end());
+
+                if (scenario.OOMAdjust.IsSet() == true) {
+                    // Remember what it was, Stop puts it back.
+                    if (_oomAdjusted == false) {
+                        _oomAdjust = _process.OOMAdjust();
+                        _oomAdjusted = true;
+                    }
+                    _process.OOMAdjust(scenario.OOMAdjust.Value());
+                }
+
+                _steps = 0;
+                _failures = 0;
+                _holding = false;
+                _samples.clear();
+                _start = Core::Time::Now().Ticks();
+                _running = true;
+
+                _job.Submit();
+            }
+
+            _lock.Unlock();
+        }
+
+        return (result);
+    }
+    void Stop()
+    {
+        _lock.Lock();
+        _running = false;
+        _lock.Unlock();
+
+        _job.Revoke();
+
+        _lock.Lock();
+        Release(~0);
+
+        if (_oomAdjusted == true) {
+            _process.OOMAdjust(_oomAdjust);
+            _oomAdjusted = false;
+        }
+        _lock.Unlock();
+    }
+    void Report(Status& status)
+    {
+        _lock.Lock();
+
+        status.Running = _running;
+        status.Steps = _steps;
+        status.Allocated = static_cast<uint32_t>(_allocated >> 10);
+        status.Failures = _failures;
+
+        for (const Measurement& entry : _samples) {
+            Sample& sample(status.Samples.Add());
+
+            sample.Time = entry.Time;
+            sample.Step = entry.Step;
+            sample.Allocated = entry.Allocated;
+            sample.Size = entry.Size;
+            sample.Resident = entry.Resident;
+            sample.Free = entry.Free;
+            sample.OOMScore = entry.OOMScore;
+        }
+        _samples.clear();
+
+        _lock.Unlock();
+    }
+
+private:
+    friend class Core::ThreadPool::JobType<PressureEngine&>;
+
+    void Dispatch()
+    {
+        _lock.Lock();
+
+        if (_running == true) {
+            Advance();
+            Measure();
+
+            _steps++;
+
+            // Keep to the pace set at the start, a slow step does not delay the ones after it.
+            _job.Schedule(Core::Time(_start).Add(_steps * _interval));
+        }
+
+        _lock.Unlock();
+    }
+
+    // Expects the _lock to be taken.
+    void Advance()
+    {
+        const uint64_t step = static_cast<uint64_t>(_step) << 10;
+        const uint64_t limit = static_cast<uint64_t>(_limit) << 10;
+
+        switch (_pattern) {
+        case RAMP:
+            if ((_allocated + step) <= limit) {
+                Allocate(step, static_cast<uint32_t>(step));
+            }
+            break;
+        case SAWTOOTH:
+            if ((_allocated + step) <= limit) {
+                Allocate(step, static_cast<uint32_t>(step));
+            } else {
+                Release(~0);
+            }
+            break;
+        case FRAGMENT:
+            if (_holding == false) {
+                if ((_allocated + step) <= limit) {
+                    Allocate(step, _blockSize);
+                } else {
+                    // Punch holes all over the heap: the allocated memory halves, the
+                    // resident memory hardly changes.
+                    std::vector<Block> kept;
+                    kept.reserve((_blocks.size() + 1) / 2);
+
+                    for (uint32_t index = 0; index < _blocks.size(); index++) {
+                        if ((index & 1) == 0) {
+                            kept.push_back(_blocks[index]);
+                        } else {
+                            _allocated -= _blocks[index].Size;
+                            ::free(_blocks[index].Address);
+                        }
+                    }
+                    _blocks.swap(kept);
+                    _holding = true;
+                }
+            }
+            break;
+        case CURVE: {
+            const uint64_t target = static_cast<uint64_t>(Target(static_cast<uint32_t>((Core::Time::Now().Ticks() - _start) / Core::Time::TicksPerMillisecond))) << 10;
+            const uint64_t resident = _process.Resident();
+
+            if (target > resident) {
+                // Whole steps only, so the process does not keep chasing a few pages.
+                Allocate(((target - resident) / step) * step, static_cast<uint32_t>(step));
+            } else if ((resident - target) >= step) {
+                Release(resident - target);
+            }
+            break;
+        }
+        }
+    }
+    // The resident memory (in kB) the curve gives for this moment, interpolated between
+    // its points. The last point holds after the end of the curve.
+    uint32_t Target(const uint32_t elapsed) const
+    {
+        uint32_t result = _curve.back().second;
+
+        if (elapsed <= _curve.front().first) {
+            result = _curve.front().second;
+        } else {
+            for (uint32_t index = 1; index < _curve.size(); index++) {
+                if (elapsed < _curve[index].first) {
+                    const std::pair<uint32_t, uint32_t>& from(_curve[index - 1]);
+                    const std::pair<uint32_t, uint32_t>& to(_curve[index]);
+                    const int64_t delta = static_cast<int64_t>(to.second) - static_cast<int64_t>(from.second);
+
+                    result = static_cast<uint32_t>(from.second + ((delta * (elapsed - from.first)) / (to.first - from.first)));
+                    break;
+                }
+            }
+        }
+
+        return (result);
+    }
+    // Expects the _lock to be taken.
+    void Allocate(const uint64_t amount, const uint32_t blockSize)
+    {
+        static const uint32_t pageSize = getpagesize();
+
+        for (uint64_t total = 0; (total + blockSize) <= amount; total += blockSize) {
+            uint8_t* block = static_cast<uint8_t*>(::malloc(blockSize));
+
+            if (block == nullptr) {
+                _failures++;
+                break;
+            }
+
+            if (_touch == true) {
+                for (uint32_t index = 0; index < blockSize; index += pageSize) {
+                    block[index] = static_cast<uint8_t>(index | 1);
+                }
+            }
+
+            _blocks.push_back({ block, blockSize });
+            _allocated += blockSize;
+        }
+    }
+    // Last in, first out. Expects the _lock to be taken.
+    void Release(const uint64_t amount)
+    {
+        uint64_t released = 0;
+
+        while ((_blocks.empty() == false) && (released < amount)) {
+            released += _blocks.back().Size;
+            ::free(_blocks.back().Address);
+            _blocks.pop_back();
+        }
+
+        _allocated -= std::min(released, _allocated);
+    }
+    // Expects the _lock to be taken.
+    void Measure()
+    {
+        if (_samples.size() >= MAX_SAMPLES) {
+            _samples.pop_front();
+        }
+
+        _samples.push_back({ Core::Time::Now().Ticks() / Core::Time::TicksPerMillisecond,
+            _steps,
+            static_cast<uint32_t>(_allocated >> 10),
+            static_cast<uint32_t>(_process.Allocated() >> 10),
+            static_cast<uint32_t>(_process.Resident() >> 10),
+            static_cast<uint32_t>(Core::SystemInfo::Instance().GetFreeRam() >> 10),
+            OOMScore() });
+    }
+    static uint16_t OOMScore()
+    {
+        uint16_t result = 0;
+
+#ifdef __LINUX__
+        char buffer[16];
+
+        int fd = ::open("/proc/self/oom_score", O_RDONLY | O_CLOEXEC);
+        if (fd >= 0) {
+            ssize_t size = ::read(fd, buffer, sizeof(buffer) - 1);
+            ::close(fd);
+
+            if (size > 0) {
+                buffer[size] = '\0';
+                result = static_cast<uint16_t>(::atoi(buffer));
+            }
+        }
+#endif
+
+        return (result);
+    }
+
+private:
+    Core::CriticalSection _lock;
+    Job _job;
+    Core::ProcessInfo _process;
+    bool _running;
+    pattern _pattern;
+    bool _touch;
+    uint32_t _step;
+    uint32_t _interval;
+    uint32_t _limit;
+    uint32_t _blockSize;
+    int8_t _oomAdjust; // What it was before the first run that changed it
+    bool _oomAdjusted;
+    std::vector<std::pair<uint32_t, uint32_t>> _curve;
+    uint64_t _start;
+    uint32_t _steps;
+    uint64_t _allocated; // In bytes
+    uint32_t _failures;
+    bool _holding;
+    std::vector<Block> _blocks;
+    std::list<Measurement> _samples;
+};
+} // namespace WPEFramework
@@ -0,0 +1,220 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// Include the Module.h of the plugin before this file.
+#include <interfaces/IMemory.h>
+
+#ifdef __LINUX__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Exchange::IMemory for an (out of process) plugin. The Monitor asks for all figures
+    // in one go, so all of them are taken from a single snapshot of the process (tree),
+    // which is kept for a short window, instead of walking /proc for every question.
+    class MemoryObserverImpl : public Exchange::IMemory {
+    public:
+        struct Snapshot {
+            uint64_t Resident;
+            uint64_t Allocated;
+            uint64_t Shared;
+            uint64_t Proportional; // PSS, 0 if the kernel does not offer smaps_rollup
+            uint64_t Unique; // USS, 0 if the kernel does not offer smaps_rollup
+            uint8_t Processes;
+            bool Active;
+        };
+
+        enum { DEFAULT_WINDOW = 1000 }; /* in milliseconds */
+
+    public:
+        MemoryObserverImpl() = delete;
+        MemoryObserverImpl(const MemoryObserverImpl&) = delete;
+        MemoryObserverImpl& operator=(const MemoryObserverImpl&) = delete;
+
+        MemoryObserverImpl(const uint32_t pid, const bool children = false, const uint32_t window = DEFAULT_WINDOW)
+            : _adminLock()
+            , _main(pid == 0 ? Core::ProcessInfo().Id() : pid)
+            , _children(children)
+            , _window(window * Core::Time::TicksPerMillisecond)
+            , _taken(0)
+            , _snapshot()
+        {
+        }
+        ~MemoryObserverImpl() override
+        {
+        }
+
+    public:
+        uint64_t Resident() const override
+        {
+            return (Current().Resident);
+        }
+        uint64_t Allocated() const override
+        {
+            return (Current().Allocated);
+        }
+        uint64_t Shared() const override
+        {
+            return (Current().Shared);
+        }
+        uint8_t Processes() const override
+        {
+            const Snapshot snapshot(Current());
+            return ((snapshot.Active == true ? 1 : 0) + snapshot.Processes);
+        }
+        const bool IsOperational() const override
+        {
+            return (Current().Active);
+        }
+
+        // Not part of IMemory, but available for in-process reporting.
+        uint64_t Proportional() const
+        {
+            return (Current().Proportional);
+        }
+        uint64_t Unique() const
+        {
+            return (Current().Unique);
+        }
+        uint32_t Id() const
+        {
+            return (_main.Id());
+        }
+
+        Snapshot Current() const
+        {
+            _adminLock.Lock();
+
+            const uint64_t now = Core::Time::Now().Ticks();
+
+            if ((_taken == 0) || ((now - _taken) >= _window)) {
+                Refresh(_snapshot);
+                _taken = now;
+            }
+
+            const Snapshot result(_snapshot);
+
+            _adminLock.Unlock();
+
+            return (result);
+        }
+
+        BEGIN_INTERFACE_MAP(MemoryObserverImpl)
+        INTERFACE_ENTRY(Exchange::IMemory)
+        END_INTERFACE_MAP
+
+    private:
+        void Refresh(Snapshot& snapshot) const
+        {
+            snapshot = Snapshot();
+            snapshot.Active = Account(_main, snapshot);
+
+            if (_children == true) {
+                Core::ProcessInfo::Iterator children(_main.Id());
+
+                while (children.Next() == true) {
+                    if (Account(children.Current(), snapshot) == true) {
+                        snapshot.Processes++;
+                    }
+                }
+            }
+        }
+
+#ifdef __LINUX__
+        static uint16_t Read(const uint32_t pid, const TCHAR name[], char buffer[], const uint16_t length)
+        {
+            char path[64];
+            ssize_t size = -1;
+
+            ::snprintf(path, sizeof(path), "/proc/%u/%s", pid, name);
+
+            int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+            if (fd >= 0) {
+                size = ::read(fd, buffer, length - 1);
+                ::close(fd);
+            }
+
+            size = (size < 0 ? 0 : size);
+            buffer[size] = '\0';
+
+            return (static_cast<uint16_t>(size));
+        }
+        static uint64_t Field(const char buffer[], const char name[])
+        {
+            const char* entry = ::strstr(buffer, name);
+            return (entry == nullptr ? 0 : ::strtoull(entry + ::strlen(name), nullptr, 10));
+        }
+        static bool Account(const Core::ProcessInfo& process, Snapshot& snapshot)
+        {
+            static const uint64_t pageSize = ::sysconf(_SC_PAGESIZE);
+
+            char buffer[1024];
+            bool result = false;
+
+            // statm gives allocated, resident and shared in one read, in pages.
+            if (Read(process.Id(), _T("statm"), buffer, sizeof(buffer)) > 0) {
+                unsigned long long allocated = 0, resident = 0, shared = 0;
+
+                if (::sscanf(buffer, "%llu %llu %llu", &allocated, &resident, &shared) == 3) {
+                    snapshot.Allocated += allocated * pageSize;
+                    snapshot.Resident += resident * pageSize;
+                    snapshot.Shared += shared * pageSize;
+                    result = true;
+                }
+
+                // The rollup is one summary for all mappings, in kB.
+                if ((result == true) && (Read(process.Id(), _T("smaps_rollup"), buffer, sizeof(buffer)) > 0)) {
+                    snapshot.Proportional += Field(buffer, "\nPss:") * 1024;
+                    snapshot.Unique += (Field(buffer, "\nPrivate_Clean:") + Field(buffer, "\nPrivate_Dirty:")) * 1024;
+                }
+            }
+
+            return (result);
+        }
+#else
+        static bool Account(const Core::ProcessInfo& process, Snapshot& snapshot)
+        {
+            bool result = process.IsActive();
+
+            if (result == true) {
+                snapshot.Allocated += process.Allocated();
+                snapshot.Resident += process.Resident();
+                snapshot.Shared += process.Shared();
+            }
+
+            return (result);
+        }
+#endif
+
+    private:
+        mutable Core::CriticalSection _adminLock;
+        Core::ProcessInfo _main;
+        const bool _children;
+        const uint64_t _window;
+        mutable uint64_t _taken;
+        mutable Snapshot _snapshot;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,532 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// Include the Module.h of the plugin before this file.
+#include "MemoryObserver.h"
+
+#include <atomic>
+#include <memory>
+
+#ifdef __LINUX__
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Watches the memory pressure of the system and asks a runtime to trim its caches, before
+    // the Monitor has to restart it. The pressure comes from the kernel PSI (pressure stall
+    // information). For /proc/pressure/memory a trigger is armed, so the thread only wakes up
+    // on a stall. Any other source is taken as a stand-in file with the same content, e.g.
+    //   some avg10=12.00 avg60=0.00 avg300=0.00 total=0
+    //   full avg10=0.00 avg60=0.00 avg300=0.00 total=0
+    // which is read every window, to drive the trimming by hand.
+    //
+    // What was reclaimed (the change of the resident memory) is counted per level, in a small file
+    // in the volatile path, so the (in process) plugin can report it. Out of process, that is the
+    // memory of the process tree of the runtime. In process, the tree is the whole framework, so
+    // only the own process is measured there.
+    class MemoryPressureObserver : public Core::Thread {
+    public:
+        enum level : uint8_t {
+            NONE,
+            MODERATE, // Collect the JS heap
+            HIGH, // ... drop the decoded images and resources, give the free heap back
+            CRITICAL, // ... drop everything that can be reloaded, e.g. fonts
+            LEVELS
+        };
+
+        struct ITrimmer {
+            virtual ~ITrimmer() = default;
+
+            // Called from the observer thread, higher levels include the lower ones.
+            virtual void Trim(const level which) = 0;
+        };
+
+        // Which level a pressure reading is at and whether a level is due for a trim. Every level
+        // has its own cooldown, so a rising pressure is acted upon right away, while a trim also
+        // covers (and so cools down) the levels below it.
+        class Policy {
+        public:
+            Policy(const Policy&) = delete;
+            Policy& operator=(const Policy&) = delete;
+
+            Policy()
+                : _cooldown(0)
+            {
+                for (uint8_t index = 0; index < LEVELS; index++) {
+                    _next[index] = 0;
+                    _thresholds[index] = 0;
+                }
+            }
+            ~Policy()
+            {
+            }
+
+        public:
+            // Thresholds in percent (0 disables the level), the cooldown in ticks.
+            void Configure(const uint8_t moderate, const uint8_t high, const uint8_t critical, const uint64_t cooldown)
+            {
+                _thresholds[MODERATE] = moderate;
+                _thresholds[HIGH] = high;
+                _thresholds[CRITICAL] = critical;
+                _cooldown = cooldown;
+
+                for (uint8_t index = 0; index < LEVELS; index++) {
+                    _next[index] = 0;
+                }
+            }
+            // The level of the content of a PSI file, critical on the "full" stall, the
+            // others on the "some" stall.
+            level Evaluate(const char buffer[]) const
+            {
+                level result = NONE;
+
+                const float some = Average(buffer, "some avg10=");
+                const float full = Average(buffer, "full avg10=");
+
+                if ((_thresholds[CRITICAL] != 0) && (full >= _thresholds[CRITICAL])) {
+                    result = CRITICAL;
+                } else if ((_thresholds[HIGH] != 0) && (some >= _thresholds[HIGH])) {
+                    result = HIGH;
+                } else if ((_thresholds[MODERATE] != 0) && (some >= _thresholds[MODERATE])) {
+                    result = MODERATE;
+                }
+
+                return (result);
+            }
+            bool IsDue(const level which, const uint64_t now) const
+            {
+                return ((which != NONE) && (which < LEVELS) && (now >= _next[which]));
+            }
+            // A trim at the given level was done, at the given time.
+            void Trimmed(const level which, const uint64_t now)
+            {
+                ASSERT((which != NONE) && (which < LEVELS));
+
+                for (uint8_t index = MODERATE; index <= which; index++) {
+                    _next[index] = now + _cooldown;
+                }
+            }
+
+        private:
+            static float Average(const char buffer[], const char name[])
+            {
+                const char* entry = ::strstr(buffer, name);
+                return (entry == nullptr ? 0 : ::strtof(entry + ::strlen(name), nullptr));
+            }
+
+        private:
+            uint64_t _cooldown;
+            uint64_t _next[LEVELS];
+            uint8_t _thresholds[LEVELS];
+        };
+
+        class Config : public Core::JSON::Container {
+        private:
+            Config(const Config&) = delete;
+            Config& operator=(const Config&) = delete;
+
+        public:
+            Config()
+                : Core::JSON::Container()
+                , Enabled(false)
+                , Source(_T("/proc/pressure/memory"))
+                , Stall(100)
+                , Window(1000)
+                , Moderate(10)
+                , High(25)
+                , Critical(10)
+                , Settle(500)
+                , Cooldown(10000)
+            {
+                Add(_T("enabled"), &Enabled);
+                Add(_T("source"), &Source);
+                Add(_T("stall"), &Stall);
+                Add(_T("window"), &Window);
+                Add(_T("moderate"), &Moderate);
+                Add(_T("high"), &High);
+                Add(_T("critical"), &Critical);
+                Add(_T("settle"), &Settle);
+                Add(_T("cooldown"), &Cooldown);
+            }
+            ~Config()
+            {
+            }
+
+        public:
+            Core::JSON::Boolean Enabled;
+            Core::JSON::String Source; // PSI file, or a stand-in with the same content
+            Core::JSON::DecUInt16 Stall; // Stall in ms within the window that fires the trigger
+            Core::JSON::DecUInt16 Window; // In ms, between 500 and 10000
+            Core::JSON::DecUInt8 Moderate; // "some" avg10 percentage
+            Core::JSON::DecUInt8 High; // "some" avg10 percentage
+            Core::JSON::DecUInt8 Critical; // "full" avg10 percentage
+            Core::JSON::DecUInt16 Settle; // Time in ms the runtime gets to trim, before measuring
+            Core::JSON::DecUInt16 Cooldown; // Time in ms before trimming at the same level again
+        };
+
+        class Statistics : public Core::JSON::Container {
+        public:
+            class Counter : public Core::JSON::Container {
+            private:
+                Counter(const Counter&) = delete;
+                Counter& operator=(const Counter&) = delete;
+
+            public:
+                Counter()
+                    : Core::JSON::Container()
+                    , Trims()
+                    , Reclaimed()
+                {
+                    Add(_T("trims"), &Trims);
+                    Add(_T("reclaimed"), &Reclaimed);
+                }
+                ~Counter()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt32 Trims;
+                Core::JSON::DecUInt64 Reclaimed; // In kB
+            };
+
+        private:
+            Statistics(const Statistics&) = delete;
+            Statistics& operator=(const Statistics&) = delete;
+
+        public:
+            Statistics()
+                : Core::JSON::Container()
+                , Level()
+                , Moderate()
+                , High()
+                , Critical()
+            {
+                Add(_T("level"), &Level);
+                Add(_T("moderate"), &Moderate);
+                Add(_T("high"), &High);
+                Add(_T("critical"), &Critical);
+            }
+            ~Statistics()
+            {
+            }
+
+        public:
+            Core::JSON::String Level;
+            Counter Moderate;
+            Counter High;
+            Counter Critical;
+        };
+
+    private:
+        struct Block {
+            std::atomic<uint32_t> Sequence; // Odd while being written
+            uint8_t Level;
+            uint32_t Trims[LEVELS];
+            uint64_t Reclaimed[LEVELS]; // In bytes
+        };
+
+    public:
+        MemoryPressureObserver() = delete;
+        MemoryPressureObserver(const MemoryPressureObserver&) = delete;
+        MemoryPressureObserver& operator=(const MemoryPressureObserver&) = delete;
+
+        MemoryPressureObserver(ITrimmer& trimmer)
+            : Core::Thread(Core::Thread::DefaultStackSize(), _T("MemoryPressure"))
+            , _trimmer(trimmer)
+            , _memory(0, (HostMark() == false), 0)
+            , _file()
+            , _block(nullptr)
+            , _source()
+            , _trigger(-1)
+            , _level(NONE)
+            , _policy()
+            , _window(0)
+            , _settle(0)
+        {
+        }
+        ~MemoryPressureObserver() override
+        {
+            Close();
+        }
+
+        // The plugin side always runs in the framework host, it marks that process before it
+        // creates the runtime. A runtime that finds the mark runs in process.
+        static void Host()
+        {
+            HostMark() = true;
+        }
+        static string FileName(const PluginHost::IShell* service)
+        {
+            return (service->VolatilePath() + service->Callsign() + _T(".pressure"));
+        }
+        static const TCHAR* Name(const level which)
+        {
+            static const TCHAR* const names[] = { _T("none"), _T("moderate"), _T("high"), _T("critical") };
+            return (which < LEVELS ? names[which] : _T("unknown"));
+        }
+
+        // Reads the counters published for the given service, from any process.
+        static bool Load(const string& fileName, Statistics& statistics)
+        {
+            bool result = false;
+            Core::DataElementFile file(fileName, Core::File::USER_READ | Core::File::SHAREABLE, 0);
+
+            if ((file.IsValid() == true) && (file.Size() >= sizeof(Block))) {
+                const Block* block = reinterpret_cast<const Block*>(file.Buffer());
+                uint8_t attempts = 8;
+                Block copy;
+
+                do {
+                    const uint32_t sequence = block->Sequence.load(std::memory_order_acquire);
+
+                    copy.Level = block->Level;
+                    ::memcpy(copy.Trims, block->Trims, sizeof(copy.Trims));
+                    ::memcpy(copy.Reclaimed, block->Reclaimed, sizeof(copy.Reclaimed));
+
+                    std::atomic_thread_fence(std::memory_order_acquire);
+
+                    result = (((sequence & 1) == 0) && (sequence == block->Sequence.load(std::memory_order_relaxed)));
+
+                } while ((result == false) && (--attempts != 0));
+
+                if (result == true) {
+                    statistics.Level = Name(static_cast<level>(copy.Level));
+                    statistics.Moderate.Trims = copy.Trims[MODERATE];
+                    statistics.Moderate.Reclaimed = copy.Reclaimed[MODERATE] / 1024;
+                    statistics.High.Trims = copy.Trims[HIGH];
+                    statistics.High.Reclaimed = copy.Reclaimed[HIGH] / 1024;
+                    statistics.Critical.Trims = copy.Trims[CRITICAL];
+                    statistics.Critical.Reclaimed = copy.Reclaimed[CRITICAL] / 1024;
+                }
+            }
+
+            return (result);
+        }
+        // The plugin information of a runtime that observes the memory pressure, empty otherwise.
+        static string Report(const PluginHost::IShell* service)
+        {
+            string result;
+            Statistics statistics;
+
+            if ((service != nullptr) && (Load(FileName(service), statistics) == true)) {
+                statistics.ToString(result);
+            }
+
+            return (result);
+        }
+
+    public:
+        uint32_t Open(const Config& config, const string& fileName)
+        {
+            uint32_t result = Core::ERROR_ILLEGAL_STATE;
+
+            if (_block == nullptr) {
+                _source = config.Source.Value();
+                _window = std::min(std::max(config.Window.Value(), static_cast<uint16_t>(500)), static_cast<uint16_t>(10000));
+                _settle = config.Settle.Value();
+                _policy.Configure(config.Moderate.Value(), config.High.Value(), config.Critical.Value(),
+                    static_cast<uint64_t>(config.Cooldown.Value()) * Core::Time::TicksPerMillisecond);
+
+                result = Core::ERROR_UNAVAILABLE;
+
+                if (Core::File(_source).Exists() == true) {
+                    _file.reset(new Core::DataElementFile(fileName, Core::File::USER_READ | Core::File::USER_WRITE | Core::File::SHAREABLE, sizeof(Block)));
+
+                    if ((_file->IsValid() == true) && (_file->Size() >= sizeof(Block))) {
+                        _block = reinterpret_cast<Block*>(_file->Buffer());
+                        ::memset(static_cast<void*>(_block), 0, sizeof(Block));
+
+                        Arm(config.Stall.Value());
+
+                        result = Core::ERROR_NONE;
+
+                        Run();
+                    } else {
+                        _file.reset();
+                    }
+                }
+            }
+
+            return (result);
+        }
+        void Close()
+        {
+            Stop();
+            Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+
+#ifdef __LINUX__
+            if (_trigger != -1) {
+                ::close(_trigger);
+                _trigger = -1;
+            }
+#endif
+            _block = nullptr;
+            _file.reset();
+        }
+
+    private:
+        static bool& HostMark()
+        {
+            static bool mark = false;
+            return (mark);
+        }
+        void Arm(const uint16_t stall)
+        {
+#ifdef __LINUX__
+            static constexpr TCHAR psiPrefix[] = _T("/proc/pressure/");
+
+            // Never write into a stand-in, that is just read every window.
+            if (_source.compare(0, sizeof(psiPrefix) - 1, psiPrefix) == 0) {
+                _trigger = ::open(_source.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+
+                if (_trigger != -1) {
+                    char trigger[64];
+                    const int length = ::snprintf(trigger, sizeof(trigger), "some %u %u", stall * 1000, _window * 1000);
+
+                    if (::write(_trigger, trigger, length + 1) < 0) {
+                        SYSLOG(Logging::Notification, (_T("Could not arm a trigger on %s, polling it instead"), _source.c_str()));
+                        ::close(_trigger);
+                        _trigger = -1;
+                    }
+                }
+            }
+#else
+            DEBUG_VARIABLE(stall);
+#endif
+        }
+        uint32_t Worker() override
+        {
+#ifdef __LINUX__
+            if (_trigger != -1) {
+                // Also wake up every window without stalls, so the level can come down again.
+                struct pollfd descriptor = { _trigger, POLLPRI, 0 };
+
+                const int result = ::poll(&descriptor, 1, _window);
+
+                if (((result < 0) && (errno != EINTR)) || ((result > 0) && ((descriptor.revents & (POLLERR | POLLNVAL)) != 0))) {
+                    // The trigger is gone (e.g. the cgroup was removed), poll would return right
+                    // away from now on, so fall back to reading the source every window.
+                    SYSLOG(Logging::Notification, (_T("Lost the trigger on %s, polling it instead"), _source.c_str()));
+                    ::close(_trigger);
+                    _trigger = -1;
+                }
+            }
+#endif
+            if (IsRunning() == true) {
+                const level current = Evaluate();
+
+                if (_policy.IsDue(current, Core::Time::Now().Ticks()) == true) {
+                    Trim(current);
+
+                    // The cooldown starts once the runtime had its time to trim.
+                    _policy.Trimmed(current, Core::Time::Now().Ticks());
+                }
+
+                if (current != _level) {
+                    _level = current;
+                    Publish(current, NONE, 0);
+                }
+            }
+
+            return (_trigger != -1 ? 0 : _window);
+        }
+        level Evaluate() const
+        {
+            char buffer[256];
+            level result = NONE;
+            ssize_t size = -1;
+
+#ifdef __LINUX__
+            int fd = ::open(_source.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd >= 0) {
+                size = ::read(fd, buffer, sizeof(buffer) - 1);
+                ::close(fd);
+            }
+#endif
+            if (size > 0) {
+                buffer[size] = '\0';
+                result = _policy.Evaluate(buffer);
+            }
+
+            return (result);
+        }
+        void Trim(const level which)
+        {
+            const uint64_t before = _memory.Current().Resident;
+
+            _trimmer.Trim(which);
+
+#ifdef __GLIBC__
+            if (which >= HIGH) {
+                ::malloc_trim(0);
+            }
+#endif
+
+            // Most runtimes trim on their own thread, give them some time.
+            if (_settle != 0) {
+                ::SleepMs(_settle);
+            }
+
+            const uint64_t after = _memory.Current().Resident;
+            const uint64_t reclaimed = (before > after ? before - after : 0);
+
+            Publish(which, which, reclaimed);
+
+            SYSLOG(Logging::Notification, (_T("Memory pressure %s, trimmed %u kB"), Name(which), static_cast<uint32_t>(reclaimed / 1024)));
+        }
+        void Publish(const level current, const level trimmed, const uint64_t reclaimed)
+        {
+            ASSERT(_block != nullptr);
+
+            _block->Sequence.fetch_add(1, std::memory_order_acq_rel);
+
+            _block->Level = current;
+            if (trimmed != NONE) {
+                _block->Trims[trimmed]++;
+                _block->Reclaimed[trimmed] += reclaimed;
+            }
+
+            _block->Sequence.fetch_add(1, std::memory_order_acq_rel);
+        }
+
+    private:
+        ITrimmer& _trimmer;
+        Core::Sink<MemoryObserverImpl> _memory;
+        std::unique_ptr<Core::DataElementFile> _file;
+        Block* _block;
+        string _source;
+        int _trigger;
+        level _level;
+        Policy _policy;
+        uint16_t _window;
+        uint16_t _settle;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,222 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <plugins/plugins.h>
+
+#include "../MemoryPressure.h"
+#include "Test.h"
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace WPEFramework;
+
+namespace {
+
+    using Observer = Plugin::MemoryPressureObserver;
+
+    const char None[] = "some avg10=0.00 avg60=0.00 avg300=0.00 total=0\nfull avg10=0.00 avg60=0.00 avg300=0.00 total=0\n";
+    const char Moderate[] = "some avg10=12.00 avg60=3.10 avg300=0.50 total=1234\nfull avg10=2.00 avg60=0.00 avg300=0.00 total=10\n";
+    const char High[] = "some avg10=30.50 avg60=3.10 avg300=0.50 total=1234\nfull avg10=9.99 avg60=0.00 avg300=0.00 total=10\n";
+    const char Critical[] = "some avg10=30.50 avg60=3.10 avg300=0.50 total=1234\nfull avg10=10.00 avg60=0.00 avg300=0.00 total=10\n";
+
+    void Levels()
+    {
+        Observer::Policy policy;
+        policy.Configure(10, 25, 10, 0);
+
+        CHECK(policy.Evaluate(None) == Observer::NONE);
+        CHECK(policy.Evaluate(Moderate) == Observer::MODERATE);
+        CHECK(policy.Evaluate(High) == Observer::HIGH);
+        CHECK(policy.Evaluate(Critical) == Observer::CRITICAL);
+
+        // On the threshold counts.
+        CHECK(policy.Evaluate("some avg10=10.00 avg60=0.00 avg300=0.00 total=0\n") == Observer::MODERATE);
+        CHECK(policy.Evaluate("some avg10=9.99 avg60=0.00 avg300=0.00 total=0\n") == Observer::NONE);
+
+        // Critical only looks at the full stall, older kernels do not report it.
+        CHECK(policy.Evaluate("full avg10=50.00 avg60=0.00 avg300=0.00 total=0\n") == Observer::CRITICAL);
+        CHECK(policy.Evaluate("some avg10=99.00 avg60=0.00 avg300=0.00 total=0\n") == Observer::HIGH);
+
+        // Not a PSI file.
+        CHECK(policy.Evaluate("") == Observer::NONE);
+        CHECK(policy.Evaluate("some garbage\n") == Observer::NONE);
+
+        // A threshold of 0 disables the level, the lower ones still apply.
+        policy.Configure(10, 0, 0, 0);
+        CHECK(policy.Evaluate(High) == Observer::MODERATE);
+        CHECK(policy.Evaluate(Critical) == Observer::MODERATE);
+
+        policy.Configure(0, 0, 0, 0);
+        CHECK(policy.Evaluate(Critical) == Observer::NONE);
+    }
+
+    void Cooldown()
+    {
+        static constexpr uint64_t Period = 1000;
+
+        Observer::Policy policy;
+        policy.Configure(10, 25, 10, Period);
+
+        // There is never anything to do without pressure.
+        CHECK(policy.IsDue(Observer::NONE, 0) == false);
+
+        CHECK(policy.IsDue(Observer::MODERATE, 0) == true);
+        policy.Trimmed(Observer::MODERATE, 0);
+        CHECK(policy.IsDue(Observer::MODERATE, 1) == false);
+        CHECK(policy.IsDue(Observer::MODERATE, Period - 1) == false);
+
+        // A rising pressure is not held back by the cooldown of a lower level...
+        CHECK(policy.IsDue(Observer::HIGH, 100) == true);
+        policy.Trimmed(Observer::HIGH, 100);
+
+        // ... but its trim covers the lower levels, so those cool down from there on.
+        CHECK(policy.IsDue(Observer::HIGH, 101) == false);
+        CHECK(policy.IsDue(Observer::MODERATE, Period) == false);
+        CHECK(policy.IsDue(Observer::MODERATE, Period + 100) == true);
+        CHECK(policy.IsDue(Observer::HIGH, Period + 100) == true);
+
+        CHECK(policy.IsDue(Observer::CRITICAL, 200) == true);
+        policy.Trimmed(Observer::CRITICAL, 200);
+        CHECK(policy.IsDue(Observer::MODERATE, Period + 100) == false);
+        CHECK(policy.IsDue(Observer::HIGH, Period + 100) == false);
+        CHECK(policy.IsDue(Observer::CRITICAL, Period + 199) == false);
+        CHECK(policy.IsDue(Observer::CRITICAL, Period + 200) == true);
+
+        // A lower level trim leaves the cooldown of the higher ones alone.
+        policy.Trimmed(Observer::MODERATE, Period + 200);
+        CHECK(policy.IsDue(Observer::HIGH, Period + 200) == true);
+        CHECK(policy.IsDue(Observer::MODERATE, Period + 200) == false);
+
+        // Configuring again starts from scratch.
+        policy.Configure(10, 25, 10, Period);
+        CHECK(policy.IsDue(Observer::MODERATE, 0) == true);
+    }
+
+    class Trimmer : public Observer::ITrimmer {
+    public:
+        Trimmer(const Trimmer&) = delete;
+        Trimmer& operator=(const Trimmer&) = delete;
+
+        Trimmer()
+            : _lock()
+            , _trims()
+        {
+        }
+        ~Trimmer() override = default;
+
+    public:
+        void Trim(const Observer::level which) override
+        {
+            _lock.Lock();
+            _trims.push_back(which);
+            _lock.Unlock();
+        }
+        std::vector<Observer::level> Trims() const
+        {
+            _lock.Lock();
+            std::vector<Observer::level> result(_trims);
+            _lock.Unlock();
+
+            return (result);
+        }
+
+    private:
+        mutable Core::CriticalSection _lock;
+        std::vector<Observer::level> _trims;
+    };
+
+    bool Write(const string& fileName, const char content[])
+    {
+        Core::File file(fileName);
+        bool result = (file.Create() == true);
+
+        if (result == true) {
+            file.Write(reinterpret_cast<const uint8_t*>(content), static_cast<uint32_t>(::strlen(content)));
+            file.Close();
+        }
+
+        return (result);
+    }
+
+    // The observer thread driven by a stand-in PSI file, which is read every window.
+    void Observe()
+    {
+        const string source(_T("/tmp/MemoryPressureTest.psi"));
+        const string fileName(_T("/tmp/MemoryPressureTest.pressure"));
+
+        CHECK(Write(source, High) == true);
+
+        Observer::Config config;
+        config.FromString(_T("{\"source\":\"") + source + _T("\",\"window\":500,\"settle\":0,\"cooldown\":60000}"));
+
+        Trimmer trimmer;
+        Observer observer(trimmer);
+
+        CHECK(observer.Open(config, fileName) == Core::ERROR_NONE);
+
+        // A few windows at the same level, only the first one trims.
+        SleepMs(1300);
+
+        std::vector<Observer::level> trims(trimmer.Trims());
+        CHECK((trims.size() == 1) && (trims[0] == Observer::HIGH));
+
+        Observer::Statistics statistics;
+        CHECK(Observer::Load(fileName, statistics) == true);
+        CHECK(statistics.Level.Value() == _T("high"));
+        CHECK(statistics.High.Trims.Value() == 1);
+        CHECK(statistics.Moderate.Trims.Value() == 0);
+
+        // Rising to critical trims again, going back down to high does not.
+        CHECK(Write(source, Critical) == true);
+        SleepMs(800);
+        CHECK(Write(source, High) == true);
+        SleepMs(800);
+
+        trims = trimmer.Trims();
+        CHECK((trims.size() == 2) && (trims.back() == Observer::CRITICAL));
+
+        // Without pressure, the level comes down.
+        CHECK(Write(source, None) == true);
+        SleepMs(800);
+
+        observer.Close();
+
+        Observer::Statistics after;
+        CHECK(Observer::Load(fileName, after) == true);
+        CHECK(after.Level.Value() == _T("none"));
+        CHECK(after.High.Trims.Value() == 1);
+        CHECK(after.Critical.Trims.Value() == 1);
+        CHECK(trimmer.Trims().size() == 2);
+
+        Core::File(source).Destroy();
+        Core::File(fileName).Destroy();
+    }
+
+}
+
+int main(int, char*[])
+{
+    Levels();
+    Cooldown();
+    Observe();
+
+    Core::Singleton::Dispose();
+
+    return (Test::Failures());
+}
@@ -0,0 +1,45 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdio.h>
+
+// Minimal checks for the behaviour tests, a test program returns the number of failed checks.
+namespace WPEFramework {
+namespace Test {
+
+    inline uint32_t& Failures()
+    {
+        static uint32_t failures = 0;
+        return (failures);
+    }
+
+    inline void Check(const bool condition, const char expression[], const char file[], const uint32_t line)
+    {
+        if (condition == false) {
+            fprintf(stderr, "%s:%u: check failed: %s\n", file, line, expression);
+            Failures()++;
+        }
+    }
+
+} // namespace Test
+} // namespace WPEFramework
+
+#define CHECK(expression) WPEFramework::Test::Check((expression), #expression, __FILE__, __LINE__)